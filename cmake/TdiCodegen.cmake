@@ -0,0 +1,39 @@
+# tdi_generate_headers(<target>
+#                      JSON <tdi.json>
+#                      NAMESPACE <c++ namespace>
+#                      [OUTPUT <header>])
+#
+# Adds a custom target generating a C++ header of typed tables from a
+# tdi.json with cmake/tdi_codegen.py. The header holds compile time table,
+# field and action IDs and widths, and typed key / action data structs
+# that fill a tdi::TableKey / tdi::TableData by ID. OUTPUT defaults to
+# ${CMAKE_CURRENT_BINARY_DIR}/<target>.hpp. The directory of the header is
+# returned in <target>_INCLUDE_DIR. Consumers add_dependencies() on the
+# target and add that directory to their include path.
+
+find_program(TDI_PYTHON3 NAMES python3 python)
+set(TDI_CODEGEN_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/tdi_codegen.py
+  CACHE INTERNAL "Generator of typed TDI table headers")
+
+function(tdi_generate_headers target)
+  cmake_parse_arguments(GEN "" "JSON;NAMESPACE;OUTPUT" "" ${ARGN})
+  if(NOT GEN_JSON OR NOT GEN_NAMESPACE)
+    message(FATAL_ERROR "tdi_generate_headers: JSON and NAMESPACE are required")
+  endif()
+  if(NOT TDI_PYTHON3)
+    message(FATAL_ERROR "tdi_generate_headers: python3 is required")
+  endif()
+  if(NOT GEN_OUTPUT)
+    set(GEN_OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/${target}.hpp)
+  endif()
+  get_filename_component(gen_dir ${GEN_OUTPUT} DIRECTORY)
+  add_custom_command(OUTPUT ${GEN_OUTPUT}
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${gen_dir}
+    COMMAND ${TDI_PYTHON3} ${TDI_CODEGEN_SCRIPT}
+      --json ${GEN_JSON} --out ${GEN_OUTPUT} --namespace ${GEN_NAMESPACE}
+    DEPENDS ${GEN_JSON} ${TDI_CODEGEN_SCRIPT}
+    COMMENT "Generating typed TDI tables ${GEN_OUTPUT}"
+    VERBATIM)
+  add_custom_target(${target} DEPENDS ${GEN_OUTPUT})
+  set(${target}_INCLUDE_DIR ${gen_dir} PARENT_SCOPE)
+endfunction()
@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+#
+# Copyright(c) 2021 Intel Corporation.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+"""
+Generates a C++ header of typed tables from a tdi.json.
+
+For every table the header holds the table, key field, action and data field
+IDs and widths as compile time constants, and typed Key and action structs
+whose fill() sets a tdi::TableKey / tdi::TableData by ID, with field sizes
+fixed by their types. A verify() function checks at startup that the loaded
+schema matches the one the header was generated from.
+
+Usage: tdi_codegen.py --json tdi.json --out header.hpp --namespace ns
+"""
+from __future__ import print_function
+import argparse
+import json
+import re
+import sys
+
+UINT_WIDTHS = {"uint8": 8, "uint16": 16, "uint32": 32, "uint64": 64}
+MATCH_TYPES = {
+    "Exact": "Bits",
+    "Ternary": "Ternary",
+    "LPM": "Lpm",
+    "Range": "Range",
+}
+CPP_KEYWORDS = {
+    "and", "auto", "bool", "break", "case", "char", "class", "const",
+    "default", "delete", "do", "double", "else", "enum", "explicit", "float",
+    "for", "if", "int", "long", "namespace", "new", "not", "or", "private",
+    "protected", "public", "register", "return", "short", "signed", "sizeof",
+    "static", "struct", "switch", "template", "this", "typedef", "union",
+    "unsigned", "using", "virtual", "void", "volatile", "while", "xor",
+}
+
+
+def identifier(name):
+    """Turn a P4 name into a C++ identifier, e.g. hdr.ipv4.dst_addr ->
+    hdr_ipv4_dst_addr and $MATCH_PRIORITY -> MATCH_PRIORITY"""
+    ident = re.sub(r"[^A-Za-z0-9_]", "_", name.lstrip("$"))
+    ident = re.sub(r"_+", "_", ident).strip("_")
+    if not ident or ident[0].isdigit() or ident in CPP_KEYWORDS:
+        ident = "f_" + ident
+    return ident
+
+
+def type_name(name):
+    """Camel case type name, e.g. forward_timeout -> ForwardTimeout and
+    $PORT_STAT -> PortStat"""
+    parts = [p for p in re.split(r"[^A-Za-z0-9]", name.lstrip("$")) if p]
+    ident = "".join(p.capitalize() if p.isupper() else p[0].upper() + p[1:]
+                    for p in parts)
+    if not ident or ident[0].isdigit():
+        ident = "T" + ident
+    return ident
+
+
+def short_names(names, convert):
+    """Map each fully qualified name to the converted last component, or to
+    the whole converted name when the last component is ambiguous"""
+    last = {}
+    for name in names:
+        last.setdefault(convert(name.split(".")[-1]), []).append(name)
+    result = {}
+    for short, full_names in last.items():
+        for name in full_names:
+            result[name] = short if len(full_names) == 1 else convert(name)
+    return result
+
+
+def field_width(field):
+    """Width in bits of a key or data field, None if not a fixed width
+    scalar"""
+    if field.get("repeated", False) or "type" not in field:
+        return None
+    ftype = field["type"].get("type")
+    if ftype == "bytes":
+        return field["type"].get("width")
+    if ftype in UINT_WIDTHS:
+        return UINT_WIDTHS[ftype]
+    if ftype == "bool":
+        return 1
+    return None
+
+
+def field_cpp_type(field, match_type="Exact"):
+    """C++ type of the member holding a field value, None if unsupported"""
+    width = field_width(field)
+    if width is None:
+        return None
+    ftype = field["type"]["type"]
+    if ftype == "bool" and match_type == "Exact":
+        return "bool"
+    if ftype in UINT_WIDTHS and match_type == "Exact":
+        return "uint64_t"
+    return "tdi::typed::%s<%d>" % (MATCH_TYPES[match_type], width)
+
+
+def singletons(data):
+    """Flatten the singleton and oneof entries of a data list"""
+    for entry in data:
+        if "singleton" in entry:
+            yield entry["singleton"]
+        elif "oneof" in entry:
+            for member in entry["oneof"]:
+                yield member
+        elif "id" in entry:
+            yield entry
+
+
+class Writer(object):
+    def __init__(self):
+        self.lines = []
+        self.indent = 0
+
+    def line(self, text=""):
+        self.lines.append(("  " * self.indent + text) if text else "")
+
+    def open(self, text):
+        self.line(text)
+        self.indent += 1
+
+    def close(self, text="};"):
+        self.indent -= 1
+        self.line(text)
+
+
+def write_id_enum(w, name, entries, enum_type="tdi_id_t"):
+    if not entries:
+        return
+    w.open("struct %s {" % name)
+    w.open("enum : %s {" % enum_type)
+    for ident, value in entries:
+        w.line("%s = %d," % (ident, value))
+    w.close()
+    w.close()
+
+
+def write_fill(w, arg_type, arg, setter, fields):
+    w.open("tdi_status_t fill(%s *%s) const {" % (arg_type, arg))
+    if not fields:
+        w.line("(void)%s;" % arg)
+        w.line("return TDI_SUCCESS;")
+        w.close("};")
+        return
+    w.line("tdi_status_t status = TDI_SUCCESS;")
+    for ident, id_scope in fields:
+        w.line("status = tdi::typed::%s(%s, %s::%s, %s);" %
+               (setter, arg, id_scope, ident, ident))
+        w.line("if (status != TDI_SUCCESS) return status;")
+    w.line("return status;")
+    w.close("};")
+
+
+def write_table(w, table, struct_name):
+    w.line("// %s" % table["name"])
+    w.open("struct %s {" % struct_name)
+    w.line("enum : tdi_id_t { kId = %d };" % table["id"])
+    w.line('static const char *name() { return "%s"; };' % table["name"])
+    w.line()
+
+    # Key
+    keys = table.get("key", [])
+    write_id_enum(w, "KeyId", [(identifier(k["name"]), k["id"]) for k in keys])
+    write_id_enum(w, "KeyWidth",
+                  [(identifier(k["name"]), field_width(k)) for k in keys
+                   if field_width(k) is not None], "size_t")
+    typed_keys = []
+    w.open("struct Key {")
+    for k in keys:
+        cpp_type = None
+        if k.get("match_type") in MATCH_TYPES:
+            cpp_type = field_cpp_type(k, k["match_type"])
+        if cpp_type is None:
+            w.line("// %s : %s key, set through tdi::TableKey" %
+                   (k["name"], k.get("match_type")))
+            continue
+        w.line("%s %s;" % (cpp_type, identifier(k["name"])))
+        typed_keys.append((identifier(k["name"]), "KeyId"))
+    w.line()
+    write_fill(w, "tdi::TableKey", "key", "keyFieldSet", typed_keys)
+    w.close()
+    w.line()
+
+    # Common data
+    common = list(singletons(table.get("data", [])))
+    write_id_enum(w, "DataId",
+                  [(identifier(d["name"]), d["id"]) for d in common])
+
+    # Actions
+    actions = table.get("action_specs", [])
+    action_names = short_names([a["name"] for a in actions], type_name)
+    verify_lines = []
+    if actions:
+        w.open("struct Actions {")
+        for action in actions:
+            fields = list(singletons(action.get("data", [])))
+            w.line("// %s. fill() expects data allocated for kId" %
+                   action["name"])
+            w.open("struct %s {" % action_names[action["name"]])
+            w.line("enum : tdi_id_t { kId = %d };" % action["id"])
+            write_id_enum(w, "DataId",
+                          [(identifier(d["name"]), d["id"]) for d in fields])
+            typed_fields = []
+            verify_lines.append("actionVerify(*table_info, %d)" %
+                                action["id"])
+            for d in fields:
+                cpp_type = field_cpp_type(d)
+                if cpp_type is None:
+                    w.line("// %s : set through tdi::TableData" % d["name"])
+                    continue
+                w.line("%s %s;" % (cpp_type, identifier(d["name"])))
+                typed_fields.append((identifier(d["name"]), "DataId"))
+                verify_lines.append(
+                    "dataFieldVerify(*table_info, %d, %d, %d)" %
+                    (d["id"], action["id"], field_width(d)))
+            if typed_fields:
+                w.line()
+            write_fill(w, "tdi::TableData", "data", "dataFieldSet",
+                       typed_fields)
+            w.close()
+        w.close()
+        w.line()
+
+    # Verify
+    w.open("static tdi_status_t verify(const tdi::TdiInfo &tdi_info) {")
+    w.line("const tdi::TableInfo *table_info = nullptr;")
+    w.line("auto status = tdi::typed::tableVerify(tdi_info, name(), kId, "
+           "&table_info);")
+    w.line("if (status != TDI_SUCCESS) return status;")
+    key_lines = ["keyFieldVerify(*table_info, %d, %d)" %
+                 (k["id"], field_width(k)) for k in keys
+                 if field_width(k) is not None]
+    for check in key_lines + verify_lines:
+        w.line("status = tdi::typed::%s;" % check)
+        w.line("if (status != TDI_SUCCESS) return status;")
+    w.line("return status;")
+    w.close("};")
+    w.close()
+    w.line()
+
+
+def generate(schema, namespace, source):
+    tables = schema.get("tables", [])
+    table_names = short_names([t["name"] for t in tables], type_name)
+    guard = "_%s_TDI_GEN_HPP" % re.sub(r"[^A-Za-z0-9]", "_",
+                                        namespace).upper()
+    w = Writer()
+    w.line("// Generated by tdi_codegen.py from %s. Do not edit." % source)
+    w.line("#ifndef %s" % guard)
+    w.line("#define %s" % guard)
+    w.line()
+    w.line("#include <tdi/common/tdi_typed_fields.hpp>")
+    w.line()
+    for ns in namespace.split("::"):
+        w.line("namespace %s {" % ns)
+    w.line()
+    for table in tables:
+        write_table(w, table, table_names[table["name"]])
+    w.line("// Check that the loaded schema matches this header")
+    w.open("inline tdi_status_t verify(const tdi::TdiInfo &tdi_info) {")
+    w.line("tdi_status_t status = TDI_SUCCESS;")
+    for table in tables:
+        w.line("status = %s::verify(tdi_info);" % table_names[table["name"]])
+        w.line("if (status != TDI_SUCCESS) return status;")
+    w.line("return status;")
+    w.close("}")
+    w.line()
+    for ns in reversed(namespace.split("::")):
+        w.line("}  // namespace %s" % ns)
+    w.line()
+    w.line("#endif  // %s" % guard)
+    return "\n".join(w.lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument("--json", required=True, help="Input tdi.json")
+    parser.add_argument("--out", required=True, help="Output header")
+    parser.add_argument("--namespace", required=True,
+                        help="C++ namespace of the generated code")
+    args = parser.parse_args()
+    with open(args.json) as f:
+        schema = json.load(f)
+    header = generate(schema, args.namespace, args.json.split("/")[-1])
+    with open(args.out, "w") as f:
+        f.write(header)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
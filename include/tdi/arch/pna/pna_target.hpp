@@ -25,6 +25,7 @@
 #include <mutex>
 
 #include <tdi/common/tdi_defs.h>
+#include <tdi/common/tdi_pipe_fan_out.hpp>
 #include <tdi/common/tdi_target.hpp>
 
 // pna include
@@ -61,6 +62,18 @@ class Target : public tdi::Target {
   friend class tdi::pna::Device;
 };
 
+/**
+ * @brief Programs a write to a PNA Target in its pipe, or in every pipe
+ * in parallel for PNA_DEV_PIPE_ALL. See \ref tdi::PipeFanOut
+ */
+class PipeFanOut : public tdi::PipeFanOut {
+ public:
+  PipeFanOut(TdiThreadPool *pool = nullptr)
+      : tdi::PipeFanOut(static_cast<tdi_target_e>(PNA_TARGET_PIPE_ID),
+                        PNA_DEV_PIPE_ALL,
+                        pool){};
+};
+
 }  // namespace pna
 }  // namespace tdi
 
@@ -25,6 +25,7 @@
 #include <mutex>
 
 #include <tdi/common/tdi_defs.h>
+#include <tdi/common/tdi_pipe_fan_out.hpp>
 #include <tdi/common/tdi_target.hpp>
 
 // tna include
@@ -56,6 +57,18 @@ class Target : public tdi::Target {
   friend class tdi::tna::Device;
 };
 
+/**
+ * @brief Programs a write to a TNA Target in its pipe, or in every pipe
+ * in parallel for TNA_DEV_PIPE_ALL. See \ref tdi::PipeFanOut
+ */
+class PipeFanOut : public tdi::PipeFanOut {
+ public:
+  PipeFanOut(TdiThreadPool *pool = nullptr)
+      : tdi::PipeFanOut(static_cast<tdi_target_e>(TDI_TNA_TARGET_PIPE_ID),
+                        TNA_DEV_PIPE_ALL,
+                        pool){};
+};
+
 }  // namespace tna
 }  // namespace tdi
 
@@ -105,6 +105,87 @@ tdi_status_t tdi_table_entry_del(const tdi_table_hdl *table_hdl,
                                  const tdi_flags_hdl *flags,
                                  const tdi_table_key_hdl *key);
 
+/**
+ * @brief Add a batch of entries to the table. Every entry is attempted
+ * even if an earlier one fails.
+ *
+ * @param[in] table_hdl Table object
+ * @param[in] session Session Object
+ * @param[in] dev_tgt Device target
+ * @param[in] flags Call flags
+ * @param[in] keys Array of Entry Keys. Size should be equal to n. Can
+ * only be NULL if n is 0
+ * @param[in] data Array of Entry Data. Size should be equal to n. Can
+ * only be NULL if n is 0
+ * @param[in] n Number of entries
+ * @param[out] status_ret Array of per entry status. Size should be equal to
+ * n. Can be NULL
+ *
+ * @return TDI_SUCCESS if all entries were added, else the status of the
+ * first failed entry
+ */
+tdi_status_t tdi_table_entry_add_batch(const tdi_table_hdl *table_hdl,
+                                       const tdi_session_hdl *session,
+                                       const tdi_target_hdl *dev_tgt,
+                                       const tdi_flags_hdl *flags,
+                                       const tdi_table_key_hdl **keys,
+                                       const tdi_table_data_hdl **data,
+                                       uint32_t n,
+                                       tdi_status_t *status_ret);
+
+/**
+ * @brief Modify a batch of existing entries of the table. Every entry is
+ * attempted even if an earlier one fails.
+ *
+ * @param[in] table_hdl Table object
+ * @param[in] session Session Object
+ * @param[in] dev_tgt Device target
+ * @param[in] flags Call flags
+ * @param[in] keys Array of Entry Keys. Size should be equal to n. Can
+ * only be NULL if n is 0
+ * @param[in] data Array of Entry Data. Size should be equal to n. Can
+ * only be NULL if n is 0
+ * @param[in] n Number of entries
+ * @param[out] status_ret Array of per entry status. Size should be equal to
+ * n. Can be NULL
+ *
+ * @return TDI_SUCCESS if all entries were modified, else the status of the
+ * first failed entry
+ */
+tdi_status_t tdi_table_entry_mod_batch(const tdi_table_hdl *table_hdl,
+                                       const tdi_session_hdl *session,
+                                       const tdi_target_hdl *dev_tgt,
+                                       const tdi_flags_hdl *flags,
+                                       const tdi_table_key_hdl **keys,
+                                       const tdi_table_data_hdl **data,
+                                       uint32_t n,
+                                       tdi_status_t *status_ret);
+
+/**
+ * @brief Delete a batch of entries of the table. Every entry is attempted
+ * even if an earlier one fails.
+ *
+ * @param[in] table_hdl Table object
+ * @param[in] session Session Object
+ * @param[in] dev_tgt Device target
+ * @param[in] flags Call flags
+ * @param[in] keys Array of Entry Keys. Size should be equal to n. Can
+ * only be NULL if n is 0
+ * @param[in] n Number of entries
+ * @param[out] status_ret Array of per entry status. Size should be equal to
+ * n. Can be NULL
+ *
+ * @return TDI_SUCCESS if all entries were deleted, else the status of the
+ * first failed entry
+ */
+tdi_status_t tdi_table_entry_del_batch(const tdi_table_hdl *table_hdl,
+                                       const tdi_session_hdl *session,
+                                       const tdi_target_hdl *dev_tgt,
+                                       const tdi_flags_hdl *flags,
+                                       const tdi_table_key_hdl **keys,
+                                       uint32_t n,
+                                       tdi_status_t *status_ret);
+
 /**
  * @brief Clear a table. Delete all entries. This API also resets default
  * entry if present and is not const default. If table has always present
@@ -30,6 +30,8 @@
 #include <tdi/common/tdi_attributes.hpp>
 #include <tdi/common/tdi_table_data.hpp>
 #include <tdi/common/tdi_table_key.hpp>
+#include <tdi/common/tdi_packed_key.hpp>
+#include <tdi/common/tdi_pipe_fan_out.hpp>
 #include <tdi/common/tdi_operations.hpp>
 
 #endif  //_TDI_HPP
@@ -21,15 +21,20 @@
 #ifndef _TDI_INFO_HPP
 #define _TDI_INFO_HPP
 
+#include <atomic>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
 #include <tdi/common/tdi_defs.h>
 #include <tdi/common/tdi_json_parser/tdi_info_parser.hpp>
+#include <tdi/common/tdi_json_parser/tdi_name_index.hpp>
 #include <tdi/common/tdi_learn.hpp>
 #include <tdi/common/tdi_table.hpp>
 
@@ -135,6 +140,56 @@ class TableFactory {
   };
 };
 
+/**
+ * @brief Approximate memory held by the schema objects of a program, in
+ * bytes. Counts the objects, the nodes of their containers and the heap
+ * buffers of their strings, but not allocator overhead. See
+ * TdiInfo::memoryUsageGet
+ */
+struct TdiInfoMemoryUsage {
+  // TableInfo objects with their maps and indexes, without their fields
+  // and actions
+  size_t table_infos{0};
+  size_t key_fields{0};
+  // Data fields of tables, actions and learns
+  size_t data_fields{0};
+  // Out of line annotations and oneof siblings of the data fields that
+  // have them
+  size_t data_field_extras{0};
+  // ActionInfo objects, without their data fields
+  size_t actions{0};
+  // LearnInfo objects, without their data fields
+  size_t learn_infos{0};
+  // Interned schema strings
+  size_t string_pool{0};
+  // tdi::Table and tdi::Learn objects and the name and ID maps of TdiInfo
+  size_t tdi_info{0};
+  // Json text of the tables not built yet with lazy tables
+  size_t pending_tables{0};
+
+  size_t num_data_fields{0};
+  size_t num_data_fields_with_extras{0};
+
+  size_t totalGet() const {
+    return table_infos + key_fields + data_fields + data_field_extras +
+           actions + learn_infos + string_pool + tdi_info + pending_tables;
+  };
+};
+
+/**
+ * @brief Outcome of TdiInfo::schemaReload(). Tables are listed by fully
+ * qualified name
+ */
+struct TdiInfoReloadResult {
+  // Tables that got a new tdi::Table object
+  std::vector<std::string> tables_added;
+  std::vector<std::string> tables_changed;
+  // Tables whose tdi::Table object was destroyed
+  std::vector<std::string> tables_removed;
+  // Tables whose tdi::Table object was kept as is
+  size_t tables_unchanged{0};
+};
+
 /**
  * @brief Class to maintain metadata of all tables and learn objects. Note that
  *    all the objects returned are representations of the actual HW tables.\n So
@@ -165,6 +220,27 @@ class TdiInfo {
       std::unique_ptr<TdiInfoParser> tdi_info_parser,
       const tdi::TableFactory *factory);
 
+  /**
+   * @brief Same as above, with TdiInfo owning the factory. Required for
+   * lazy table creation, see \ref tdi::TdiInfoParser::lazyParseSet(). With
+   * a lazy parser only table names and IDs are indexed here. The TableInfo
+   * and Table of a table are built by the first tableFromNameGet() or
+   * tableFromIdGet() on it. Lookups of a table already built don't lock,
+   * nor do lookups of a table the factory failed to create. tablesGet() and
+   * tableMapGet() build all the tables. A lazy parser passed to the
+   * overload above is fully built up front.
+   *
+   * @param[in] p4_name P4 program name
+   * @param[in] tdi_info_parser Parsed schema
+   * @param[in] factory Table factory
+   *
+   * @return unique_ptr to TdiInfo
+   */
+  std::unique_ptr<const TdiInfo> static makeTdiInfo(
+      const std::string &p4_name,
+      std::unique_ptr<TdiInfoParser> tdi_info_parser,
+      std::unique_ptr<const tdi::TableFactory> factory);
+
   /**
    * @brief Get all the tdi::Table objs.
    *
@@ -183,6 +259,21 @@ class TdiInfo {
    */
   tdi_status_t tableFromNameGet(const std::string &name,
                                 const tdi::Table **table_ret) const;
+
+  /**
+   * @brief Get a tdi::Table obj from its name without building a
+   * std::string. Same as tableFromNameGet(const std::string &, ...)
+   *
+   * @param[in] name Fully qualified or short P4 table name, need not be
+   * null terminated
+   * @param[in] len Length of name
+   * @param[out] table_ret tdi::Table obj pointer
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t tableFromNameGet(const char *name,
+                                const size_t &len,
+                                const tdi::Table **table_ret) const;
   /**
    * @brief Get a tdi::Table obj from its ID
    *
@@ -234,46 +325,148 @@ class TdiInfo {
   const std::string &p4NameGet() const { return p4_name_; };
 
   /**
-   * @brief Get name and tdi::Table map
+   * @brief Get name and tdi::Table map. The map is replaced by
+   * schemaReload(), the one returned stays valid until the second reload
+   * after the call
    *
    * @return map of name and tdi::Table
    */
   const std::map<std::string, std::unique_ptr<tdi::Table>> &tableMapGet() const;
 
   /**
-   * @brief Get name and tdi::Learn map
+   * @brief Get name and tdi::Learn map. Replaced by schemaReload() like
+   * tableMapGet()
    *
    * @return map of name and tdi::Learn
    */
   const std::map<std::string, std::unique_ptr<tdi::Learn>> &learnMapGet() const;
 
+  /**
+   * @brief Get an estimate of the memory held by the schema of the program,
+   * broken down by kind of object. With lazy tables only the tables built
+   * so far are counted
+   *
+   * @param[out] usage Memory usage
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t memoryUsageGet(TdiInfoMemoryUsage *usage) const;
+
+  /**
+   * @brief Reload the schema from new tdi.json files. The files are parsed
+   * with a new parser that shares the string pool of the current one, and
+   * every table is compared with its current definition. Tables that did
+   * not change keep their tdi::Table object, so Table pointers and handles
+   * obtained before the reload stay valid. Changed and new tables get new
+   * Table objects from the factory, all created before anything is swapped,
+   * and removed tables are dropped. Learns are carried over the same way.<br>
+   * The new schema is built off to the side and published atomically, so
+   * lookups may run concurrently and see either the old or the new one.
+   * The replaced Table and Learn objects, and the maps returned by
+   * tableMapGet() and learnMapGet() before the reload, are only destroyed
+   * by the next reload. Reloads of a TdiInfo are serialized. Not supported
+   * for TdiInfo objects with lazily created tables
+   *
+   * @param[in] tdi_info_parser Parser to parse the new files with. Must not
+   * have parsed anything yet
+   * @param[in] tdi_info_file_paths New tdi.json files of the program
+   * @param[in] factory Factory to create the new Table objects with
+   * @param[out] result Optional, the tables that were rebuilt
+   *
+   * @return Status of the API call. The TdiInfo is unchanged on error
+   */
+  tdi_status_t schemaReload(
+      std::unique_ptr<TdiInfoParser> tdi_info_parser,
+      const std::vector<std::string> &tdi_info_file_paths,
+      const tdi::TableFactory *factory,
+      TdiInfoReloadResult *result = nullptr);
+
   TdiInfo(TdiInfo const &) = delete;
   TdiInfo(TdiInfo &&) = delete;
   TdiInfo() = delete;
   TdiInfo &operator=(const TdiInfo &) = delete;
   TdiInfo &operator=(TdiInfo &&) = delete;
 
-  /* Main P4_info map. object_name --> tdi_info object */
-  std::map<std::string, std::unique_ptr<tdi::Table>> tableMap;
 
  private:
   TdiInfo(const std::string &p4_name,
           std::unique_ptr<TdiInfoParser> tdi_info_parser,
-          const tdi::TableFactory *factory);
+          const tdi::TableFactory *factory,
+          std::unique_ptr<const tdi::TableFactory> owned_factory);
 
-  // This is the map which is to be queried when a name lookup for a table
-  // happens. Multiple names can point to the same table because multiple
-  // names can exist for a table. Example, switchingress.forward and forward
-  // both are valid for a table if no conflicts with other table is present
-  std::map<std::string, const tdi::Table *> fullTableMap;
+  // Table of the schema, created on first lookup with lazy tables. table
+  // is published once created, failed once creating it failed
+  struct LazyTable {
+    explicit LazyTable(const std::string *name_) : name(name_){};
+    const std::string *name;
+    mutable std::atomic<const tdi::Table *> table{nullptr};
+    mutable std::atomic<bool> failed{false};
+  };
+
+  // Lazy table creation. lazyTableGet() only takes lazy_table_mutex_ if
+  // the table isn't created yet, the others are called with it held
+  const tdi::Table *lazyTableGet(const LazyTable &lazy_table) const;
+  const tdi::Table *lazyTableBuild(const std::string &name) const;
+  void lazyTablesBuildAll() const;
+
+  // One version of the schema: the Table and Learn objects, their indexes
+  // and the parser owning their infos. Lookups read the current one
+  // without a lock, schemaReload() builds a new one and publishes it
+  struct Schema {
+    // Releases the objects the next schema took over
+    ~Schema();
+
+    // Declared first, the objects below point into it
+    std::unique_ptr<TdiInfoParser> tdi_info_parser;
+
+    /* Main P4_info map. object_name --> tdi_info object. Filled on demand
+     * with lazy table creation, under lazy_table_mutex_. Only read through
+     * tableMapGet() and tablesGet(), which build all the tables first */
+    std::map<std::string, std::unique_ptr<tdi::Table>> tableMap;
+
+    // This is the index which is to be queried when a name lookup for a
+    // table happens. Multiple names can point to the same table because
+    // multiple names can exist for a table. Example, switchingress.forward
+    // and forward both are valid for a table if no conflicts with other
+    // table is present. Indexes the keys of tableMap
+    ShortNameIndex<const tdi::Table> full_table_index;
+
+    /* Reverse map in case lookup from ID is needed*/
+    std::map<tdi_id_t, const tdi::Table *> tableIdMap;
+
+    // Learn Map
+    std::map<std::string, std::unique_ptr<tdi::Learn>> learnMap;
+    ShortNameIndex<const tdi::Learn> full_learn_index;
+    std::map<tdi_id_t, const tdi::Learn *> learnIdMap;
+
+    // Entries of tableMap and learnMap the next schema also holds. It
+    // owns them from then on
+    std::vector<std::string> tables_carried;
+    std::vector<std::string> learns_carried;
+  };
 
-  /* Reverse map in case lookup from ID is needed*/
-  std::map<tdi_id_t, const tdi::Table *> tableIdMap;
+  // Rebuild the ID and short name maps of tableMap and learnMap
+  static void nameMapsRebuild(Schema *schema);
 
-  // Learn Map
-  std::map<std::string, std::unique_ptr<tdi::Learn>> learnMap;
-  std::map<std::string, const tdi::Learn *> fullLearnMap;
-  std::map<tdi_id_t, const tdi::Learn *> learnIdMap;
+  // Current schema, loaded by lookups between a read lock and unlock of
+  // the process wide schema readers, see tdi_info.cpp. Owned by
+  // schema_owner_. The one it replaced is kept in retired_schema_ until
+  // the next reload, Table pointers obtained from it stay valid until then
+  std::atomic<Schema *> schema_{nullptr};
+  std::unique_ptr<Schema> schema_owner_;
+  std::unique_ptr<Schema> retired_schema_;
+
+  // Lazy table creation. Name and ID indexes over all the tables of the
+  // schema, whose names point into TdiInfoParser::tableIdIndexGet().
+  // Tables are created in tableMap and tableIdMap under lazy_table_mutex_
+  // on first lookup. Later lookups only read the LazyTable. The mutex also
+  // serializes schemaReload() with itself and with memoryUsageGet()
+  bool lazy_tables_{false};
+  std::unique_ptr<const tdi::TableFactory> table_factory_;
+  std::deque<LazyTable> lazy_tables_list_;
+  ShortNameIndex<const LazyTable> lazy_table_index_;
+  std::map<tdi_id_t, const LazyTable *> lazyTableIdMap;
+  mutable std::mutex lazy_table_mutex_;
 
   // Set of optimized out table names. Tables that may be present
   // in TDI.json but target decided not to have a table object present
@@ -285,7 +478,84 @@ class TdiInfo {
   // the device can choose to assign an empty string or preferabley a reserved
   // name like "$SHARED".
   const std::string p4_name_;
-  std::unique_ptr<TdiInfoParser> tdi_info_parser_;
+};
+
+/**
+ * @brief Process wide registry of the TdiInfo objects of loaded programs,
+ * so that devices running the same program share one TdiInfo instead of
+ * each parsing and holding a copy. Entries are keyed by program name, the
+ * hash of the tdi.json files and the type of the TableFactory, and only
+ * hold weak references. A TdiInfo is destroyed along with the last device
+ * using it.<br>
+ * TdiInfo and Table objects do not hold device state, the device is given
+ * by the Target of every Table call, which is what makes sharing safe.<br>
+ * <B>Creation: </B> Singleton
+ */
+class TdiInfoRegistry {
+ public:
+  /**
+   * @brief Get the singleton object
+   *
+   * @return Ref to Singleton TdiInfoRegistry object
+   */
+  static TdiInfoRegistry &getInstance();
+
+  /**
+   * @brief Get the TdiInfo of a program, parsing the files and creating it
+   * only if no other device holds one for the same files. Thread safe,
+   * concurrent requests for the same program parse it once
+   *
+   * @param[in] p4_name Name of the P4 program
+   * @param[in] tdi_info_file_paths tdi.json files of the program
+   * @param[in] tdi_info_parser Parser to parse the files with. Unused if
+   * the TdiInfo exists
+   * @param[in] factory Factory to create the Table objects with
+   * @param[out] tdi_info Shared TdiInfo
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t tdiInfoGet(const std::string &p4_name,
+                          const std::vector<std::string> &tdi_info_file_paths,
+                          std::unique_ptr<TdiInfoParser> tdi_info_parser,
+                          std::unique_ptr<const tdi::TableFactory> factory,
+                          std::shared_ptr<const TdiInfo> *tdi_info);
+
+  /**
+   * @brief Stop handing out a TdiInfo to new devices if the caller holds
+   * the only reference to it, e.g. to reload its schema in place. The check
+   * and the removal are atomic with respect to tdiInfoGet()
+   *
+   * @param[in] tdi_info The caller's reference to the TdiInfo
+   *
+   * @return Status of the API call. TDI_IN_USE if any other reference to
+   * the TdiInfo exists
+   */
+  tdi_status_t tdiInfoDetach(const std::shared_ptr<const TdiInfo> &tdi_info);
+
+  /**
+   * @brief Number of TdiInfo objects currently alive in the registry
+   */
+  size_t sizeGet() const;
+
+  TdiInfoRegistry(TdiInfoRegistry const &) = delete;
+  TdiInfoRegistry(TdiInfoRegistry &&) = delete;
+  TdiInfoRegistry &operator=(const TdiInfoRegistry &) = delete;
+  TdiInfoRegistry &operator=(TdiInfoRegistry &&) = delete;
+
+ private:
+  TdiInfoRegistry() = default;
+
+  // Program name, TableFactory type and schema hash
+  using Key = std::tuple<std::string, std::string, uint64_t>;
+  struct Entry {
+    // Held while parsing, so that concurrent requests wait for the first
+    std::mutex mutex;
+    // Accessed with TdiInfoRegistry::mutex_ held
+    std::weak_ptr<const TdiInfo> tdi_info;
+  };
+
+  mutable std::mutex mutex_;
+  std::map<Key, std::shared_ptr<Entry>> entries_;
 };
 
 }  // namespace tdi
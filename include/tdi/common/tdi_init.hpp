@@ -23,9 +23,12 @@
 #ifndef _TDI_INIT_HPP_
 #define _TDI_INIT_HPP_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 // tdi includes
 #include <tdi/common/tdi_info.hpp>
@@ -52,7 +55,8 @@ class Device {
          void *cookie)
       : device_id_(device_id),
         arch_type_(arch_type),
-        device_config_(device_config),
+        device_config_(new std::vector<tdi::ProgramConfig>(device_config)),
+        device_config_ptr_(device_config_.get()),
         cookie_(cookie){};
 
   virtual ~Device(){};
@@ -80,9 +84,36 @@ class Device {
   tdi_status_t p4NamesGet(
       std::vector<std::reference_wrapper<const std::string>> &p4_names) const;
 
+  /**
+   * @brief Get the program configs of the device. The configs returned
+   * stay valid until the second programReload() after the call
+   *
+   * @param[out] device_config Program configs
+   *
+   * @return Status of the API call
+   */
   tdi_status_t deviceConfigGet(
       const std::vector<tdi::ProgramConfig> **device_config) const;
 
+  /**
+   * @brief Reload the tdi.json files of a loaded program without removing
+   * the device. Only the tables whose definition changed are rebuilt, see
+   * TdiInfo::schemaReload(). The program config of the device is replaced
+   * with the new one. Lookups of the TdiInfo, its tables and the program
+   * config may run concurrently, see TdiInfo::schemaReload(). Reloads of a
+   * device must be serialized, as DevMgr::programReload() does. Fails with
+   * TDI_IN_USE if the TdiInfo is shared with other devices
+   *
+   * @param[in] program_config New config of the program, matched by
+   * program name
+   * @param[out] result Optional, the tables that were rebuilt
+   *
+   * @return Status of the API call. TDI_NOT_SUPPORTED if the target does
+   * not implement the reload hooks
+   */
+  tdi_status_t programReload(const tdi::ProgramConfig &program_config,
+                             TdiInfoReloadResult *result = nullptr);
+
   virtual tdi_status_t createSession(
       std::shared_ptr<tdi::Session> *session) const;
   virtual tdi_status_t createTarget(std::unique_ptr<tdi::Target> *target) const;
@@ -90,11 +121,30 @@ class Device {
                                    std::unique_ptr<tdi::Flags> *flags) const;
 
  protected:
+  /**
+   * @brief Target hooks for programReload(). Create a parser with the
+   * TdiInfoMapper of the target and the TableFactory of the target. Return
+   * nullptr if schema reload is not supported, the default
+   */
+  virtual std::unique_ptr<TdiInfoParser> tdiInfoParserCreate() const {
+    return nullptr;
+  };
+  virtual std::unique_ptr<const TableFactory> tableFactoryCreate() const {
+    return nullptr;
+  };
+
   const tdi_dev_id_t device_id_;
   const tdi_arch_type_e arch_type_;
-  const std::vector<tdi::ProgramConfig> device_config_;
+  // Only replaced by programReload(), which publishes the new configs in
+  // device_config_ptr_ and keeps the replaced ones until the next reload
+  std::unique_ptr<const std::vector<tdi::ProgramConfig>> device_config_;
+  std::unique_ptr<const std::vector<tdi::ProgramConfig>>
+      retired_device_config_;
+  std::atomic<const std::vector<tdi::ProgramConfig> *> device_config_ptr_;
   const void *cookie_;
-  std::map<std::string, std::unique_ptr<const TdiInfo>> tdi_info_map_;
+  // Shared with other devices running the same program, see
+  // TdiInfoRegistry
+  std::map<std::string, std::shared_ptr<const TdiInfo>> tdi_info_map_;
 };
 
 /**
@@ -126,7 +176,16 @@ class WarmInitImpl {
 
 /**
  * @brief Class to manage Device per dev_id.<br>
- * <B>Creation: </B> Singleton....
+ * <B>Creation: </B> Singleton....<br>
+ * deviceAdd(), deviceRemove() and programReload() are serialized by a
+ * mutex. deviceGet() and deviceIdListGet() take no lock, they read an
+ * immutable snapshot of the devices which every deviceAdd() and
+ * deviceRemove() republishes. A replaced snapshot is freed once every
+ * lookup which may have started on it is done.<br>
+ * <B>Lifetime: </B> A Device returned as a raw pointer by deviceGet() is
+ * valid until deviceRemove() of that device is called. Callers which may
+ * race with deviceRemove() take a std::shared_ptr from deviceGet(), the
+ * Device is then destroyed when the last reference is dropped
  */
 class DevMgr {
  public:
@@ -141,7 +200,7 @@ class DevMgr {
   /**
    * @brief Get the singleton ojbect
    *
-   * @return Ref to Singleton DevMgr object
+   * @return Ref to Singleton DevMgr object. Thread safe
    */
   static DevMgr &getInstance();
 
@@ -157,6 +216,19 @@ class DevMgr {
   tdi_status_t deviceGet(const tdi_dev_id_t &dev_id,
                          const tdi::Device **device) const;
 
+  /**
+   * @brief Get the Device of a device ID, sharing its ownership. The
+   * Device stays valid while device is held, even if it is removed
+   * meanwhile
+   *
+   * @param[in] dev_id Device ID
+   * @param[out] device Device object
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t deviceGet(const tdi_dev_id_t &dev_id,
+                         std::shared_ptr<const tdi::Device> *device) const;
+
   /**
    * @brief Get a list of all device IDs currently added
    *
@@ -168,7 +240,9 @@ class DevMgr {
   tdi_status_t deviceIdListGet(std::set<tdi_dev_id_t> *device_id_list) const;
 
   /**
-   * @brief Device Add function which creates a Device object and maintains it
+   * @brief Device Add function which creates a Device object and maintains it.
+   * The Device is constructed without holding the DevMgr lock, if the
+   * device ID is added concurrently the Device is discarded
    *
    * @param[in] device_id Device ID
    * @param[in] arch_type P4 architecture type
@@ -186,21 +260,47 @@ class DevMgr {
                          const std::vector<tdi::ProgramConfig> &device_config,
                          void *target_options,
                          void *cookie) {
-    if (this->dev_map_.find(device_id) != this->dev_map_.end()) {
+    if (deviceLookup(device_id, nullptr, nullptr)) {
       LOG_ERROR("%s:%d Device obj exists for dev : %d",
                 __func__,
                 __LINE__,
                 device_id);
       return TDI_ALREADY_EXISTS;
     }
-    auto dev = std::unique_ptr<tdi::Device>(
+    // Parsing the programs of a device takes long, lookups of the other
+    // devices and changes to them aren't blocked meanwhile
+    auto dev = std::shared_ptr<tdi::Device>(
         new T(device_id, arch_type, device_config, target_options, cookie));
+    // Declared after dev, so that a discarded dev is destroyed unlocked
+    std::lock_guard<std::mutex> lock(dev_map_mutex_);
+    if (this->dev_map_.find(device_id) != this->dev_map_.end()) {
+      LOG_ERROR("%s:%d Device obj exists for dev : %d",
+                __func__,
+                __LINE__,
+                device_id);
+      return TDI_ALREADY_EXISTS;
+    }
     this->dev_map_[device_id] = std::move(dev);
+    snapshotPublish();
     return TDI_SUCCESS;
   }
 
   tdi_status_t deviceRemove(const tdi_dev_id_t &device_id);
 
+  /**
+   * @brief Reload the tdi.json files of a program of a device, see
+   * Device::programReload()
+   *
+   * @param[in] device_id Device ID
+   * @param[in] program_config New config of the program
+   * @param[out] result Optional, the tables that were rebuilt
+   *
+   * @return Status of API call
+   */
+  tdi_status_t programReload(const tdi_dev_id_t &device_id,
+                             const tdi::ProgramConfig &program_config,
+                             TdiInfoReloadResult *result = nullptr);
+
   tdi_status_t deviceWarmInitBegin(const tdi_dev_id_t &device_id, const WarmInitOptions &warm_init_options);
   tdi_status_t deviceWarmInitEnd(const tdi_dev_id_t &device_id);
 
@@ -210,13 +310,31 @@ class DevMgr {
   DevMgr &operator=(DevMgr &&) = delete;
 
  protected:
-  std::map<tdi_dev_id_t, std::unique_ptr<Device>> dev_map_;
+  // Guarded by dev_map_mutex_, readers use dev_snapshot_
+  std::map<tdi_dev_id_t, std::shared_ptr<Device>> dev_map_;
 
  private:
-  DevMgr(){};
+  // Devices sorted by ID. A snapshot holds a reference to its devices
+  using DeviceSnapshot =
+      std::vector<std::pair<tdi_dev_id_t, std::shared_ptr<const Device>>>;
+
+  DevMgr();
+
+  // Find device_id in the current snapshot, no lock taken. device and
+  // shared can be nullptr
+  bool deviceLookup(const tdi_dev_id_t &device_id,
+                    const Device **device,
+                    std::shared_ptr<const Device> *shared) const;
+  // Publish dev_map_ to the readers and free the replaced snapshot once
+  // no reader uses it. Called with dev_map_mutex_ held
+  void snapshotPublish();
 
-  static std::mutex dev_mgr_instance_mutex;
-  static DevMgr *dev_mgr_instance;
+  std::mutex dev_map_mutex_;
+  std::atomic<const DeviceSnapshot *> dev_snapshot_;
+  // Owns the published snapshot
+  std::unique_ptr<const DeviceSnapshot> snapshot_;
+  // Lookups in flight on dev_snapshot_
+  ReaderEpochs readers_;
 
   static std::unique_ptr<WarmInitImpl> warm_init_impl;
 };  // DevMgr
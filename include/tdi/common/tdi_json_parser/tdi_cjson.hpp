@@ -16,22 +16,67 @@
 #ifndef _TDI_CJSON_HPP
 #define _TDI_CJSON_HPP
 
+#include <cstddef>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 /* tdi_includes */
+#include <tdi/common/tdi_defs.h>
 
 #include <target-utils/third-party/cJSON/cJSON.h>
 
 namespace tdi {
 
+/**
+ * @brief Read only, null terminated contents of a json file. Regular files
+ * are mmapped privately, so the text is read straight from the page cache
+ * without a copy, and the terminating zero is written past the end of the
+ * file into a private copy of the last page. Files whose size is a
+ * multiple of the page size, and files that can't be mapped, are read into
+ * a buffer with large reads instead.<br>
+ * Truncating a mapped file makes reads of the pages past its new end raise
+ * SIGBUS. Files which may be loaded should be replaced with rename(), not
+ * rewritten in place
+ */
+class JsonFileBuffer {
+ public:
+  JsonFileBuffer() = default;
+  ~JsonFileBuffer();
+  JsonFileBuffer(const JsonFileBuffer &) = delete;
+  JsonFileBuffer &operator=(const JsonFileBuffer &) = delete;
+
+  /**
+   * @brief Load a file, replacing what was loaded before
+   *
+   * @param[in] path Path of the file
+   *
+   * @return Status of the API call. TDI_OBJECT_NOT_FOUND if the file can't
+   * be opened or read
+   */
+  tdi_status_t load(const std::string &path);
+  /**
+   * @brief Unmap or free the contents
+   */
+  void reset();
+
+  const char *dataGet() const { return map_ ? map_ : buf_.c_str(); };
+  const size_t &sizeGet() const { return size_; };
+  bool isMapped() const { return map_ != nullptr; };
+
+ private:
+  char *map_ = nullptr;
+  size_t size_ = 0;
+  std::string buf_;
+};
+
 class CjsonObjHandler {
  public:
-  CjsonObjHandler(const std::string &fileContent);
+  CjsonObjHandler(const char *text);
   ~CjsonObjHandler();
   cJSON *rootGet() { return root; }
 
@@ -42,9 +87,13 @@ class CjsonObjHandler {
 class Cjson {
  public:
   Cjson(const Cjson &parent, const std::string &key);
+  Cjson(const Cjson &parent, const char *key);
   //  Cjson(const std::string &fileContent);
   Cjson(const Cjson &parent, int &index);
   static Cjson createCjsonFromFile(const std::string &fileContent);
+  // Parse null terminated json text, e.g. JsonFileBuffer::dataGet(). The
+  // text isn't referenced after this returns
+  static Cjson createCjsonFromBuffer(const char *text);
   Cjson(){};
 
   // Copy ctor
@@ -54,6 +103,18 @@ class Cjson {
   // rule of three need not be followed since the shared_ptr will
   // be destroyed automatically when out of scope
 
+  class ChildIterator;
+  class ChildRange;
+  /**
+   * @brief Range over the children of an array or object node, walking the
+   * cJSON linked list directly. Linear in the number of children and doesn't
+   * allocate. Use as
+   *   for (const auto &child : node.children()) { ... }
+   * The Cjson yielded by the iterator is only valid until it is advanced.
+   */
+  ChildRange children() const;
+
+  // Copying versions of children(), kept for existing users
   std::vector<std::shared_ptr<Cjson>> getCjsonChildVec() const;
   std::vector<std::string> getCjsonChildStringVec() const;
   std::string getCjsonKey() const;
@@ -71,15 +132,67 @@ class Cjson {
   Cjson operator[](int index) const;
   Cjson &operator+=(const Cjson &other);
   friend std::ostream &operator<<(std::ostream &out, const Cjson &c);
+  // Compact json text of this node, which createCjsonFromBuffer() parses
+  // back. Empty if the node doesn't exist
+  std::string printUnformatted() const;
   void updateChildNode(const std::string &key, const std::string &val);
 
  private:
-  static void createCjsonFromFileInternal(const std::string &fileContent,
-                                          Cjson &obj);
+  static void createCjsonFromFileInternal(const char *text, Cjson &obj);
   cJSON *root = nullptr;
   std::shared_ptr<CjsonObjHandler> cjson_mem_tracker = nullptr;
 };
 
+class Cjson::ChildIterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Cjson;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Cjson *;
+  using reference = const Cjson &;
+
+  const Cjson &operator*() const { return current_; };
+  const Cjson *operator->() const { return &current_; };
+  ChildIterator &operator++() {
+    current_.root = current_.root->next;
+    return *this;
+  };
+  bool operator==(const ChildIterator &other) const {
+    return current_.root == other.current_.root;
+  };
+  bool operator!=(const ChildIterator &other) const {
+    return !(*this == other);
+  };
+
+ private:
+  ChildIterator() = default;
+  // The memory tracker is shared once per iterator, not once per child
+  ChildIterator(const Cjson &parent, cJSON *child) : current_(parent) {
+    current_.root = child;
+  };
+
+  Cjson current_;
+  friend class Cjson::ChildRange;
+};
+
+class Cjson::ChildRange {
+ public:
+  ChildIterator begin() const {
+    return ChildIterator(parent_, parent_.root ? parent_.root->child : nullptr);
+  };
+  ChildIterator end() const { return ChildIterator(); };
+
+ private:
+  explicit ChildRange(const Cjson &parent) : parent_(parent){};
+
+  // Held by value so that ranges over temporaries, like
+  // node["tables"].children(), stay valid in range based for loops
+  Cjson parent_;
+  friend class Cjson;
+};
+
+inline Cjson::ChildRange Cjson::children() const { return ChildRange(*this); }
+
 }  // namespace tdi
 
 #endif
@@ -89,6 +89,7 @@ const std::string TABLE_NOTIFICATIONS_CALLBACK_PARAMS = "callback_params";
 
 // Forward declarations
 class TdiInfoMapper;
+class JsonFileBuffer;
 
 class TdiInfoParser {
  public:
@@ -97,6 +98,101 @@ class TdiInfoParser {
   tdi_status_t parseTdiInfo(
       const std::vector<std::string> &tdi_info_file_paths);
 
+  /**
+   * @brief Set the directory of the binary schema cache. When set,
+   * parseTdiInfo() loads the parsed TableInfo/LearnInfo graph from a cached
+   * image keyed by a hash of the tdi.json contents if one exists, and
+   * writes one after parsing otherwise. Defaults to the value of the
+   * TDI_SCHEMA_CACHE_DIR environment variable. Empty disables the cache.
+   *
+   * @param[in] dir Cache directory. Must exist and be writable
+   */
+  void schemaCacheDirSet(const std::string &dir) { schema_cache_dir_ = dir; };
+  const std::string &schemaCacheDirGet() const { return schema_cache_dir_; };
+
+  /**
+   * @brief Hash of tdi.json files as used to key the schema cache, over the
+   * contents of the files and the enums of the TdiInfoMapper. Reads the
+   * files but does not parse them
+   *
+   * @param[in] tdi_info_file_paths tdi.json files
+   * @param[out] schema_hash Hash
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t schemaHashCompute(
+      const std::vector<std::string> &tdi_info_file_paths,
+      uint64_t *schema_hash) const;
+
+  /**
+   * @brief Whether the last parseTdiInfo() was served from the schema cache
+   */
+  const bool &loadedFromCacheGet() const { return loaded_from_cache_; };
+
+  /**
+   * @brief Set the number of worker threads parseTdiInfo() builds the
+   * TableInfo and LearnInfo objects with, one task per table or learn
+   * across all the files. 0 or 1 parse serially. Defaults to
+   * defaultParseThreadsGet()
+   *
+   * @param[in] num_threads Number of worker threads
+   */
+  void parseThreadsSet(const size_t &num_threads) {
+    parse_threads_ = num_threads;
+  };
+  const size_t &parseThreadsGet() const { return parse_threads_; };
+
+  /**
+   * @brief Default number of parse threads, from the TDI_PARSE_THREADS
+   * environment variable. 1 if not set. "0" picks one thread per core.
+   * Devices with several programs also parse the programs concurrently
+   * when this is above 1
+   */
+  static size_t defaultParseThreadsGet();
+
+  /**
+   * @brief Enable lazy parsing. Must be set before parseTdiInfo(). In lazy
+   * mode parseTdiInfo() only indexes table names and IDs and keeps the
+   * compact json text of every table, the parsed json of the files is freed.
+   * The TableInfo of a table is built by the first tableInfoBuild() on it,
+   * which parses the text again and then drops it. tableInfoMapGet() only
+   * holds the tables built so far. Learns are always parsed. No schema
+   * cache image is written in lazy mode since the graph is incomplete
+   *
+   * @param[in] lazy Enable lazy parsing
+   */
+  void lazyParseSet(const bool &lazy) { lazy_parse_ = lazy; };
+  const bool &lazyParseGet() const { return lazy_parse_; };
+
+  /**
+   * @brief Get the TableInfo of a table, building it first if it was not
+   * built yet. Not thread safe, callers serialize
+   *
+   * @param[in] name Fully qualified table name
+   * @param[out] table_info TableInfo
+   *
+   * @return Status of the API call. TDI_OBJECT_NOT_FOUND if the table does
+   * not exist or failed to parse
+   */
+  tdi_status_t tableInfoBuild(const std::string &name,
+                              const TableInfo **table_info);
+
+  /**
+   * @brief Fully qualified names and IDs of all the tables of the schema,
+   * whether built or not
+   */
+  const std::map<std::string, tdi_id_t> &tableIdIndexGet() const {
+    return table_id_index_;
+  };
+
+  /**
+   * @brief Compact json text of the tables not built yet in lazy mode, by
+   * fully qualified name
+   */
+  const std::map<std::string, std::string> &pendingTablesGet() const {
+    return pending_tables_;
+  };
+
   const std::map<std::string, std::unique_ptr<TableInfo>> &tableInfoMapGet()
       const {
     return table_info_map_;
@@ -106,6 +202,44 @@ class TdiInfoParser {
     return learn_info_map_;
   };
 
+  /**
+   * @brief Pool the strings of the parsed schema objects are interned in
+   */
+  const StringPool &stringPoolGet() const { return *string_pool_; };
+
+  /**
+   * @brief Intern the strings of this parser in the pool of another one.
+   * Must be called before parseTdiInfo(). Needed to move TableInfo and
+   * LearnInfo objects between the two parsers, see tableInfoSwap()
+   *
+   * @param[in] other Parser whose pool to share
+   */
+  void stringPoolShare(const TdiInfoParser &other) {
+    string_pool_ = other.string_pool_;
+  };
+
+  /**
+   * @brief Swap the TableInfo of a table with the one of the same name in
+   * another parser. Used by schema reload to carry the TableInfo of an
+   * unchanged table over to the new parser. Both parsers must share a
+   * string pool
+   *
+   * @param[in] other Parser to swap with
+   * @param[in] name Fully qualified table name
+   *
+   * @return Status of the API call. TDI_OBJECT_NOT_FOUND if either parser
+   * has not built the table
+   */
+  tdi_status_t tableInfoSwap(TdiInfoParser *other, const std::string &name);
+  tdi_status_t learnInfoSwap(TdiInfoParser *other, const std::string &name);
+
+  /**
+   * @brief Whether two TableInfo or LearnInfo objects have the same
+   * definition, i.e. encode to the same schema cache image
+   */
+  static bool tableInfoEqual(const TableInfo &a, const TableInfo &b);
+  static bool learnInfoEqual(const LearnInfo &a, const LearnInfo &b);
+
  private:
   std::unique_ptr<tdi::TableInfo> parseTable(const tdi::Cjson &table_tdi);
   std::unique_ptr<tdi::LearnInfo> parseLearn(const tdi::Cjson &learn_tdi);
@@ -129,9 +263,28 @@ class TdiInfoParser {
   tdi_operations_type_e operationsTypeStrToEnum(const std::string &type);
   tdi_attributes_type_e attributesTypeStrToEnum(const std::string &type);
 
+  // Binary schema cache, see tdi_info_cache.cpp
+  uint64_t schemaHashGet(
+      const std::vector<std::unique_ptr<JsonFileBuffer>> &contents) const;
+  std::string schemaCachePathGet(const uint64_t &schema_hash) const;
+  tdi_status_t schemaCacheRead(const std::string &path,
+                               const uint64_t &schema_hash);
+  tdi_status_t schemaCacheWrite(const std::string &path,
+                                const uint64_t &schema_hash) const;
+
   const std::unique_ptr<TdiInfoMapper> tdi_info_mapper_;
+  // Declared before the info maps, whose objects reference it. Shared
+  // between the old and new parser of a schema reload
+  std::shared_ptr<StringPool> string_pool_;
   std::map<std::string, std::unique_ptr<TableInfo>> table_info_map_;
   std::map<std::string, std::unique_ptr<LearnInfo>> learn_info_map_;
+  std::string schema_cache_dir_;
+  bool loaded_from_cache_{false};
+  bool lazy_parse_{false};
+  size_t parse_threads_{1};
+  // Name to ID of all tables, and json text of the tables not built yet
+  std::map<std::string, tdi_id_t> table_id_index_;
+  std::map<std::string, std::string> pending_tables_;
 };
 
 }  // namespace tdi
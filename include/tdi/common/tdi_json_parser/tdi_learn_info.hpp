@@ -127,6 +127,7 @@ class LearnInfo {
   std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> learn_field_map_;
   std::set<Annotation> annotations_{};
   mutable std::unique_ptr<LearnContextInfo> learn_context_info_;
+  friend class TdiInfoCacheCodec;
   friend class TdiInfoParser;
 };
 
@@ -0,0 +1,232 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file tdi_name_index.hpp
+ *
+ *  @brief Contains the hashed name indexes used for name lookups of tdi
+ *  objects
+ */
+#ifndef _TDI_NAME_INDEX_HPP
+#define _TDI_NAME_INDEX_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tdi {
+
+/**
+ * @brief Non owning reference to a name. Used as key of \ref tdi::NameIndex
+ * so that lookups can be done from a (const char *, length) pair without
+ * building a std::string
+ */
+struct NameRef {
+  NameRef(const char *data, size_t len) : data_(data), len_(len){};
+  bool operator==(const NameRef &other) const {
+    return len_ == other.len_ && std::memcmp(data_, other.data_, len_) == 0;
+  };
+  const char *data_;
+  size_t len_;
+};
+
+struct NameRefHash {
+  // FNV-1a
+  size_t operator()(const NameRef &name) const {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < name.len_; i++) {
+      hash ^= static_cast<unsigned char>(name.data_[i]);
+      hash *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash);
+  };
+};
+
+/**
+ * @brief Hash index from name to a pointer to a tdi object. The index does
+ * not own the names, they must outlive it. Names are typically the name
+ * members of the indexed objects or the keys of the std::map the index
+ * accompanies.
+ */
+template <typename T>
+class NameIndex {
+ public:
+  /**
+   * @brief Add a name to the index. An existing entry is overwritten
+   *
+   * @param[in] name Name, must outlive the index
+   * @param[in] value Object pointer
+   */
+  void insert(const std::string &name, T *value) {
+    map_[NameRef(name.data(), name.size())] = value;
+  };
+
+  /**
+   * @brief Find an object from its name. Doesn't allocate
+   *
+   * @param[in] name Name, need not be null terminated
+   * @param[in] len Length of the name
+   * @return Object pointer. nullptr if not found
+   */
+  T *find(const char *name, const size_t &len) const {
+    auto it = map_.find(NameRef(name, len));
+    if (it == map_.end()) return nullptr;
+    return it->second;
+  };
+
+  T *find(const std::string &name) const {
+    return find(name.data(), name.size());
+  };
+
+  void clear() { map_.clear(); };
+  size_t size() const { return map_.size(); };
+
+ private:
+  std::unordered_map<NameRef, T *, NameRefHash> map_;
+};
+
+/**
+ * @brief Index resolving the short names of tdi objects. Objects have fully
+ * qualified names made of '.' separated tokens, like
+ * pipe.SwitchIngress.forward, and can be looked up by any suffix of their
+ * name that starts at a token, e.g. SwitchIngress.forward or forward, as
+ * long as no other object of the index has the same suffix. A fully
+ * qualified name always resolves.<br>
+ * The index is a trie over the tokens of the names, last token first. Each
+ * node counts the names going through it and an edge is a hash entry from
+ * (parent node, token). Inserting a name takes one pass over it without
+ * building any suffix string and a lookup is linear in the length of the
+ * looked up name. Like \ref tdi::NameIndex, the index does not own the
+ * names, they must outlive it.
+ */
+template <typename T>
+class ShortNameIndex {
+ public:
+  ShortNameIndex() : nodes_(1){};
+
+  /**
+   * @brief Add an object to the index. Every name is added once
+   *
+   * @param[in] name Fully qualified name, must outlive the index
+   * @param[in] value Object pointer
+   */
+  void insert(const std::string &name, T *value) {
+    uint32_t node = 0;
+    size_t end = name.size();
+    while (true) {
+      size_t begin = tokenBeginGet(name.data(), end);
+      Edge edge(node, NameRef(name.data() + begin, end - begin));
+      auto it = edges_.find(edge);
+      if (it == edges_.end()) {
+        it = edges_.emplace(edge, static_cast<uint32_t>(nodes_.size())).first;
+        nodes_.emplace_back();
+      }
+      node = it->second;
+      auto &trie_node = nodes_[node];
+      bool resolvable = trie_node.valueGet() != nullptr;
+      // A second object with this suffix makes it ambiguous
+      trie_node.value = trie_node.count ? nullptr : value;
+      trie_node.count++;
+      // A fully qualified name always resolves to its own object
+      if (begin == 0) trie_node.exact = value;
+      size_ += (trie_node.valueGet() != nullptr) - resolvable;
+      if (begin == 0) break;
+      end = begin - 1;
+    }
+  };
+
+  /**
+   * @brief Find an object from its fully qualified name or an unambiguous
+   * suffix of it. Doesn't allocate
+   *
+   * @param[in] name Name, need not be null terminated
+   * @param[in] len Length of the name
+   * @return Object pointer. nullptr if not found or ambiguous
+   */
+  T *find(const char *name, const size_t &len) const {
+    uint32_t node = 0;
+    size_t end = len;
+    while (true) {
+      size_t begin = tokenBeginGet(name, end);
+      auto it = edges_.find(Edge(node, NameRef(name + begin, end - begin)));
+      if (it == edges_.end()) return nullptr;
+      node = it->second;
+      if (begin == 0) break;
+      end = begin - 1;
+    }
+    return nodes_[node].valueGet();
+  };
+
+  T *find(const std::string &name) const {
+    return find(name.data(), name.size());
+  };
+
+  void clear() {
+    nodes_.resize(1);
+    edges_.clear();
+    size_ = 0;
+  };
+
+  /**
+   * @brief Number of names that resolve to an object
+   */
+  size_t size() const { return size_; };
+
+  /**
+   * @brief Number of trie nodes, one per distinct suffix
+   */
+  size_t nodesGet() const { return nodes_.size() - 1; };
+
+ private:
+  struct Node {
+    T *valueGet() const { return exact ? exact : value; };
+    // Object named by this suffix, nullptr if more than one
+    T *value{nullptr};
+    // Object whose fully qualified name is this suffix
+    T *exact{nullptr};
+    uint32_t count{0};
+  };
+  struct Edge {
+    Edge(const uint32_t &parent, const NameRef &token)
+        : parent_(parent), token_(token){};
+    bool operator==(const Edge &other) const {
+      return parent_ == other.parent_ && token_ == other.token_;
+    };
+    uint32_t parent_;
+    NameRef token_;
+  };
+  struct EdgeHash {
+    size_t operator()(const Edge &edge) const {
+      return NameRefHash()(edge.token_) ^
+             (static_cast<size_t>(edge.parent_) * 0x9E3779B97F4A7C15ULL);
+    };
+  };
+
+  // Start of the token ending at end, i.e. one past the '.' before it
+  static size_t tokenBeginGet(const char *name, size_t end) {
+    while (end > 0 && name[end - 1] != '.') end--;
+    return end;
+  };
+
+  // nodes_[0] is the root, the empty suffix
+  std::vector<Node> nodes_;
+  std::unordered_map<Edge, uint32_t, EdgeHash> edges_;
+  size_t size_{0};
+};
+
+}  // namespace tdi
+
+#endif  // _TDI_NAME_INDEX_HPP
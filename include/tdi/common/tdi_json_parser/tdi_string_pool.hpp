@@ -0,0 +1,103 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file tdi_string_pool.hpp
+ *
+ *  @brief Contains the pool the schema strings of a program are interned in
+ */
+#ifndef _TDI_STRING_POOL_HPP
+#define _TDI_STRING_POOL_HPP
+
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace tdi {
+
+/**
+ * @brief Pool of interned strings and string lists. Schema objects keep
+ * references into the pool instead of their own copies, so a string that
+ * repeats across fields, like an annotation or "INVALID", is stored once,
+ * and interned strings of the same pool are equal if their addresses are.
+ * Entries are never removed and their addresses are stable. Thread safe,
+ * the pool is split into stripes by hash, each with its own lock, so that
+ * parallel parse tasks interning into one pool rarely wait for each other.
+ *
+ * The pool of a program is owned by its TdiInfoParser, and so by its
+ * TdiInfo. References into it are valid as long as the TdiInfo is.
+ */
+class StringPool {
+ public:
+  StringPool() = default;
+  StringPool(const StringPool &) = delete;
+  StringPool &operator=(const StringPool &) = delete;
+
+  /**
+   * @brief Intern a string
+   *
+   * @param[in] str String
+   * @return Pooled string equal to str
+   */
+  const std::string &intern(const std::string &str);
+
+  /**
+   * @brief Intern a list of strings as a whole, e.g. the enum choices of a
+   * field
+   *
+   * @param[in] strs Strings
+   * @return Pooled list equal to strs
+   */
+  const std::vector<std::string> &intern(const std::vector<std::string> &strs);
+
+  /**
+   * @brief Number of distinct strings and string lists in the pool
+   */
+  size_t sizeGet() const;
+
+  /**
+   * @brief Approximate number of bytes held by the pool
+   */
+  size_t bytesGet() const;
+
+  /**
+   * @brief Process wide pool. Used by objects created outside of a parser,
+   * like annotations built by applications
+   */
+  static StringPool &defaultGet();
+
+  /**
+   * @brief Heap bytes of a string beyond the object itself, for memory
+   * accounting. Short strings are stored inline
+   */
+  static size_t stringHeapBytes(const std::string &str) {
+    return str.capacity() > 15 ? str.capacity() + 1 : 0;
+  };
+
+ private:
+  static const size_t kStripes = 16;
+  struct Stripe {
+    mutable std::mutex mtx;
+    std::unordered_set<std::string> strings;
+    std::set<std::vector<std::string>> string_lists;
+    size_t bytes{0};
+  };
+  Stripe stripes_[kStripes];
+};
+
+}  // namespace tdi
+
+#endif  // _TDI_STRING_POOL_HPP
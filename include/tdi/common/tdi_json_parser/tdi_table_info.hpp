@@ -20,6 +20,7 @@
 #ifndef _TDI_TABLE_INFO_HPP
 #define _TDI_TABLE_INFO_HPP
 
+#include <cstdint>
 #include <cstring>
 #include <map>
 #include <memory>
@@ -29,6 +30,8 @@
 #include <vector>
 
 #include <tdi/common/tdi_defs.h>
+#include <tdi/common/tdi_json_parser/tdi_name_index.hpp>
+#include <tdi/common/tdi_json_parser/tdi_string_pool.hpp>
 
 namespace tdi {
 
@@ -71,18 +74,27 @@ class ActionContextInfo {};
  *  9. ("$tdi_field_imp_level", "level") Importance level of a field. All
  *fields
  *     start off with an importance level of 1
+ *
+ * The strings are interned in a \ref tdi::StringPool. Annotations parsed from
+ * a schema use the pool of their program and are valid as long as its
+ * TdiInfo, other ones use the process wide pool.
  */
 class Annotation {
  public:
-  Annotation(std::string name, std::string value) : name_(name), value_(value) {
-    full_name_ = name_ + "." + value_;
-  };
+  Annotation(std::string name, std::string value)
+      : Annotation(StringPool::defaultGet(), name, value){};
+  Annotation(StringPool &pool,
+             const std::string &name,
+             const std::string &value)
+      : name_(pool.intern(name)),
+        value_(pool.intern(value)),
+        full_name_(&pool.intern(name + "." + value)){};
   bool operator<(const Annotation &other) const;
   bool operator==(const Annotation &other) const;
   bool operator==(const std::string &other_str) const;
   tdi_status_t fullNameGet(std::string *fullName) const;
-  const std::string name_{""};
-  const std::string value_{""};
+  const std::string &name_;
+  const std::string &value_;
   struct Less {
     bool operator()(const Annotation &lhs, const Annotation &rhs) const {
       return lhs < rhs;
@@ -90,7 +102,7 @@ class Annotation {
   };
 
  private:
-  std::string full_name_{""};
+  const std::string *full_name_;
 };
 
 class SupportedApis {
@@ -201,9 +213,20 @@ class KeyFieldInfo {
     return key_field_context_info_.get();
   };
 
+  /**
+   * @brief Get the ordinal of the key field. Key fields of a table are
+   * numbered 0..N-1 in increasing order of their IDs. See
+   * TableInfo::keyFieldByOrdinalGet
+   *
+   * @return Ordinal of the key field
+   */
+  const uint32_t &ordinalGet() const { return ordinal_; };
+
  private:
-  KeyFieldInfo(tdi_id_t field_id,
-               std::string name,
+  // Strings are interned in pool
+  KeyFieldInfo(StringPool &pool,
+               tdi_id_t field_id,
+               const std::string &name,
                size_t size_bits,
                tdi_match_type_e match_type,
                tdi_field_data_type_e data_type,
@@ -212,41 +235,45 @@ class KeyFieldInfo {
                const std::set<tdi::Annotation> &annotations,
                uint64_t default_value,
                float default_fl_value,
-               std::string default_str_value,
+               const std::string &default_str_value,
                bool is_field_slice,
                bool is_ptr,
                bool match_priority)
       : field_id_(field_id),
-        name_(name),
+        name_(pool.intern(name)),
         size_bits_(size_bits),
         match_type_(match_type),
         data_type_(data_type),
         mandatory_(mandatory),
-        enum_choices_(enum_choices),
+        enum_choices_(pool.intern(enum_choices)),
         annotations_(annotations),
         default_value_(default_value),
         default_fl_value_(default_fl_value),
-        default_str_value_(default_str_value),
+        default_str_value_(pool.intern(default_str_value)),
         is_field_slice_(is_field_slice),
         is_ptr_(is_ptr),
         match_priority_(match_priority){};
   const tdi_id_t field_id_;
-  const std::string name_;
+  const std::string &name_;
   const size_t size_bits_;
   const tdi_match_type_e match_type_;
   const tdi_field_data_type_e data_type_;
   const bool mandatory_;
-  const std::vector<std::string> enum_choices_;
+  const std::vector<std::string> &enum_choices_;
   const std::set<tdi::Annotation> annotations_;
 
   const uint64_t default_value_;
   const float default_fl_value_;
-  const std::string default_str_value_;
+  const std::string &default_str_value_;
 
   const bool is_field_slice_{false};
   const bool is_ptr_{false};
   const bool match_priority_{false};
   mutable std::unique_ptr<KeyFieldContextInfo> key_field_context_info_;
+  // Set by TableInfo
+  uint32_t ordinal_{0};
+  friend class TableInfo;
+  friend class TdiInfoCacheCodec;
   friend class TdiInfoParser;
 };  // class KeyFieldInfo
 
@@ -305,7 +332,7 @@ class DataFieldInfo {
    *
    */
   const std::set<tdi_id_t> &oneofSiblingsGet() const {
-    return oneof_siblings_;
+    return extrasGet().oneof_siblings_;
   };
 
   /**
@@ -345,7 +372,7 @@ class DataFieldInfo {
    * @return Status of the API call
    */
   const std::set<tdi::Annotation> &annotationsGet() const {
-    return annotations_;
+    return extrasGet().annotations_;
   };
 
   /**
@@ -401,9 +428,39 @@ class DataFieldInfo {
    */
   float defaultFlValueGet() const { return default_fl_value_; }
 
+  /**
+   * @brief Get the ordinal of the data field. Fields of an action are
+   * numbered 0..N-1 in increasing order of their IDs, and so are the common
+   * data fields of a table. See TableInfo::dataFieldByOrdinalGet
+   *
+   * @return Ordinal of the data field
+   */
+  const uint32_t &ordinalGet() const { return ordinal_; };
+
+  /**
+   * @brief Get the index of the field ID among all the data field IDs of
+   * its table, see TableInfo::dataFieldIndexGet. For common data fields it
+   * is the same as the ordinal
+   *
+   * @return Data field index in the table
+   */
+  const uint32_t &indexGet() const { return index_; };
+
  private:
-  DataFieldInfo(tdi_id_t field_id,
-                std::string name,
+  // Members most fields don't have, like annotations, oneof siblings and
+  // containers. They are kept out of line so that a plain fixed width field
+  // holds only its scalars and interned strings
+  struct Extras {
+    std::set<tdi::Annotation> annotations_;
+    std::set<tdi_id_t> oneof_siblings_;
+    std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> container_;
+    std::map<std::string, tdi_id_t> container_names_;
+  };
+
+  // Strings are interned in pool
+  DataFieldInfo(StringPool &pool,
+                tdi_id_t field_id,
+                const std::string &name,
                 size_t size_bits,
                 tdi_field_data_type_e data_type,
                 bool mandatory,
@@ -412,42 +469,60 @@ class DataFieldInfo {
                 const std::set<tdi::Annotation> annotations,
                 uint64_t default_value,
                 float default_fl_value,
-                std::string default_str_value,
+                const std::string &default_str_value,
                 bool repeated,
                 bool container_valid,
                 std::set<tdi_id_t> oneof_siblings)
       : field_id_(field_id),
-        name_(name),
-        size_bits_(size_bits),
         data_type_(data_type),
-        mandatory_(mandatory),
-        read_only_(read_only),
-        enum_choices_(enum_choices),
-        annotations_(annotations),
+        size_bits_(size_bits),
+        name_(pool.intern(name)),
+        enum_choices_(pool.intern(enum_choices)),
+        default_str_value_(pool.intern(default_str_value)),
         default_value_(default_value),
         default_fl_value_(default_fl_value),
-        default_str_value_(default_str_value),
+        mandatory_(mandatory),
+        read_only_(read_only),
         repeated_(repeated),
-        container_valid_(container_valid),
-        oneof_siblings_(oneof_siblings){};
+        container_valid_(container_valid) {
+    if (!annotations.empty() || !oneof_siblings.empty()) {
+      std::unique_ptr<Extras> extras(new Extras());
+      extras->annotations_ = annotations;
+      extras->oneof_siblings_ = std::move(oneof_siblings);
+      extras_ = std::move(extras);
+    }
+  };
+
+  const Extras &extrasGet() const {
+    return extras_ ? *extras_ : noExtrasGet();
+  };
+  // Shared empty Extras of the fields that have none
+  static const Extras &noExtrasGet();
+
+  // Ordered by size to avoid padding
   const tdi_id_t field_id_;
-  const std::string name_;
-  const size_t size_bits_;
   const tdi_field_data_type_e data_type_;
+  const size_t size_bits_;
+  const std::string &name_;
+  const std::vector<std::string> &enum_choices_;
+  const std::string &default_str_value_;
+  const uint64_t default_value_;
+  const float default_fl_value_;
+  // Set by ActionInfo or TableInfo
+  uint32_t ordinal_{0};
+  // Set by TableInfo
+  uint32_t index_{0};
   const bool is_ptr_{false};
   const bool mandatory_;
   const bool read_only_;
-  const std::vector<std::string> enum_choices_;
-  const std::set<tdi::Annotation> annotations_;
-  const uint64_t default_value_;
-  const float default_fl_value_;
-  const std::string default_str_value_;
   const bool repeated_;
   const bool container_valid_{false};
-  const std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> container_;
-  const std::map<std::string, tdi_id_t> container_names_;
-  const std::set<tdi_id_t> oneof_siblings_;
+  // nullptr if the field has no extras
+  std::unique_ptr<const Extras> extras_;
   mutable std::unique_ptr<DataFieldContextInfo> data_field_context_info_;
+  friend class ActionInfo;
+  friend class TableInfo;
+  friend class TdiInfoCacheCodec;
   friend class TdiInfoParser;
 };
 
@@ -512,6 +587,34 @@ class ActionInfo {
     return data_fields_;
   };
 
+  /**
+   * @brief Get the ordinal of the action. Actions of a table are numbered
+   * 0..N-1 in increasing order of their IDs. See
+   * TableInfo::actionByOrdinalGet
+   *
+   * @return Ordinal of the action
+   */
+  const uint32_t &ordinalGet() const { return ordinal_; };
+
+  /**
+   * @brief Get number of data fields of the action
+   *
+   * @return Number of data fields
+   */
+  size_t dataFieldCountGet() const { return data_fields_by_ordinal_.size(); };
+
+  /**
+   * @brief Get a data field of the action from its ordinal
+   *
+   * @param[in] field_ordinal Ordinal of the data field in the action
+   * @return DataFieldInfo object. nullptr if out of range
+   */
+  const DataFieldInfo *dataFieldByOrdinalGet(
+      const uint32_t &field_ordinal) const {
+    if (field_ordinal >= data_fields_by_ordinal_.size()) return nullptr;
+    return data_fields_by_ordinal_[field_ordinal];
+  };
+
   // Map of table_data_fields with names
   std::map<std::string, const DataFieldInfo *> data_fields_names_;
 
@@ -524,10 +627,14 @@ class ActionInfo {
         name_(name),
         data_fields_(std::move(data_fields)),
         annotations_(annotations) {
-    // update relevant map
+    // update relevant maps
     for (const auto &kv : data_fields_) {
       const auto data_field = kv.second.get();
       data_fields_names_[data_field->nameGet()] = data_field;
+      data_fields_name_index_.insert(data_field->nameGet(), data_field);
+      kv.second->ordinal_ =
+          static_cast<uint32_t>(data_fields_by_ordinal_.size());
+      data_fields_by_ordinal_.push_back(data_field);
     }
   };
 
@@ -537,7 +644,14 @@ class ActionInfo {
   const std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> data_fields_;
   const std::set<tdi::Annotation> annotations_;
   mutable std::unique_ptr<ActionContextInfo> action_context_info_;
+  // Data fields indexed by their ordinal
+  std::vector<const DataFieldInfo *> data_fields_by_ordinal_;
+  // Hashed counterpart of data_fields_names_
+  NameIndex<const DataFieldInfo> data_fields_name_index_;
+  // Set by TableInfo
+  uint32_t ordinal_{0};
   friend class TableInfo;
+  friend class TdiInfoCacheCodec;
   friend class TdiInfoParser;
 };
 
@@ -588,8 +702,10 @@ class NotificationParamInfo {
   /** @} */  // End of group NotificationParamInfo
 
  private:
-  NotificationParamInfo(tdi_id_t field_id,
-                        std::string name,
+  // Strings are interned in pool
+  NotificationParamInfo(StringPool &pool,
+                        tdi_id_t field_id,
+                        const std::string &name,
                         bool repeated,
                         size_t size_bits,
                         tdi_field_data_type_e data_type,
@@ -598,30 +714,31 @@ class NotificationParamInfo {
                         const std::set<tdi::Annotation> &annotations,
                         uint64_t default_value,
                         float default_fl_value,
-                        std::string default_str_value)
+                        const std::string &default_str_value)
       : field_id_(field_id),
-        name_(name),
+        name_(pool.intern(name)),
         repeated_(repeated),
         size_bits_(size_bits),
         data_type_(data_type),
         mandatory_(mandatory),
-        enum_choices_(enum_choices),
+        enum_choices_(pool.intern(enum_choices)),
         annotations_(annotations),
         default_value_(default_value),
         default_fl_value_(default_fl_value),
-        default_str_value_(default_str_value){};
+        default_str_value_(pool.intern(default_str_value)){};
   const tdi_id_t field_id_;
-  const std::string name_;
+  const std::string &name_;
   const bool repeated_;
   const size_t size_bits_;
   const tdi_field_data_type_e data_type_;
   const bool mandatory_;
-  const std::vector<std::string> enum_choices_;
+  const std::vector<std::string> &enum_choices_;
   const std::set<tdi::Annotation> annotations_;
   const uint64_t default_value_;
   const float default_fl_value_;
-  const std::string default_str_value_;
+  const std::string &default_str_value_;
 
+  friend class TdiInfoCacheCodec;
   friend class TdiInfoParser;
 };  // class NotificationParamInfo
 
@@ -719,6 +836,7 @@ class NotificationInfo {
       callback_params_fields_;
   const std::set<tdi::Annotation> annotations_;
   friend class TableInfo;
+  friend class TdiInfoCacheCodec;
   friend class TdiInfoParser;
 };
 
@@ -826,6 +944,15 @@ class TableInfo {
    */
   const KeyFieldInfo *keyFieldGet(const std::string &name) const;
 
+  /**
+   * @brief Get Key Field from name. Doesn't allocate
+   *
+   * @param[in] name name of field, need not be null terminated
+   * @param[in] len length of name
+   * @return key_field_info KeyFieldInfo object. nullptr if not found
+   */
+  const KeyFieldInfo *keyFieldGet(const char *name, const size_t &len) const;
+
   /**
    * @brief Get Key Field from tdi_id
    *
@@ -891,6 +1018,19 @@ class TableInfo {
   const DataFieldInfo *dataFieldGet(const std::string &name,
                                     const tdi_id_t &action_id) const;
 
+  /**
+   * @brief Get the data Field info object from name. Doesn't allocate
+   *
+   * @param[in] name name of a Data field, need not be null terminated
+   * @param[in] len length of name
+   * @param[in] action_id Action ID
+   * @return DataFieldInfo object. nullptr if doesn't exist
+   *
+   */
+  const DataFieldInfo *dataFieldGet(const char *name,
+                                    const size_t &len,
+                                    const tdi_id_t &action_id) const;
+
   /**
    * @brief Get the data Field info object from tdi_id.
    *
@@ -911,6 +1051,133 @@ class TableInfo {
   const DataFieldInfo *dataFieldGet(const tdi_id_t &field_id,
                                     const tdi_id_t &action_id) const;
 
+  /**
+   * @brief Get number of key fields of the table
+   * @return Number of key fields
+   */
+  size_t keyFieldCountGet() const { return key_fields_by_ordinal_.size(); };
+
+  /**
+   * @brief Get a key field from its ordinal, see KeyFieldInfo::ordinalGet.
+   * Unlike keyFieldGet this is a plain array access
+   *
+   * @param[in] ordinal Ordinal of the key field
+   * @return KeyFieldInfo object. nullptr if out of range
+   */
+  const KeyFieldInfo *keyFieldByOrdinalGet(const uint32_t &ordinal) const {
+    if (ordinal >= key_fields_by_ordinal_.size()) return nullptr;
+    return key_fields_by_ordinal_[ordinal];
+  };
+
+  /**
+   * @brief Get number of common (non action) data fields of the table
+   * @return Number of common data fields
+   */
+  size_t dataFieldCountGet() const { return data_fields_by_ordinal_.size(); };
+
+  /**
+   * @brief Get a common data field from its ordinal, see
+   * DataFieldInfo::ordinalGet
+   *
+   * @param[in] field_ordinal Ordinal of the common data field
+   * @return DataFieldInfo object. nullptr if out of range
+   */
+  const DataFieldInfo *dataFieldByOrdinalGet(
+      const uint32_t &field_ordinal) const {
+    if (field_ordinal >= data_fields_by_ordinal_.size()) return nullptr;
+    return data_fields_by_ordinal_[field_ordinal];
+  };
+
+  /**
+   * @brief Get a data field of an action from the ordinal of the action
+   * and the ordinal of the field within it
+   *
+   * @param[in] action_ordinal Ordinal of the action
+   * @param[in] field_ordinal Ordinal of the data field in the action
+   * @return DataFieldInfo object. nullptr if either is out of range
+   */
+  const DataFieldInfo *dataFieldByOrdinalGet(
+      const uint32_t &action_ordinal, const uint32_t &field_ordinal) const {
+    if (action_ordinal >= actions_by_ordinal_.size()) return nullptr;
+    return actions_by_ordinal_[action_ordinal]->dataFieldByOrdinalGet(
+        field_ordinal);
+  };
+
+  /**
+   * @brief Get number of actions of the table
+   * @return Number of actions
+   */
+  size_t actionCountGet() const { return actions_by_ordinal_.size(); };
+
+  /**
+   * @brief Get an action from its ordinal, see ActionInfo::ordinalGet
+   *
+   * @param[in] ordinal Ordinal of the action
+   * @return ActionInfo object. nullptr if out of range
+   */
+  const ActionInfo *actionByOrdinalGet(const uint32_t &ordinal) const {
+    if (ordinal >= actions_by_ordinal_.size()) return nullptr;
+    return actions_by_ordinal_[ordinal];
+  };
+
+  /**
+   * @brief Get the index of a data field ID among all the distinct data
+   * field IDs of the table, common ones and those of every action. Indices
+   * are dense, in 0..dataFieldIndexCountGet()-1, so that per field state
+   * can be kept in flat arrays or bitmaps, like the active fields of
+   * \ref tdi::TableData. Fields of different actions sharing the same ID
+   * share the same index. Common data fields come first, their index is
+   * their ordinal. The index is also available from
+   * DataFieldInfo::indexGet. Small IDs, like action parameters, are looked
+   * up with a plain array access.
+   *
+   * @param[in] field_id Data field ID
+   * @param[out] index Index of the field ID
+   * @return Status of the API call. TDI_OBJECT_NOT_FOUND if the ID is not
+   * a data field ID of the table
+   */
+  tdi_status_t dataFieldIndexGet(const tdi_id_t &field_id,
+                                 uint32_t *index) const {
+    uint32_t i = field_id < data_field_index_by_id_.size()
+                     ? data_field_index_by_id_[field_id]
+                     : dataFieldIndexSparseGet(field_id);
+    if (i == UINT32_MAX) {
+      return TDI_OBJECT_NOT_FOUND;
+    }
+    *index = i;
+    return TDI_SUCCESS;
+  };
+
+  /**
+   * @brief Get the number of distinct data field IDs of the table
+   * @return Number of data field indices
+   */
+  size_t dataFieldIndexCountGet() const {
+    return data_field_index_ids_.size();
+  };
+
+  /**
+   * @brief Get the data field ID for an index returned by dataFieldIndexGet
+   *
+   * @param[in] index Data field index
+   * @return Field ID. 0 if index is out of range
+   */
+  tdi_id_t dataFieldIdFromIndexGet(const uint32_t &index) const {
+    if (index >= data_field_index_ids_.size()) return 0;
+    return data_field_index_ids_[index];
+  };
+
+  /**
+   * @brief Get the memory used by the data field index
+   * @return Size in bytes
+   */
+  size_t dataFieldIndexBytesGet() const {
+    return data_field_index_by_id_.capacity() * sizeof(uint32_t) +
+           data_field_index_sparse_.capacity() *
+               sizeof(std::pair<tdi_id_t, uint32_t>) +
+           data_field_index_ids_.capacity() * sizeof(tdi_id_t);
+  };
+
   /**
    * @brief Get vector of Action IDs
    * @return Vector of Action IDs
@@ -927,6 +1194,16 @@ class TableInfo {
    */
   const ActionInfo *actionGet(const std::string &name) const;
 
+  /**
+   * @brief Get ActionInfo object from action name. Doesn't allocate
+   *
+   * @param[in] name Name of Action, need not be null terminated
+   * @param[in] len length of name
+   *
+   * @return ActionInfo object. nullptr if not found
+   */
+  const ActionInfo *actionGet(const char *name, const size_t &len) const;
+
   /**
    * @brief Get ActionInfo object from tdi_id of action (action_id)
    *
@@ -1008,6 +1285,8 @@ class TableInfo {
     return table_notification_map_;
   }
 
+  // Name lookups go through the hashed indices built along with these
+  // maps in the constructor, see keyFieldGet, dataFieldGet and actionGet
   std::map<std::string, const KeyFieldInfo *> name_key_map_;
   std::map<std::string, const DataFieldInfo *> name_data_map_;
   std::map<std::string, const ActionInfo *> name_action_map_;
@@ -1044,28 +1323,48 @@ class TableInfo {
         operations_type_set_(operations_type_set),
         attributes_type_set_(attributes_type_set),
         annotations_(annotations) {
-    // update relevant maps
+    // update relevant maps. Maps are ordered by ID so ordinals follow
+    // increasing IDs
     for (const auto &kv : table_key_map_) {
       const KeyFieldInfo *key_field = kv.second.get();
       name_key_map_[key_field->nameGet()] = key_field;
+      key_name_index_.insert(key_field->nameGet(), key_field);
+      kv.second->ordinal_ =
+          static_cast<uint32_t>(key_fields_by_ordinal_.size());
+      key_fields_by_ordinal_.push_back(key_field);
     }
 
     for (const auto &kv : table_action_map_) {
       const auto action = kv.second.get();
       name_action_map_[action->nameGet()] = action;
+      action_name_index_.insert(action->nameGet(), action);
+      kv.second->ordinal_ = static_cast<uint32_t>(actions_by_ordinal_.size());
+      actions_by_ordinal_.push_back(action);
     }
 
     for (const auto &kv : table_data_map_) {
       const auto data_field = kv.second.get();
       name_data_map_[data_field->nameGet()] = data_field;
+      data_name_index_.insert(data_field->nameGet(), data_field);
+      kv.second->ordinal_ =
+          static_cast<uint32_t>(data_fields_by_ordinal_.size());
+      data_fields_by_ordinal_.push_back(data_field);
     }
 
     for (const auto &kv : table_notification_map_) {
       const auto notification = kv.second.get();
       name_notifications_map_[notification->nameGet()] = notification;
     }
+
+    dataFieldIndexBuild();
   };
 
+  // Assign dense indices to the distinct data field IDs of the table
+  void dataFieldIndexBuild();
+  // Index of a field ID too large for data_field_index_by_id_, UINT32_MAX
+  // if none
+  uint32_t dataFieldIndexSparseGet(const tdi_id_t &field_id) const;
+
   const tdi_id_t id_;
   const std::string name_;
   const tdi_table_type_e table_type_;
@@ -1082,7 +1381,24 @@ class TableInfo {
   const std::set<tdi_attributes_type_e> attributes_type_set_;
   const std::set<Annotation> annotations_{};
 
+  // Hashed counterparts of the name maps, used for lookups
+  NameIndex<const KeyFieldInfo> key_name_index_;
+  NameIndex<const DataFieldInfo> data_name_index_;
+  NameIndex<const ActionInfo> action_name_index_;
+  // Flat arrays indexed by ordinal
+  std::vector<const KeyFieldInfo *> key_fields_by_ordinal_;
+  std::vector<const DataFieldInfo *> data_fields_by_ordinal_;
+  std::vector<const ActionInfo *> actions_by_ordinal_;
+  // Data field ID <-> dense index. See dataFieldIndexGet. IDs below the
+  // size of data_field_index_by_id_ are mapped directly, UINT32_MAX for
+  // none. The few larger ones, usually the common fields, are kept sorted
+  // in data_field_index_sparse_
+  std::vector<uint32_t> data_field_index_by_id_;
+  std::vector<std::pair<tdi_id_t, uint32_t>> data_field_index_sparse_;
+  std::vector<tdi_id_t> data_field_index_ids_;
+
   mutable std::unique_ptr<TableContextInfo> table_context_info_;
+  friend class TdiInfoCacheCodec;
   friend class TdiInfoParser;
 };
 
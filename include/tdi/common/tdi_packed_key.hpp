@@ -0,0 +1,172 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file tdi_packed_key.hpp
+ *
+ *  @brief Contains a fixed width packed representation of table keys
+ */
+#ifndef _TDI_PACKED_KEY_HPP
+#define _TDI_PACKED_KEY_HPP
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <tdi/common/tdi_defs.h>
+#include <tdi/common/tdi_json_parser/tdi_table_info.hpp>
+#include <tdi/common/tdi_table_key.hpp>
+
+namespace tdi {
+
+/**
+ * @brief Layout of the packed keys of a table. Computed once per table from
+ * \ref tdi::TableInfo::tableKeyMapGet(), see \ref
+ * tdi::Table::packedKeyLayoutGet()<br>
+ * Every key field gets (width + 7) / 8 bytes at the same offset in a value
+ * buffer and in a mask buffer, fields in increasing order of field ID. Both
+ * buffers are padded to a multiple of 8 bytes.
+ * - Exact : value, mask of all ones over the field width
+ * - Ternary : value & mask, mask
+ * - LPM : value & prefix mask, prefix mask
+ * - Range : low, high in place of the mask
+ */
+class PackedKeyLayout {
+ public:
+  struct Field {
+    tdi_id_t id_;
+    tdi_match_type_e match_type_;
+    size_t width_;
+    // Byte offset of the field in the value and mask buffers
+    size_t offset_;
+    size_t size_;
+  };
+
+  /**
+   * @brief Compute the packed key layout of a table. Only tables whose key
+   * fields are all of fixed size and of a core match type are supported
+   *
+   * @param[in] table_info Table info
+   * @param[out] layout Layout
+   *
+   * @return Status of the API call
+   */
+  static tdi_status_t layoutCreate(const TableInfo *table_info,
+                                   std::unique_ptr<PackedKeyLayout> *layout);
+
+  const TableInfo *tableInfoGet() const { return table_info_; };
+  const std::vector<Field> &fieldsGet() const { return fields_; };
+  /**
+   * @brief Size in bytes of one of the value or mask buffers
+   */
+  const size_t &sizeGet() const { return size_; };
+  /**
+   * @brief Mask of all ones over the width of every field, i.e. the mask
+   * buffer of a key whose fields are all exact
+   */
+  const uint8_t *exactMaskGet() const { return exact_mask_.data(); };
+
+ private:
+  PackedKeyLayout(const TableInfo *table_info) : table_info_(table_info){};
+
+  const TableInfo *table_info_;
+  std::vector<Field> fields_;
+  size_t size_{0};
+  std::vector<uint8_t> exact_mask_;
+};
+
+/**
+ * @brief Fixed width packed copy of a \ref tdi::TableKey. Comparison and
+ * hashing run over the whole value and mask buffers with no per field
+ * virtual calls, which makes it suitable as key of shadow caches and for
+ * diffing large sets of entries.
+ */
+class PackedKey {
+ public:
+  explicit PackedKey(const PackedKeyLayout *layout)
+      : layout_(layout), words_(2 * layout->sizeGet() / sizeof(uint64_t), 0){};
+
+  /**
+   * @brief Pack a key. The key must belong to the table of the layout
+   *
+   * @param[in] key Key to pack
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t pack(const TableKey &key);
+
+  /**
+   * @brief Set all the key fields of a key from this packed key
+   *
+   * @param[out] key Key of the table of the layout
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t unpack(TableKey *key) const;
+
+  const PackedKeyLayout *layoutGet() const { return layout_; };
+  const uint8_t *valueGet() const {
+    return reinterpret_cast<const uint8_t *>(words_.data());
+  };
+  const uint8_t *maskGet() const { return valueGet() + layout_->sizeGet(); };
+
+  /**
+   * @brief Total order over the packed bytes. Keys of different layouts
+   * are ordered by layout
+   */
+  int compare(const PackedKey &other) const {
+    if (layout_ != other.layout_) return layout_ < other.layout_ ? -1 : 1;
+    return std::memcmp(
+        words_.data(), other.words_.data(), words_.size() * sizeof(uint64_t));
+  };
+  bool operator==(const PackedKey &other) const {
+    return compare(other) == 0;
+  };
+  bool operator!=(const PackedKey &other) const { return !(*this == other); };
+  bool operator<(const PackedKey &other) const { return compare(other) < 0; };
+
+  uint64_t hash() const {
+    // FNV-1a over 64 bit words followed by a final avalanche
+    uint64_t h = 14695981039346656037ULL;
+    for (const auto &word : words_) {
+      h ^= word;
+      h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+  };
+
+ private:
+  uint8_t *valueMutableGet() {
+    return reinterpret_cast<uint8_t *>(words_.data());
+  };
+  uint8_t *maskMutableGet() { return valueMutableGet() + layout_->sizeGet(); };
+
+  const PackedKeyLayout *layout_;
+  // Value buffer followed by the mask buffer. Stored as words to keep both
+  // 8 byte aligned
+  std::vector<uint64_t> words_;
+};
+
+struct PackedKeyHash {
+  size_t operator()(const PackedKey &key) const {
+    return static_cast<size_t>(key.hash());
+  };
+};
+
+}  // namespace tdi
+
+#endif  // _TDI_PACKED_KEY_HPP
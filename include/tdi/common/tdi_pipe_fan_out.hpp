@@ -0,0 +1,132 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file tdi_pipe_fan_out.hpp
+ *
+ *  @brief Contains PipeFanOut, which programs a write aimed at all pipes
+ *  of a device in every pipe in parallel
+ */
+#ifndef _TDI_PIPE_FAN_OUT_HPP
+#define _TDI_PIPE_FAN_OUT_HPP
+
+#include <functional>
+#include <vector>
+
+#include <tdi/common/tdi_defs.h>
+#include <tdi/common/tdi_target.hpp>
+
+namespace tdi {
+
+// Fwd declaration
+class TdiThreadPool;
+
+/**
+ * @brief Helper for table implementations of architectures with pipes,
+ * like TNA and PNA. A target whose pipe is the all pipes value must be
+ * programmed once in every pipe. PipeFanOut runs the per pipe programming
+ * of such a write concurrently on a TdiThreadPool and merges the
+ * statuses. A target naming a single pipe runs in the calling thread.<br>
+ * The calling thread programs pipes too and only waits for pipes already
+ * started by a worker, so a fan out can be started from a task of the same
+ * pool. Statuses are merged in the order of the pipe list, the result of a
+ * fan out doesn't depend on the scheduling.
+ */
+class PipeFanOut {
+ public:
+  /**
+   * @brief Programming of one pipe
+   */
+  using pipeOp = std::function<tdi_status_t(const uint64_t &pipe)>;
+  /**
+   * @brief Programming of a batch in one pipe. status_vec is sized to the
+   * batch and set to TDI_SUCCESS, the op sets the status of every entry
+   */
+  using pipeBatchOp = std::function<tdi_status_t(
+      const uint64_t &pipe, std::vector<tdi_status_t> *status_vec)>;
+
+  /**
+   * @brief Constructor
+   *
+   * @param[in] pipe_field Target field holding the pipe, e.g.
+   * TDI_TNA_TARGET_PIPE_ID
+   * @param[in] all_pipes Pipe value meaning every pipe, e.g.
+   * TNA_DEV_PIPE_ALL
+   * @param[in] pool Pool running the pipes. nullptr for defaultPoolGet()
+   */
+  PipeFanOut(const tdi_target_e &pipe_field,
+             const uint64_t &all_pipes,
+             TdiThreadPool *pool = nullptr)
+      : pipe_field_(pipe_field), all_pipes_(all_pipes), pool_(pool){};
+
+  /**
+   * @brief Run op for the pipe of dev_tgt, or for every pipe of pipes if
+   * dev_tgt is for all pipes
+   *
+   * @param[in] dev_tgt Device target of the write
+   * @param[in] pipes Pipes of the device
+   * @param[in] op Programming of one pipe, called concurrently
+   *
+   * @return TDI_SUCCESS if every pipe succeeded, else the status of the
+   * first failed pipe in the order of pipes
+   */
+  tdi_status_t run(const tdi::Target &dev_tgt,
+                   const std::vector<uint64_t> &pipes,
+                   const pipeOp &op) const;
+
+  /**
+   * @brief Run a batch like run(). The status of an entry is the status
+   * of the entry in the first pipe where it failed
+   *
+   * @param[in] dev_tgt Device target of the write
+   * @param[in] pipes Pipes of the device
+   * @param[in] batch_size Number of entries of the batch
+   * @param[in] op Programming of the batch in one pipe, called
+   * concurrently
+   * @param[out] status_vec Per entry status. Can be nullptr if the caller
+   * is not interested
+   *
+   * @return TDI_SUCCESS if every pipe succeeded, else the status of the
+   * first failed pipe in the order of pipes
+   */
+  tdi_status_t runBatch(const tdi::Target &dev_tgt,
+                        const std::vector<uint64_t> &pipes,
+                        const size_t &batch_size,
+                        const pipeBatchOp &op,
+                        std::vector<tdi_status_t> *status_vec) const;
+
+  /**
+   * @brief Pool used by the fan outs without a pool of their own,
+   * TdiThreadPool::defaultPoolGet()
+   */
+  static TdiThreadPool &defaultPoolGet();
+
+ private:
+  // Pipes dev_tgt is for, all of pipes or its single pipe
+  tdi_status_t pipesGet(const tdi::Target &dev_tgt,
+                        const std::vector<uint64_t> &pipes,
+                        std::vector<uint64_t> *target_pipes) const;
+  // Run op(i) for i in [0, count), returns the statuses by index
+  std::vector<tdi_status_t> fanOut(
+      const size_t &count,
+      const std::function<tdi_status_t(const size_t &i)> &op) const;
+
+  const tdi_target_e pipe_field_;
+  const uint64_t all_pipes_;
+  TdiThreadPool *pool_;
+};
+
+}  // namespace tdi
+
+#endif  // _TDI_PIPE_FAN_OUT_HPP
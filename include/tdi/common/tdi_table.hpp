@@ -20,11 +20,16 @@
 #ifndef _TDI_TABLE_HPP
 #define _TDI_TABLE_HPP
 
+#include <atomic>
 #include <cstring>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -33,6 +38,7 @@
 #include <tdi/common/tdi_json_parser/tdi_table_info.hpp>
 #include <tdi/common/tdi_notifications.hpp>
 #include <tdi/common/tdi_operations.hpp>
+#include <tdi/common/tdi_packed_key.hpp>
 #include <tdi/common/tdi_session.hpp>
 #include <tdi/common/tdi_table_data.hpp>
 #include <tdi/common/tdi_table_key.hpp>
@@ -58,7 +64,18 @@ class Table {
    */
   using keyDataPairs = std::vector<std::pair<tdi::TableKey *, TableData *>>;
 
-  virtual ~Table() = default;
+  /**
+   * @brief Vector of pair of const Key and Data. Used as input to the batched
+   * entry APIs like entryAddBatch and entryModBatch.
+   */
+  using constKeyDataPairs =
+      std::vector<std::pair<const tdi::TableKey *, const tdi::TableData *>>;
+
+  /**
+   * @brief Frees the recycled key and data objects kept for every thread
+   * which used the table
+   */
+  virtual ~Table();
 
   /// Table APIs
   ///
@@ -116,6 +133,160 @@ class Table {
                                 const tdi::Flags &flags,
                                 const tdi::TableKey &key) const;
 
+  /**
+   * @brief Add a batch of entries to the table. Every entry is attempted,
+   * a failure on one entry does not stop the remaining ones from being
+   * programmed. The default implementation calls entryAdd for each pair;
+   * targets may override it with a real bulk path. Callers wanting the
+   * target to coalesce the writes can wrap the call in
+   * Session::beginBatch / Session::endBatch.
+   *
+   * @param[in] session Session Object
+   * @param[in] dev_tgt Device target
+   * @param[in] flags Call flags
+   * @param[in] key_data_pairs Vector of (Key, Data) pairs to add
+   * @param[out] status_vec Per entry status, in the same order as
+   * key_data_pairs. Can be nullptr if the caller is not interested.
+   *
+   * @return TDI_SUCCESS if all entries were added, else the status of the
+   * first failed entry
+   */
+  virtual tdi_status_t entryAddBatch(
+      const tdi::Session &session,
+      const tdi::Target &dev_tgt,
+      const tdi::Flags &flags,
+      const constKeyDataPairs &key_data_pairs,
+      std::vector<tdi_status_t> *status_vec) const;
+
+  /**
+   * @brief Modify a batch of existing entries of the table. Semantics are
+   * the same as entryAddBatch.
+   *
+   * @param[in] session Session Object
+   * @param[in] dev_tgt Device target
+   * @param[in] flags Call flags
+   * @param[in] key_data_pairs Vector of (Key, Data) pairs to modify
+   * @param[out] status_vec Per entry status, in the same order as
+   * key_data_pairs. Can be nullptr if the caller is not interested.
+   *
+   * @return TDI_SUCCESS if all entries were modified, else the status of the
+   * first failed entry
+   */
+  virtual tdi_status_t entryModBatch(
+      const tdi::Session &session,
+      const tdi::Target &dev_tgt,
+      const tdi::Flags &flags,
+      const constKeyDataPairs &key_data_pairs,
+      std::vector<tdi_status_t> *status_vec) const;
+
+  /**
+   * @brief Delete a batch of entries of the table. Semantics are the same as
+   * entryAddBatch.
+   *
+   * @param[in] session Session Object
+   * @param[in] dev_tgt Device target
+   * @param[in] flags Call flags
+   * @param[in] keys Vector of Keys to delete
+   * @param[out] status_vec Per entry status, in the same order as keys.
+   * Can be nullptr if the caller is not interested.
+   *
+   * @return TDI_SUCCESS if all entries were deleted, else the status of the
+   * first failed entry
+   */
+  virtual tdi_status_t entryDelBatch(
+      const tdi::Session &session,
+      const tdi::Target &dev_tgt,
+      const tdi::Flags &flags,
+      const std::vector<const tdi::TableKey *> &keys,
+      std::vector<tdi_status_t> *status_vec) const;
+
+  /**
+   * @brief Callback with the final status of an asynchronous table
+   * operation
+   */
+  using completionCb = std::function<void(const tdi_status_t &status)>;
+
+  /**
+   * @brief Make a completion callback which sets a future
+   *
+   * @param[out] completion Future ready with the status of the operation
+   * once it completes
+   *
+   * @return Callback to pass to the async APIs
+   */
+  static completionCb completionFutureMake(
+      std::future<tdi_status_t> *completion);
+
+  /**
+   * @brief Add an entry to the table without waiting for the device.
+   * The async APIs let one thread keep many operations in flight. Targets
+   * with an asynchronous path queue the operation and invoke the callback,
+   * from any thread, once the device completes it. Every callback of a
+   * session has been invoked when Session::completeOperations() returns.
+   * The default implementation runs entryAdd and invokes the callback
+   * before returning.<br>
+   * Key and data must stay valid until the callback is invoked.
+   *
+   * @param[in] session Session Object
+   * @param[in] dev_tgt Device target
+   * @param[in] flags Call flags
+   * @param[in] key Entry Key
+   * @param[in] data Entry Data
+   * @param[in] completion_cb Invoked once with the status of the add
+   *
+   * @return Status of the submission. The callback is only invoked on
+   * TDI_SUCCESS
+   */
+  virtual tdi_status_t entryAddAsync(const tdi::Session &session,
+                                     const tdi::Target &dev_tgt,
+                                     const tdi::Flags &flags,
+                                     const tdi::TableKey &key,
+                                     const tdi::TableData &data,
+                                     const completionCb &completion_cb) const;
+
+  /**
+   * @brief Modify an existing entry without waiting for the device.
+   * Semantics are the same as entryAddAsync.
+   */
+  virtual tdi_status_t entryModAsync(const tdi::Session &session,
+                                     const tdi::Target &dev_tgt,
+                                     const tdi::Flags &flags,
+                                     const tdi::TableKey &key,
+                                     const tdi::TableData &data,
+                                     const completionCb &completion_cb) const;
+
+  /**
+   * @brief Delete an entry without waiting for the device. Semantics are
+   * the same as entryAddAsync.
+   */
+  virtual tdi_status_t entryDelAsync(const tdi::Session &session,
+                                     const tdi::Target &dev_tgt,
+                                     const tdi::Flags &flags,
+                                     const tdi::TableKey &key,
+                                     const completionCb &completion_cb) const;
+
+  /**
+   * @brief Get an entry without waiting for the device. Semantics are the
+   * same as entryAddAsync. The data is filled in before the callback is
+   * invoked.
+   *
+   * @param[in] session Session Object
+   * @param[in] dev_tgt Device target
+   * @param[in] flags Call flags
+   * @param[in] key Entry Key
+   * @param[inout] data Entry Data, if not empty will be used to filter
+   *                    returned fields
+   * @param[in] completion_cb Invoked once with the status of the get
+   *
+   * @return Status of the submission
+   */
+  virtual tdi_status_t entryGetAsync(const tdi::Session &session,
+                                     const tdi::Target &dev_tgt,
+                                     const tdi::Flags &flags,
+                                     const tdi::TableKey &key,
+                                     tdi::TableData *data,
+                                     const completionCb &completion_cb) const;
+
   /**
    * @brief Clear a table. Delete all entries. This API also resets default
    * entry if present and is not const default. If table has always present
@@ -333,6 +504,43 @@ class Table {
                                      keyDataPairs *key_data_pairs,
                                      uint32_t *num_returned) const;
 
+  /**
+   * @brief Fwd declaration of the chunked entry iterator. See
+   * \ref tdi::Table::EntryIterator
+   */
+  class EntryIterator;
+
+  /**
+   * @brief Create an iterator which walks over all the entries of the table
+   * in chunks of chunk_size, using entryGetFirst and entryGetNextN. The
+   * key and data objects are allocated once when the iterator is created
+   * and are reused for every chunk.
+   *
+   * @details If prefetch is set, the next chunk is read on
+   * TdiThreadPool::defaultPoolGet() while the caller handles the current
+   * one. If no worker has picked up the read by the time the caller asks
+   * for the chunk, the caller reads it itself. Only use prefetch if the
+   * target allows the session to be used from another thread.
+   * The session, target and flags objects must outlive the iterator.
+   *
+   * @param[in] session Session Object
+   * @param[in] dev_tgt Device target
+   * @param[in] flags Call flags
+   * @param[in] chunk_size Max number of entries returned per chunk. Must be
+   * greater than zero
+   * @param[in] prefetch Read the next chunk ahead of time
+   * @param[out] iter_ret Newly created iterator
+   *
+   * @return Status of the API call
+   */
+  virtual tdi_status_t entryScan(
+      const tdi::Session &session,
+      const tdi::Target &dev_tgt,
+      const tdi::Flags &flags,
+      const uint32_t &chunk_size,
+      const bool &prefetch,
+      std::unique_ptr<EntryIterator> *iter_ret) const;
+
   /**
    * @brief Current Usage of the table
    *
@@ -388,6 +596,47 @@ class Table {
    */
   virtual tdi_status_t keyReset(tdi::TableKey *key) const;
 
+  /**
+   * @brief Allocate n keys for the table. Keys previously given back with
+   * keyRelease from the calling thread are reused first, and only the
+   * remaining ones are allocated using keyAllocate.
+   *
+   * @param[in] n Number of keys needed
+   * @param[out] keys_ret Vector the allocated keys are appended to
+   *
+   * @return Status of the API call
+   */
+  virtual tdi_status_t keyAllocateN(
+      const uint32_t &n,
+      std::vector<std::unique_ptr<tdi::TableKey>> *keys_ret) const;
+
+  /**
+   * @brief Give keys back to the per-thread free list of the table so that
+   * later keyAllocateN calls can reuse them. Keys are reset using keyReset
+   * before being stored. Keys which cannot be reset, or which exceed the
+   * free list capacity, are freed. The free list is freed when the thread
+   * exits.
+   *
+   * @param[inout] keys Keys previously allocated on this table. The vector
+   * is emptied.
+   *
+   * @return Status of the API call. Error is returned if a key object is not
+   * associated with the table.
+   */
+  virtual tdi_status_t keyRelease(
+      std::vector<std::unique_ptr<tdi::TableKey>> *keys) const;
+
+  /**
+   * @brief Get the packed key layout of the table. It is computed on first
+   * use and shared by all the \ref tdi::PackedKey objects of the table
+   *
+   * @param[out] layout Packed key layout, owned by the table
+   *
+   * @return Status of the API call. TDI_NOT_SUPPORTED if a key field is of
+   * variable size or of an arch specific match type.
+   */
+  tdi_status_t packedKeyLayoutGet(const tdi::PackedKeyLayout **layout) const;
+
   //// Data APIs
   /**
    * @name Data APIs
@@ -537,6 +786,51 @@ class Table {
                                  const tdi_id_t &action_id,
                                  tdi::TableData *data) const;
 
+  /**
+   * @brief Allocate n data objects for the table. Objects previously given
+   * back with dataRelease from the calling thread are reused first, and
+   * only the remaining ones are allocated using dataAllocate.
+   *
+   * @param[in] n Number of data objects needed
+   * @param[out] data_ret Vector the allocated objects are appended to
+   *
+   * @return Status of the API call
+   */
+  virtual tdi_status_t dataAllocateN(
+      const uint32_t &n,
+      std::vector<std::unique_ptr<tdi::TableData>> *data_ret) const;
+
+  /**
+   * @brief Allocate n data objects for the table with the given action-id.
+   * Recycled objects are reset to the action-id using dataReset.
+   *
+   * @param[in] action_id Action ID
+   * @param[in] n Number of data objects needed
+   * @param[out] data_ret Vector the allocated objects are appended to
+   *
+   * @return Status of the API call
+   */
+  virtual tdi_status_t dataAllocateN(
+      const tdi_id_t &action_id,
+      const uint32_t &n,
+      std::vector<std::unique_ptr<tdi::TableData>> *data_ret) const;
+
+  /**
+   * @brief Give data objects back to the per-thread free list of the table
+   * so that later dataAllocateN calls can reuse them. Objects are reset
+   * using dataReset before being stored. Objects which cannot be reset, or
+   * which exceed the free list capacity, are freed. The free list is freed
+   * when the thread exits.
+   *
+   * @param[inout] data Data objects previously allocated on this table. The
+   * vector is emptied.
+   *
+   * @return Status of the API call. Error is returned if a data object is not
+   * associated with the table.
+   */
+  virtual tdi_status_t dataRelease(
+      std::vector<std::unique_ptr<tdi::TableData>> *data) const;
+
   /** @} */  // End of group Data
 
   // table attribute APIs
@@ -700,9 +994,122 @@ class Table {
   const TdiInfo *tdi_info_;
   // The TableInfo class containing all the metadata from tdi.json
   const TableInfo *table_info_;
+
+  // Free lists of recycled key and data objects of one thread
+  struct ObjectPool {
+    std::vector<std::unique_ptr<tdi::TableKey>> keys;
+    std::vector<std::unique_ptr<tdi::TableData>> data;
+    // Serializes the drain on thread exit with the one on table destruction
+    std::mutex drain_mutex;
+    // Set once drained. The other of the thread and the table then drops
+    // its reference
+    std::atomic<bool> drained{false};
+    void drain();
+  };
+  // Per thread map of the pools of all the tables the thread used
+  struct ThreadObjectPools;
+  // Returns the free lists of the calling thread for this table. Found
+  // through a thread_local map, so no lock is taken once the thread has
+  // used the table
+  ObjectPool *objectPoolGet() const;
+  static uint64_t objectPoolIdNext();
+  // Unlike the table's address, never reused by a later table
+  const uint64_t object_pool_id_{objectPoolIdNext()};
+  // Pools of all the threads which used the table, drained by ~Table
+  mutable std::mutex object_pools_mutex_;
+  mutable std::vector<std::shared_ptr<ObjectPool>> object_pools_;
+
+  mutable std::once_flag packed_key_layout_once_;
+  mutable std::unique_ptr<tdi::PackedKeyLayout> packed_key_layout_;
+  mutable tdi_status_t packed_key_layout_status_{TDI_SUCCESS};
   friend tdi::TdiInfo;
 };  // end of tdi::Table
 
+/**
+ * @brief Iterator over all the entries of a table, returned in chunks.<br>
+ * <B>Creation: </B> Can only be created using \ref tdi::Table::entryScan()
+ *
+ * @details Internally two pools of chunk_size key/data objects are kept.
+ * Chunks are read alternately in each pool so that the last key of the
+ * current chunk can be used as the starting point of the next one without
+ * a copy, and so that the next chunk can be prefetched while the caller
+ * still holds the current one.
+ */
+class Table::EntryIterator {
+ public:
+  ~EntryIterator();
+
+  /**
+   * @brief Get the next chunk of entries. The objects in the returned chunk
+   * belong to the iterator and remain valid until the next call to next()
+   * or until the iterator is destroyed.
+   *
+   * @param[out] chunk Pointer to the vector of (Key, Data) pairs read
+   * @param[out] num_returned Number of valid pairs in chunk. 0 once all the
+   * entries of the table have been returned
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t next(const constKeyDataPairs **chunk, uint32_t *num_returned);
+
+ private:
+  struct Chunk {
+    std::vector<std::unique_ptr<tdi::TableKey>> keys;
+    std::vector<std::unique_ptr<tdi::TableData>> data;
+    // Views over keys/data. pairs_tail skips the 1st element and is used
+    // to fill the rest of the very first chunk after entryGetFirst
+    keyDataPairs pairs;
+    keyDataPairs pairs_tail;
+    constKeyDataPairs const_pairs;
+    uint32_t num_valid = 0;
+    bool last = false;
+    tdi_status_t status = TDI_SUCCESS;
+  };
+
+  // A chunk read ahead on the shared pool. Whoever claims it first, the
+  // pool task or the iterator, reads the chunk
+  struct Prefetch {
+    Prefetch() : done_future(done.get_future()){};
+    std::atomic<bool> claimed{false};
+    std::promise<void> done;
+    std::future<void> done_future;
+  };
+
+  EntryIterator(const Table &table,
+                const tdi::Session &session,
+                const tdi::Target &dev_tgt,
+                const tdi::Flags &flags,
+                const uint32_t &chunk_size,
+                const bool &prefetch)
+      : table_(table),
+        session_(session),
+        dev_tgt_(dev_tgt),
+        flags_(flags),
+        chunk_size_(chunk_size),
+        prefetch_(prefetch){};
+
+  tdi_status_t poolAllocate();
+  void fetch(Chunk *chunk, const tdi::TableKey *prev_key);
+  void prefetchStart();
+  // Wait for the pending prefetch, if any. Returns false if the chunk still
+  // has to be read because there was none or the pool never started it
+  bool prefetchCollect();
+
+  const Table &table_;
+  const tdi::Session &session_;
+  const tdi::Target &dev_tgt_;
+  const tdi::Flags &flags_;
+  const uint32_t chunk_size_;
+  const bool prefetch_;
+  Chunk chunks_[2];
+  // Index of the chunk last handed out to the caller
+  size_t cur_ = 0;
+  bool started_ = false;
+  bool done_ = false;
+  std::shared_ptr<Prefetch> pending_;
+  friend class Table;
+};  // end of tdi::Table::EntryIterator
+
 }  // namespace tdi
 
 #endif  // _TDI_TABLE_HPP
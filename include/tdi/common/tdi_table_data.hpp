@@ -62,13 +62,8 @@ class TableData {
             tdi_id_t container_id,
             std::vector<tdi_id_t> active_fields)
       : table_(table), action_id_(action_id), container_id_(container_id) {
-    if (!active_fields.size()) {
-      all_fields_set_ = true;
-    } else {
-      std::copy(active_fields.begin(),
-                active_fields.end(),
-                std::inserter(active_fields_s_, active_fields_s_.end()));
-    }
+    fieldBitmapInit();
+    activeFieldsSet(active_fields);
   };
 
   /**
@@ -497,13 +492,27 @@ class TableData {
 
   /**
    * @brief Returns a const ref to set of active fields. If empty
-   * then all fields are deemed to be active.
+   * then all fields are deemed to be active. Kept for compatibility, the
+   * overload below should be preferred. The set is rebuilt on the first
+   * call after the active fields changed, so this is not thread safe even
+   * on a const TableData. The reference is valid until the active fields
+   * next change.
    *
    * @return set of active fields
    */
-  const std::set<tdi_id_t> &activeFieldsGet() const {
-    return active_fields_s_;
-  };
+  const std::set<tdi_id_t> &activeFieldsGet() const;
+
+  /**
+   * @brief Get the active fields without allocating once active_fields
+   * has the capacity. If empty then all fields are deemed to be active.
+   * Only reads the TableData, so it is safe to call concurrently
+   *
+   * @param[out] active_fields Cleared, then filled with the active field
+   * IDs, in no particular order
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t activeFieldsGet(std::vector<tdi_id_t> *active_fields) const;
 
   /**
    * @brief Reset action ID. Caution: Only meant to be used by Target driver
@@ -537,11 +546,28 @@ class TableData {
  private:
   tdi_id_t action_id_{0};
   tdi_id_t container_id_{0};
+  // Get the bit of a field in the bitmaps. Returns false if the field
+  // has no index in the table, see TableInfo::dataFieldIndexGet
+  bool fieldBitGet(const tdi_id_t &field_id, uint32_t *bit) const;
+  void fieldBitmapInit();
+  // Call fn with the ID of every active field
+  template <typename F>
+  void activeFieldsForEach(F fn) const;
+
   bool all_fields_set_{false};
-  // set for faster lookup
-  std::set<tdi_id_t> active_fields_s_{};
-  // set of removed oneofs
-  std::set<tdi_id_t> removed_one_ofs_{};
+  // Bitmaps of the active fields and of the removed oneofs, indexed by
+  // the data field index of the table
+  std::vector<uint64_t> active_fields_bmp_{};
+  std::vector<uint64_t> removed_one_ofs_bmp_{};
+  // Number of bits set in active_fields_bmp_ and active_fields_extra_
+  uint32_t num_active_fields_{0};
+  // Fields which have no index in the table, like container
+  // fields. Expected to be empty or very small
+  std::vector<tdi_id_t> active_fields_extra_{};
+  std::vector<tdi_id_t> removed_one_ofs_extra_{};
+  // Returned by activeFieldsGet, rebuilt when stale
+  mutable std::set<tdi_id_t> active_fields_cache_{};
+  mutable bool active_fields_cache_valid_{false};
 };
 
 }  // namespace tdi
@@ -214,10 +214,82 @@ class TableKey {
    */
   virtual tdi_status_t reset();
 
+  /**
+   * @brief Get the size in bytes of the serialized form of keys of the
+   * table, see serialize()
+   *
+   * @param[out] size Size in bytes
+   *
+   * @return Status of the API call
+   */
+  tdi_status_t serializedSizeGet(size_t *size) const;
+
+  /**
+   * @brief Serialize the key in a canonical packed byte layout. Key fields
+   * are laid out in increasing order of field ID, each field taking
+   * (width + 7) / 8 bytes as read back through getValue:
+   * - Exact : value
+   * - Ternary : value, mask
+   * - LPM : value, 2 byte big endian prefix length
+   * - Range : low, high
+   *
+   * Values are canonical: bits above the field width are cleared, ternary
+   * values are masked by their mask and LPM values by their prefix. Two
+   * keys of the same table match the same entries if and only if their
+   * serialized forms are equal. Only core match types are supported.
+   *
+   * @param[out] buf Buffer to serialize into
+   * @param[in] buf_size Size of buf. Must be at least serializedSizeGet()
+   *
+   * @return Status of the API call
+   */
+  virtual tdi_status_t serialize(uint8_t *buf, const size_t &buf_size) const;
+
+  /**
+   * @brief Hash of the key computed over its serialized form
+   *
+   * @param[out] hash Hash value
+   *
+   * @return Status of the API call
+   */
+  virtual tdi_status_t hash(uint64_t *hash) const;
+
+  /**
+   * @brief Compare two keys. Keys of different tables are never equal
+   *
+   * @param[in] other Key to compare with
+   * @param[out] is_equal true if both keys hold the same field values
+   *
+   * @return Status of the API call
+   */
+  virtual tdi_status_t equals(const TableKey &other, bool *is_equal) const;
+
  protected:
   const Table *table_ = nullptr;
 };
 
+/**
+ * @brief Hash and equality functors over TableKey pointers, so that keys
+ * can be stored in unordered containers. Keys that cannot be serialized all
+ * hash to 0 and are only equal to themselves.
+ */
+struct TableKeyHash {
+  size_t operator()(const TableKey *key) const {
+    uint64_t hash = 0;
+    if (key->hash(&hash) != TDI_SUCCESS) return 0;
+    return static_cast<size_t>(hash);
+  };
+};
+
+struct TableKeyEqual {
+  bool operator()(const TableKey *lhs, const TableKey *rhs) const {
+    if (lhs == rhs) return true;
+    bool is_equal = false;
+    if (lhs->equals(*rhs, &is_equal) != TDI_SUCCESS) return false;
+    return is_equal;
+  };
+};
+
 }  // namespace tdi
 
 #endif  // _TDI_TABLE_KEY_HPP
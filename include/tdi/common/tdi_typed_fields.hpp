@@ -0,0 +1,235 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file tdi_typed_fields.hpp
+ *
+ *  @brief Contains the field types and helpers used by the typed table
+ *  headers generated from a tdi.json by tdi_codegen.py. See the
+ *  tdi_generate_headers() function in cmake/TdiCodegen.cmake
+ */
+#ifndef _TDI_TYPED_FIELDS_HPP
+#define _TDI_TYPED_FIELDS_HPP
+
+#include <array>
+#include <cstdint>
+
+#include <tdi/common/tdi_defs.h>
+#include <tdi/common/tdi_info.hpp>
+#include <tdi/common/tdi_table.hpp>
+#include <tdi/common/tdi_table_data.hpp>
+#include <tdi/common/tdi_table_key.hpp>
+#include <tdi/common/tdi_utils.hpp>
+
+namespace tdi {
+namespace typed {
+
+/**
+ * @brief Value of a field of Width bits, held as a network order byte array
+ * of exactly (Width + 7) / 8 bytes. Since the size is fixed by the type, a
+ * value built from a Bits of the field width always has the size the field
+ * expects.
+ */
+template <size_t Width>
+class Bits {
+ public:
+  static_assert(Width > 0, "Field width must be non zero");
+  static constexpr size_t kWidth = Width;
+  static constexpr size_t kSize = (Width + 7) / 8;
+
+  Bits() : bytes_(){};
+  /**
+   * @brief Build from an integer. Bits of value above Width are dropped
+   */
+  Bits(const uint64_t &value) : bytes_() {
+    for (size_t i = 0; i < kSize && i < sizeof(value); i++) {
+      bytes_[kSize - 1 - i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    if (Width % 8) bytes_[0] &= static_cast<uint8_t>((1 << (Width % 8)) - 1);
+  };
+  Bits(const std::array<uint8_t, kSize> &bytes) : bytes_(bytes){};
+
+  const uint8_t *data() const { return bytes_.data(); };
+  uint8_t *data() { return bytes_.data(); };
+  size_t size() const { return kSize; };
+
+ private:
+  std::array<uint8_t, kSize> bytes_;
+};
+
+template <size_t Width>
+struct Ternary {
+  Bits<Width> value;
+  Bits<Width> mask;
+};
+
+template <size_t Width>
+struct Lpm {
+  Bits<Width> value;
+  uint16_t prefix_len;
+};
+
+template <size_t Width>
+struct Range {
+  Bits<Width> low;
+  Bits<Width> high;
+};
+
+// Key field setters. Field IDs come from the generated headers
+template <size_t Width>
+tdi_status_t keyFieldSet(TableKey *key,
+                         const tdi_id_t &field_id,
+                         const Bits<Width> &value) {
+  return key->setValue(field_id,
+                       KeyFieldValueExact<const uint8_t *>(value.data(),
+                                                           value.size()));
+}
+
+inline tdi_status_t keyFieldSet(TableKey *key,
+                                const tdi_id_t &field_id,
+                                const uint64_t &value) {
+  return key->setValue(field_id, KeyFieldValueExact<const uint64_t>(value));
+}
+
+template <size_t Width>
+tdi_status_t keyFieldSet(TableKey *key,
+                         const tdi_id_t &field_id,
+                         const Ternary<Width> &value) {
+  return key->setValue(
+      field_id,
+      KeyFieldValueTernary<const uint8_t *>(
+          value.value.data(), value.mask.data(), value.value.size()));
+}
+
+template <size_t Width>
+tdi_status_t keyFieldSet(TableKey *key,
+                         const tdi_id_t &field_id,
+                         const Lpm<Width> &value) {
+  if (value.prefix_len > Width) {
+    LOG_ERROR("%s:%d Prefix length %d of field %d exceeds width %zu",
+              __func__,
+              __LINE__,
+              value.prefix_len,
+              field_id,
+              Width);
+    return TDI_INVALID_ARG;
+  }
+  return key->setValue(
+      field_id,
+      KeyFieldValueLPM<const uint8_t *>(
+          value.value.data(), value.prefix_len, value.value.size()));
+}
+
+template <size_t Width>
+tdi_status_t keyFieldSet(TableKey *key,
+                         const tdi_id_t &field_id,
+                         const Range<Width> &value) {
+  return key->setValue(
+      field_id,
+      KeyFieldValueRange<const uint8_t *>(
+          value.low.data(), value.high.data(), value.low.size()));
+}
+
+// Data field setters
+template <size_t Width>
+tdi_status_t dataFieldSet(TableData *data,
+                          const tdi_id_t &field_id,
+                          const Bits<Width> &value) {
+  return data->setValue(field_id, value.data(), value.size());
+}
+
+inline tdi_status_t dataFieldSet(TableData *data,
+                                 const tdi_id_t &field_id,
+                                 const uint64_t &value) {
+  return data->setValue(field_id, value);
+}
+
+inline tdi_status_t dataFieldSet(TableData *data,
+                                 const tdi_id_t &field_id,
+                                 const bool &value) {
+  return data->setValue(field_id, value);
+}
+
+// Schema checks used by the generated verify() functions. They catch a
+// header generated from a different tdi.json than the one loaded
+inline tdi_status_t tableVerify(const TdiInfo &tdi_info,
+                                const char *name,
+                                const tdi_id_t &table_id,
+                                const TableInfo **table_info) {
+  const Table *table = nullptr;
+  auto status = tdi_info.tableFromNameGet(name, &table);
+  if (status != TDI_SUCCESS || !table ||
+      table->tableInfoGet()->idGet() != table_id) {
+    LOG_ERROR("%s:%d Table %s with ID %d not found in the loaded schema",
+              __func__,
+              __LINE__,
+              name,
+              table_id);
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  *table_info = table->tableInfoGet();
+  return TDI_SUCCESS;
+}
+
+inline tdi_status_t keyFieldVerify(const TableInfo &table_info,
+                                   const tdi_id_t &field_id,
+                                   const size_t &width) {
+  auto field_info = table_info.keyFieldGet(field_id);
+  if (!field_info || field_info->sizeGet() != width) {
+    LOG_ERROR("%s:%d %s : Key field %d of width %zu not found",
+              __func__,
+              __LINE__,
+              table_info.nameGet().c_str(),
+              field_id,
+              width);
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  return TDI_SUCCESS;
+}
+
+inline tdi_status_t actionVerify(const TableInfo &table_info,
+                                 const tdi_id_t &action_id) {
+  if (!table_info.actionGet(action_id)) {
+    LOG_ERROR("%s:%d %s : Action %d not found",
+              __func__,
+              __LINE__,
+              table_info.nameGet().c_str(),
+              action_id);
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  return TDI_SUCCESS;
+}
+
+inline tdi_status_t dataFieldVerify(const TableInfo &table_info,
+                                    const tdi_id_t &field_id,
+                                    const tdi_id_t &action_id,
+                                    const size_t &width) {
+  auto field_info = table_info.dataFieldGet(field_id, action_id);
+  if (!field_info || field_info->sizeGet() != width) {
+    LOG_ERROR("%s:%d %s : Data field %d of width %zu not found in action %d",
+              __func__,
+              __LINE__,
+              table_info.nameGet().c_str(),
+              field_id,
+              width,
+              action_id);
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  return TDI_SUCCESS;
+}
+
+}  // namespace typed
+}  // namespace tdi
+
+#endif  // _TDI_TYPED_FIELDS_HPP
@@ -16,13 +16,23 @@
 #ifndef _TDI_UTILS_HPP
 #define _TDI_UTILS_HPP
 
-#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <mutex>
 #include <future>
 #include <thread>
 #include <condition_variable>
 #include <functional>
+#include <cstdlib>
 #include <cstring>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include <target-sys/bf_sal/bf_sys_intf.h>
 #include <tdi/common/tdi_table.hpp>
@@ -45,162 +55,355 @@
 
 namespace tdi {
 
-// This is a class to initialize a generalized thread pool with a specific
-// number of worker threads given at time of creation of the thread pool.
-// The thread pool uses a thread safe queue to manage the producer-consumer
-// pipeline. This thread safe queue is just a wrapper on std::queue<T>.
-// The queue is templatized over std::function<void()> and thus holds function
-// objects. It is the job of the submitTask function to package the function F
-// and the variadic arguments that are passed to it by the user into a
-// std::function<void()> function object and enqueue it in the queue.
-// Any producer can first create the thread pool and then use the submitTask
-// function to submit tasks which will be enqueued in the queue. The worker
-// thread/threads are waiting for any tasks to appear in the queue and pick
-// them up as soon as the tasks are enqueued. During the destruction of the
-// thread pool, the "shutdown_" flag is set which indicates to the worker
-// threads that they need to stop processing the tasks in the queue and return.
-// These worker threads are then subsequently joined.
-// The implementation of this thread pool is inspired from the following.
-// https://github.com/mtrebi/thread-pool
+// Work stealing thread pool with a fixed number of worker threads.
+// Every worker owns a deque of tasks. A worker runs the tasks of its own
+// deque newest first and, once it is empty, steals the oldest task of the
+// other workers' deques. Tasks submitted by a worker thread, e.g. subtasks,
+// go to its own deque. Tasks submitted by any other thread are spread over
+// the deques round robin. Every deque has its own lock, so submitters and
+// workers don't contend on a single queue. Idle workers sleep on a
+// condition variable and are only signalled when some worker sleeps.
+// The pool can bound the number of queued tasks, in which case submitTask()
+// blocks a thread outside the pool until there is room. Worker threads are
+// never blocked, so that tasks can always submit subtasks. Worker threads
+// can be pinned to CPUs. On destruction, the pool runs every queued task,
+// including the ones they submit, before joining the worker threads.
+// Schema parsing and the dummy target's program loading create their own
+// pools. PipeFanOut writes and the chunk prefetch of Table::entryScan()
+// run on defaultPoolGet().
 class TdiThreadPool {
- private:
-  // Wrapper class over std::queue to make it thread safe
-  template <typename T>
-  class ThreadSafeQueue {
-   public:
-    ThreadSafeQueue(){};
-
-    void enqueue(T &t) {
-      std::lock_guard<std::mutex> lg(mtx_);
-      queue_.push(t);
-    }
+ public:
+  /**
+   * @brief Create the pool and start its worker threads
+   *
+   * @param[in] num_threads Number of worker threads, at least 1
+   * @param[in] queue_capacity Maximum number of queued tasks before
+   * submitTask() blocks. 0 for unbounded
+   * @param[in] cpus CPUs to pin the worker threads to, worker i to
+   * cpus[i % cpus.size()]. Empty to leave them unpinned
+   */
+  TdiThreadPool(const size_t &num_threads = 1,
+                const size_t &queue_capacity = 0,
+                const std::vector<int> &cpus = {});
+  ~TdiThreadPool();
+
+  /**
+   * @brief Number of tasks queued and not started yet
+   */
+  size_t getQueueSize() const { return pending_.load(); }
+
+  size_t threadsGet() const { return workers_.size(); }
+
+  /**
+   * @brief Pool shared by the library for its background work, e.g.
+   * PipeFanOut and entry scan prefetch, with one worker per hardware
+   * thread. Created on first use and never destroyed
+   */
+  static TdiThreadPool &defaultPoolGet();
 
-    bool dequeue(T *t) {
-      std::lock_guard<std::mutex> lg(mtx_);
-      if (queue_.empty()) {
-        return false;
-      }
-      *t = queue_.front();
-      queue_.pop();
-      return true;
-    }
+  // This function is responsible for packaging the function 'F' and the
+  // variadic arguments 'args' that are passed to it into a generic
+  // function object 'std::function<void()>' and enqueue it. The returned
+  // future holds the result, or the exception thrown by the task
+  template <typename F, typename... Args>
+  auto submitTask(F &&f, Args &&... args) -> std::future<decltype(f(args...))> {
+    // Construct a function object
+    std::function<decltype(f(args...))()> fn_obj =
+        std::bind(std::forward<F>(f), std::forward<Args>(args)...);
+    // Make a packaged task. We need a task object so that we retrieve the
+    // result once the worker thread has finished execution
+    auto task_ptr =
+        std::make_shared<std::packaged_task<decltype(f(args...))()>>(fn_obj);
+    auto future = task_ptr->get_future();
 
-    bool empty() const {
-      std::lock_guard<std::mutex> lg(mtx_);
-      return queue_.empty();
-    }
+    taskEnqueue([task_ptr]() { (*task_ptr)(); });
+    return future;
+  }
 
-    size_t size() const {
-      std::lock_guard<std::mutex> lg(mtx_);
-      return queue_.size();
-    }
+  // Delete the copy constructor and the assignment operator
+  TdiThreadPool(const TdiThreadPool &) = delete;
+  TdiThreadPool(TdiThreadPool &&) = delete;
+  TdiThreadPool &operator=(const TdiThreadPool &) = delete;
+  TdiThreadPool &operator=(TdiThreadPool &&) = delete;
 
-   private:
-    std::queue<T> queue_;
-    // Lock to protect against concurrent accesses to std::queue
-    mutable std::mutex mtx_;
-  };  // ThreadSafeQueue
-
-  // Functor which will be executed by each worker thread
-  class WorkerThread {
-   public:
-    WorkerThread(const int &id, TdiThreadPool *thread_pool)
-        : id_(id), thread_pool_(thread_pool) {}
-
-    void operator()() {
-      // continue processing tasks from the queue until the thread pool is
-      // shutdown
-      while (!thread_pool_->shutdown_) {
-        bool is_dequeued = false;
-        std::function<void()> fn;
-        {
-          std::unique_lock<std::mutex> lock(thread_pool_->mtx_);
-          if (thread_pool_->queue_.empty()) {
-            // Wait until there is work to be performed
-            thread_pool_->cond_var_.wait(lock);
-          }
-        }
-        // Get a task from the queue
-        is_dequeued = thread_pool_->queue_.dequeue(&fn);
-        if (is_dequeued) {
-          // Perform the task
-          fn();
-        }
+ private:
+  // Cache line aligned, so that the deques of different workers don't share
+  // a line. C++11 new ignores the alignment, hence the aligned allocation
+  struct alignas(64) Worker {
+    static void *operator new(std::size_t size) {
+      void *mem = nullptr;
+      if (posix_memalign(&mem, alignof(Worker), size) != 0) {
+        throw std::bad_alloc();
       }
+      return mem;
     }
+    static void operator delete(void *mem) { free(mem); }
 
-   private:
-    const int id_{0};
-    TdiThreadPool *thread_pool_{nullptr};
-  };  // WorkerThread
+    std::mutex mtx_;
+    std::deque<std::function<void()>> tasks_;
+    std::thread thread_;
+  };
 
-  std::vector<std::thread> threads_;  // Vector to keep track of threads
-  bool shutdown_{false};              // Flag to shutdown the pool
-  ThreadSafeQueue<std::function<void()>> queue_;
+  void taskEnqueue(std::function<void()> &&fn);
+  bool taskDequeue(const size_t &worker_id, std::function<void()> *fn);
+  void workerRun(const size_t &worker_id);
 
-  // We use condition variable so that the worker threads can be signalled
-  // whenever there are tasks to be performed in the queue and thus they
-  // don't need to spin on the queue waiting for tasks to show up
+  // Pool and worker of the current thread, if it is a worker thread
+  static const TdiThreadPool *&currentPoolGet() {
+    static thread_local const TdiThreadPool *current_pool = nullptr;
+    return current_pool;
+  }
+  static size_t &currentWorkerGet() {
+    static thread_local size_t current_worker = 0;
+    return current_worker;
+  }
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  const size_t queue_capacity_;
+  // Round robin position for tasks submitted outside the pool
+  std::atomic<size_t> next_worker_{0};
+  // Tasks queued and not dequeued yet. Incremented before the task is
+  // pushed, so a worker may briefly see a task it can't find yet
+  std::atomic<size_t> pending_{0};
+  // Threads waiting in cond_var_ and space_cond_var_. Paired with pending_
+  // so that wakeups are only signalled to sleeping threads, without losing
+  // any
+  std::atomic<size_t> sleeping_workers_{0};
+  std::atomic<size_t> waiting_submitters_{0};
+  bool shutdown_{false};  // Guarded by mtx_
   std::mutex mtx_;
   std::condition_variable cond_var_;
+  std::condition_variable space_cond_var_;
+};  // TdiThreadPool
 
- public:
-  TdiThreadPool(const size_t &num_threads = 1)
-      : threads_(std::vector<std::thread>(num_threads)) {
-    for (size_t i = 0; i < threads_.size(); i++) {
-      threads_[i] = std::thread(WorkerThread(i, this));
+inline TdiThreadPool::TdiThreadPool(const size_t &num_threads,
+                                    const size_t &queue_capacity,
+                                    const std::vector<int> &cpus)
+    : queue_capacity_(queue_capacity) {
+  size_t threads = std::max(num_threads, static_cast<size_t>(1));
+  for (size_t i = 0; i < threads; i++) {
+    workers_.emplace_back(new Worker());
+  }
+  // Workers only start once every deque exists
+  for (size_t i = 0; i < threads; i++) {
+    auto &thread = workers_[i]->thread_;
+    thread = std::thread(&TdiThreadPool::workerRun, this, i);
+    if (cpus.empty()) continue;
+    int cpu = cpus[i % cpus.size()];
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    int rc = pthread_setaffinity_np(
+        thread.native_handle(), sizeof(cpu_set), &cpu_set);
+    if (rc != 0) {
+      LOG_WARN("%s:%d Unable to pin worker %zu to CPU %d, error %d",
+               __func__,
+               __LINE__,
+               i,
+               cpu,
+               rc);
     }
+#else
+    LOG_WARN("%s:%d CPU affinity is not supported, worker %zu not pinned "
+             "to CPU %d",
+             __func__,
+             __LINE__,
+             i,
+             cpu);
+#endif
   }
-  ~TdiThreadPool() {
-    // Stop processing any more tasks
+}
+
+inline TdiThreadPool &TdiThreadPool::defaultPoolGet() {
+  // Never destroyed, tasks may run until exit
+  static TdiThreadPool *pool = new TdiThreadPool(
+      std::max(std::thread::hardware_concurrency(), 1u));
+  return *pool;
+}
+
+inline TdiThreadPool::~TdiThreadPool() {
+  // Stop once every queued task is done
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
     shutdown_ = true;
-    // Wake up all threads so that break from their respective while loops
-    // and return
-    cond_var_.notify_all();
-    for (size_t i = 0; i < threads_.size(); i++) {
-      if (threads_[i].joinable()) {
-        // Wait for the thread to finish
-        threads_[i].join();
+  }
+  cond_var_.notify_all();
+  space_cond_var_.notify_all();
+  for (auto &worker : workers_) {
+    if (worker->thread_.joinable()) {
+      // Wait for the thread to finish
+      worker->thread_.join();
+    }
+  }
+}
+
+inline void TdiThreadPool::taskEnqueue(std::function<void()> &&fn) {
+  bool in_pool = currentPoolGet() == this;
+  if (queue_capacity_ && !in_pool) {
+    // Reserve a slot, or wait for one to free up
+    size_t pending = pending_.load();
+    while (true) {
+      if (pending < queue_capacity_) {
+        if (pending_.compare_exchange_weak(pending, pending + 1)) break;
+        continue;
       }
+      std::unique_lock<std::mutex> lock(mtx_);
+      waiting_submitters_++;
+      space_cond_var_.wait(lock, [this]() {
+        return shutdown_ || pending_.load() < queue_capacity_;
+      });
+      waiting_submitters_--;
+      if (shutdown_) {
+        // Past the bound, the task is still run before the pool goes away
+        pending_++;
+        break;
+      }
+      pending = pending_.load();
     }
+  } else {
+    pending_++;
   }
 
-  size_t getQueueSize() { return queue_.size(); }
-
-  // This function is responsible for packaging the function 'F' and the
-  // variadic arguments 'args' that are passed to it into a generic
-  // function object 'std::function<void()>' and enqueue it in the queue.
-  // These packaged function objects will subsquently be processed by the
-  // worker threads
-  template <typename F, typename... Args>
-  auto submitTask(F &&f, Args &&... args) -> std::future<decltype(f(args...))> {
-    // Construct a function object
-    std::function<decltype(f(args...))()> fn_obj =
-        std::bind(std::forward<F>(f), std::forward<Args>(args)...);
-    // Make a packaged task. We need a task object so that we retrieve the
-    // result once the worker thread has finished execution
-    auto task_ptr =
-        std::make_shared<std::packaged_task<decltype(f(args...))()>>(fn_obj);
+  size_t worker_id = in_pool ? currentWorkerGet()
+                             : next_worker_.fetch_add(
+                                   1, std::memory_order_relaxed) %
+                                   workers_.size();
+  auto &worker = *workers_[worker_id];
+  {
+    std::lock_guard<std::mutex> lock(worker.mtx_);
+    worker.tasks_.push_back(std::move(fn));
+  }
+  // A worker about to sleep checks pending_ after announcing itself, so
+  // either it sees the task or it is signalled here
+  if (sleeping_workers_.load() != 0) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    cond_var_.notify_one();
+  }
+}
+
+inline bool TdiThreadPool::taskDequeue(const size_t &worker_id,
+                                       std::function<void()> *fn) {
+  // Own deque first, newest task first. Then steal the oldest task of the
+  // others
+  bool found = false;
+  for (size_t i = 0; i < workers_.size() && !found; i++) {
+    auto &worker = *workers_[(worker_id + i) % workers_.size()];
+    std::lock_guard<std::mutex> lock(worker.mtx_);
+    if (worker.tasks_.empty()) continue;
+    if (i == 0) {
+      *fn = std::move(worker.tasks_.back());
+      worker.tasks_.pop_back();
+    } else {
+      *fn = std::move(worker.tasks_.front());
+      worker.tasks_.pop_front();
+    }
+    found = true;
+  }
+  if (!found) return false;
 
-    // Construct a generic void function
-    std::function<void()> fn_wrapper = [task_ptr]() { (*task_ptr)(); };
+  pending_--;
+  if (waiting_submitters_.load() != 0) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    space_cond_var_.notify_one();
+  }
+  return true;
+}
+
+inline void TdiThreadPool::workerRun(const size_t &worker_id) {
+  currentPoolGet() = this;
+  currentWorkerGet() = worker_id;
+  std::function<void()> fn;
+  // Continue processing tasks until the pool is shutdown and every queued
+  // task is done
+  while (true) {
+    if (taskDequeue(worker_id, &fn)) {
+      // Perform the task
+      fn();
+      fn = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mtx_);
+    sleeping_workers_++;
+    cond_var_.wait(lock,
+                   [this]() { return shutdown_ || pending_.load() != 0; });
+    sleeping_workers_--;
+    if (shutdown_ && pending_.load() == 0) break;
+  }
+}
+
+// Read side of data published through an atomic pointer and read without
+// locks, e.g. an immutable snapshot of a map. Readers bracket every use of
+// the data with readLock() and readUnlock(). A writer publishes new data,
+// then calls readersWait() before freeing the replaced data; it returns
+// once every reader which may have loaded the old pointer is done. Readers
+// never block. Writers must be serialized by the caller and readers must
+// not write. Readers are counted per epoch in cache line sized slots,
+// picked by thread, so that lookups from different threads don't share a
+// counter
+class ReaderEpochs {
+ public:
+  struct alignas(64) Slot {
+    std::atomic<uint32_t> readers_[2];
+  };
+
+  ReaderEpochs() : epoch_(0) {
+    for (auto &slot : slots_) {
+      slot.readers_[0] = 0;
+      slot.readers_[1] = 0;
+    }
+  };
 
-    // Enqueue the generic void function
-    queue_.enqueue(fn_wrapper);
+  // Returns the epoch to pass to readUnlock(). Only returns once the
+  // reader is counted under the current epoch
+  size_t readLock(Slot **slot) const;
+  void readUnlock(Slot *slot, const size_t &epoch) const {
+    slot->readers_[epoch].fetch_sub(1, std::memory_order_release);
+  };
+  // Wait for the readers which may still use replaced data
+  void readersWait();
 
-    // Wake up any one thread waiting
-    cond_var_.notify_one();
+  ReaderEpochs(ReaderEpochs const &) = delete;
+  ReaderEpochs &operator=(ReaderEpochs const &) = delete;
 
-    // Return the future for the packaged_task shared state
-    return task_ptr->get_future();
+ private:
+  static const size_t kSlots = 32;
+  static size_t threadSlotGet() {
+    static std::atomic<size_t> next_slot(0);
+    static thread_local size_t slot =
+        next_slot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
   }
 
-  // Delete the copy constructor and the assignment operator
-  TdiThreadPool(const TdiThreadPool &) = delete;
-  TdiThreadPool(TdiThreadPool &&) = delete;
-  TdiThreadPool &operator=(const TdiThreadPool &) = delete;
-  TdiThreadPool &operator=(TdiThreadPool &&) = delete;
-};  // TdiThreadPool
+  std::atomic<size_t> epoch_;
+  mutable Slot slots_[kSlots];
+};
+
+inline size_t ReaderEpochs::readLock(Slot **slot) const {
+  *slot = &slots_[threadSlotGet() % kSlots];
+  // Sequentially consistent, like the load of the data that follows.
+  // Either readersWait() sees this reader, or the reader sees the new data
+  while (true) {
+    size_t epoch = epoch_.load() & 1;
+    (*slot)->readers_[epoch].fetch_add(1);
+    // A writer flipping the epoch between the load and the increment
+    // doesn't wait for this counter, nor does the next writer, which waits
+    // for the other one. Count again under the new epoch then
+    if ((epoch_.load() & 1) == epoch) return epoch;
+    (*slot)->readers_[epoch].fetch_sub(1, std::memory_order_release);
+  }
+}
+
+inline void ReaderEpochs::readersWait() {
+  // Readers starting from now on use the other counter and the new data,
+  // so the old counter only drains
+  size_t epoch = epoch_.fetch_add(1) & 1;
+  for (auto &slot : slots_) {
+    while (slot.readers_[epoch].load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+}
 
 class TdiEndiannessHandler {
  public:
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include <stdio.h>
+#include <string.h>
 #include <tdi/common/c_frontend/tdi_init.h>
 #include <tdi/common/c_frontend/tdi_info.h>
 
@@ -83,8 +84,9 @@ tdi_status_t tdi_table_from_name_get(const tdi_info_hdl *tdi,
     return TDI_INVALID_ARG;
   }
   auto tdiInfo = reinterpret_cast<const tdi::TdiInfo *>(tdi);
-  const tdi::Table *table;
-  auto status = tdiInfo->tableFromNameGet(table_name, &table);
+  const tdi::Table *table = nullptr;
+  auto status =
+      tdiInfo->tableFromNameGet(table_name, strlen(table_name), &table);
   *table_hdl_ret = reinterpret_cast<const tdi_table_hdl *>(table);
   return status;
 }
@@ -119,8 +121,9 @@ tdi_status_t tdi_table_name_to_id(const tdi_info_hdl *tdi,
     return TDI_INVALID_ARG;
   }
   auto tdiInfo = reinterpret_cast<const tdi::TdiInfo *>(tdi);
-  const tdi::Table *table;
-  auto status = tdiInfo->tableFromNameGet(table_name, &table);
+  const tdi::Table *table = nullptr;
+  auto status =
+      tdiInfo->tableFromNameGet(table_name, strlen(table_name), &table);
   if (table == nullptr) {
     LOG_ERROR("%s:%d Table %s not found", __func__, __LINE__, table_name);
     return status;
@@ -46,7 +46,7 @@ tdi_status_t tdi_learn_callback_register(const tdi_learn_hdl *learn_hdl,
 
   //return learn->tdiLearnCallbackRegisterHelper(
   return learn->tdiLearnCallbackRegister(
-      session_ptr, dev_tgt, callback_fn, cookie);
+      std::move(session_ptr), dev_tgt, callback_fn, cookie);
 }
 
 tdi_status_t tdi_learn_callback_deregister(const tdi_learn_hdl *learn_hdl,
@@ -58,7 +58,7 @@ tdi_status_t tdi_learn_callback_deregister(const tdi_learn_hdl *learn_hdl,
   auto session_ptr = c_state.getSharedPtr(
       reinterpret_cast<const tdi::Session *>(session));
 
-  return learn->tdiLearnCallbackDeregister(session_ptr, dev_tgt);
+  return learn->tdiLearnCallbackDeregister(std::move(session_ptr), dev_tgt);
 }
 
 tdi_status_t tdi_learn_notify_ack(const tdi_learn_hdl *learn_hdl,
@@ -69,7 +69,8 @@ tdi_status_t tdi_learn_notify_ack(const tdi_learn_hdl *learn_hdl,
   auto &c_state = tdi::tdi_c::TdiCFrontEndSessionState::getInstance();
   auto session_ptr = c_state.getSharedPtr(
       reinterpret_cast<const tdi::Session *>(session));
-  return learn->tdiLearnNotifyAck(session_ptr, learn_msg_hdl);
+  // Moved, the session is referenced once per ACK
+  return learn->tdiLearnNotifyAck(std::move(session_ptr), learn_msg_hdl);
 }
 
 #ifdef _TDI_FROM_BFRT
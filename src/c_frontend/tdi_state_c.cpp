@@ -24,6 +24,9 @@ extern "C" {
 }
 #endif
 
+#include <algorithm>
+#include <functional>
+
 #include <tdi/common/tdi_session.hpp>
 #include "tdi_state_c.hpp"
 
@@ -35,33 +38,74 @@ TdiCFrontEndSessionState &TdiCFrontEndSessionState::getInstance() {
   return instance;
 }
 
+namespace {
+bool sessionLess(
+    const std::pair<const Session *, std::shared_ptr<Session>> &entry,
+    const Session *session) {
+  return std::less<const Session *>()(entry.first, session);
+}
+}  // anonymous namespace
+
 std::shared_ptr<Session> TdiCFrontEndSessionState::getSharedPtr(
-    const Session *session_raw) {
+    const Session *session_raw) const {
   if (session_raw == nullptr) {
     return nullptr;
   }
-  std::lock_guard<std::mutex> lock(state_lock);
-  if (sessionStateMap.find(session_raw) != sessionStateMap.end()) {
-    return sessionStateMap.at(session_raw);
+  ReaderEpochs::Slot *slot = nullptr;
+  auto epoch = readers_.readLock(&slot);
+  std::shared_ptr<Session> session;
+  auto snapshot = snapshot_.load();
+  if (snapshot) {
+    auto it = std::lower_bound(
+        snapshot->begin(), snapshot->end(), session_raw, sessionLess);
+    if (it != snapshot->end() && it->first == session_raw) {
+      session = it->second;
+    }
   }
-  return nullptr;
+  readers_.readUnlock(slot, epoch);
+  return session;
 }
 
 void TdiCFrontEndSessionState::insertShared(
     std::shared_ptr<Session> session) {
   std::lock_guard<std::mutex> lock(state_lock);
-  if (sessionStateMap.find(session.get()) != sessionStateMap.end()) {
+  std::unique_ptr<Snapshot> snapshot(
+      owned_snapshot_ ? new Snapshot(*owned_snapshot_) : new Snapshot());
+  auto it = std::lower_bound(
+      snapshot->begin(), snapshot->end(), session.get(), sessionLess);
+  if (it != snapshot->end() && it->first == session.get()) {
     return;
   }
-  sessionStateMap[session.get()] = session;
+  snapshot->emplace(it, session.get(), std::move(session));
+  snapshotPublish(std::move(snapshot));
 }
 
 void TdiCFrontEndSessionState::removeShared(const Session *session) {
-  std::lock_guard<std::mutex> lock(state_lock);
-  if (sessionStateMap.find(session) == sessionStateMap.end()) {
-    return;
+  std::shared_ptr<Session> removed;
+  {
+    std::lock_guard<std::mutex> lock(state_lock);
+    if (!owned_snapshot_) {
+      return;
+    }
+    std::unique_ptr<Snapshot> snapshot(new Snapshot(*owned_snapshot_));
+    auto it = std::lower_bound(
+        snapshot->begin(), snapshot->end(), session, sessionLess);
+    if (it == snapshot->end() || it->first != session) {
+      return;
+    }
+    removed = std::move(it->second);
+    snapshot->erase(it);
+    snapshotPublish(std::move(snapshot));
   }
-  sessionStateMap.erase(sessionStateMap.find(session));
+  // The session may be destroyed here, outside the lock
+}
+
+void TdiCFrontEndSessionState::snapshotPublish(
+    std::unique_ptr<const Snapshot> snapshot) {
+  snapshot_.store(snapshot.get());
+  readers_.readersWait();
+  // Frees the replaced snapshot and drops its session references
+  owned_snapshot_ = std::move(snapshot);
 }
 
 }  // tdi_c
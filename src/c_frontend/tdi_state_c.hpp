@@ -16,19 +16,29 @@
 #ifndef _TDI_STATE_C_HPP
 #define _TDI_STATE_C_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <tdi/common/tdi_utils.hpp>
 
 namespace tdi {
 namespace tdi_c {
 
+// Sessions handed out through the C frontend, by raw pointer. Lookups take
+// no lock, they search an immutable snapshot of the sessions which every
+// insert and remove republishes, like DevMgr does for devices. Sessions
+// are created and destroyed rarely compared to lookups, e.g. learn ACKs
 class TdiCFrontEndSessionState {
  public:
   // To get the singleton instance. Threadsafe
   static TdiCFrontEndSessionState &getInstance();
 
   // Get the shared_ptr from the raw pointer
-  std::shared_ptr<Session> getSharedPtr(const Session *session_raw);
+  std::shared_ptr<Session> getSharedPtr(const Session *session_raw) const;
 
   // Insert shared_ptr in the state
   void insertShared(std::shared_ptr<Session> session);
@@ -38,9 +48,23 @@ class TdiCFrontEndSessionState {
   void operator=(TdiCFrontEndSessionState const &) = delete;
 
  private:
-  TdiCFrontEndSessionState() {}
+  TdiCFrontEndSessionState() : snapshot_(nullptr) {}
+
+  // Sessions sorted by raw pointer. A snapshot holds a reference to them
+  using Snapshot =
+      std::vector<std::pair<const Session *, std::shared_ptr<Session>>>;
+
+  // Publish a new snapshot and free the replaced one once no lookup uses
+  // it. Called with state_lock held
+  void snapshotPublish(std::unique_ptr<const Snapshot> snapshot);
+
+  // Serializes inserts and removes
   std::mutex state_lock;
-  std::map<const Session *, std::shared_ptr<Session> > sessionStateMap;
+  std::atomic<const Snapshot *> snapshot_;
+  // Owns the published snapshot
+  std::unique_ptr<const Snapshot> owned_snapshot_;
+  // Lookups in flight on snapshot_
+  ReaderEpochs readers_;
 };
 
 }  // tdi_c
@@ -88,6 +88,107 @@ tdi_status_t tdi_table_entry_del(const tdi_table_hdl *table_hdl,
                          *reinterpret_cast<const tdi::TableKey *>(key));
 }
 
+namespace {
+// Copy the per entry statuses back out to the C caller
+void batchStatusCopy(const std::vector<tdi_status_t> &status_vec,
+                     tdi_status_t *status_ret) {
+  if (!status_ret) return;
+  for (size_t i = 0; i < status_vec.size(); i++) {
+    status_ret[i] = status_vec[i];
+  }
+}
+}  // anonymous namespace
+
+tdi_status_t tdi_table_entry_add_batch(const tdi_table_hdl *table_hdl,
+                                       const tdi_session_hdl *session,
+                                       const tdi_target_hdl *target,
+                                       const tdi_flags_hdl *flags,
+                                       const tdi_table_key_hdl **keys,
+                                       const tdi_table_data_hdl **data,
+                                       uint32_t n,
+                                       tdi_status_t *status_ret) {
+  auto table = reinterpret_cast<const tdi::Table *>(table_hdl);
+  if (n && (keys == nullptr || data == nullptr)) {
+    LOG_ERROR("%s:%d null param passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  tdi::Table::constKeyDataPairs key_data_pairs;
+  key_data_pairs.reserve(n);
+  for (uint32_t i = 0; i < n; i++) {
+    key_data_pairs.push_back(
+        std::make_pair(reinterpret_cast<const tdi::TableKey *>(keys[i]),
+                       reinterpret_cast<const tdi::TableData *>(data[i])));
+  }
+  std::vector<tdi_status_t> status_vec;
+  auto status =
+      table->entryAddBatch(*reinterpret_cast<const tdi::Session *>(session),
+                           *reinterpret_cast<const tdi::Target *>(target),
+                           *reinterpret_cast<const tdi::Flags *>(flags),
+                           key_data_pairs,
+                           &status_vec);
+  batchStatusCopy(status_vec, status_ret);
+  return status;
+}
+
+tdi_status_t tdi_table_entry_mod_batch(const tdi_table_hdl *table_hdl,
+                                       const tdi_session_hdl *session,
+                                       const tdi_target_hdl *target,
+                                       const tdi_flags_hdl *flags,
+                                       const tdi_table_key_hdl **keys,
+                                       const tdi_table_data_hdl **data,
+                                       uint32_t n,
+                                       tdi_status_t *status_ret) {
+  auto table = reinterpret_cast<const tdi::Table *>(table_hdl);
+  if (n && (keys == nullptr || data == nullptr)) {
+    LOG_ERROR("%s:%d null param passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  tdi::Table::constKeyDataPairs key_data_pairs;
+  key_data_pairs.reserve(n);
+  for (uint32_t i = 0; i < n; i++) {
+    key_data_pairs.push_back(
+        std::make_pair(reinterpret_cast<const tdi::TableKey *>(keys[i]),
+                       reinterpret_cast<const tdi::TableData *>(data[i])));
+  }
+  std::vector<tdi_status_t> status_vec;
+  auto status =
+      table->entryModBatch(*reinterpret_cast<const tdi::Session *>(session),
+                           *reinterpret_cast<const tdi::Target *>(target),
+                           *reinterpret_cast<const tdi::Flags *>(flags),
+                           key_data_pairs,
+                           &status_vec);
+  batchStatusCopy(status_vec, status_ret);
+  return status;
+}
+
+tdi_status_t tdi_table_entry_del_batch(const tdi_table_hdl *table_hdl,
+                                       const tdi_session_hdl *session,
+                                       const tdi_target_hdl *target,
+                                       const tdi_flags_hdl *flags,
+                                       const tdi_table_key_hdl **keys,
+                                       uint32_t n,
+                                       tdi_status_t *status_ret) {
+  auto table = reinterpret_cast<const tdi::Table *>(table_hdl);
+  if (n && keys == nullptr) {
+    LOG_ERROR("%s:%d null param passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  std::vector<const tdi::TableKey *> key_vec;
+  key_vec.reserve(n);
+  for (uint32_t i = 0; i < n; i++) {
+    key_vec.push_back(reinterpret_cast<const tdi::TableKey *>(keys[i]));
+  }
+  std::vector<tdi_status_t> status_vec;
+  auto status =
+      table->entryDelBatch(*reinterpret_cast<const tdi::Session *>(session),
+                           *reinterpret_cast<const tdi::Target *>(target),
+                           *reinterpret_cast<const tdi::Flags *>(flags),
+                           key_vec,
+                           &status_vec);
+  batchStatusCopy(status_vec, status_ret);
+  return status;
+}
+
 tdi_status_t tdi_table_clear(const tdi_table_hdl *table_hdl,
                              const tdi_session_hdl *session,
                              const tdi_target_hdl *target,
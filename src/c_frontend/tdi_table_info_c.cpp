@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include <stdio.h>
+#include <string.h>
 #include <tdi/common/c_frontend/tdi_table_info.h>
 
 #include <tdi/common/tdi_defs.h>
@@ -253,7 +254,12 @@ tdi_status_t tdi_key_field_id_get(const tdi_table_info_hdl *table_info_hdl,
                                   const char *key_field_name,
                                   tdi_id_t *field_id) {
   auto tableInfo = reinterpret_cast<const tdi::TableInfo *>(table_info_hdl);
-  auto keyFieldInfo = tableInfo->keyFieldGet(key_field_name);
+  auto keyFieldInfo =
+      tableInfo->keyFieldGet(key_field_name, strlen(key_field_name));
+  if (!keyFieldInfo) {
+    *field_id = 0;
+    return TDI_OBJECT_NOT_FOUND;
+  }
   *field_id = keyFieldInfo->idGet();
   if (*field_id == 0) {
     LOG_ERROR("%s:%d Invalid arg. Please allocate mem for out param",
@@ -437,7 +443,9 @@ tdi_status_t tdi_data_field_id_get(const tdi_table_info_hdl *table_info_hdl,
                                    const char *data_field_name,
                                    tdi_id_t *field_id_ret) {
   auto tableInfo = reinterpret_cast<const tdi::TableInfo *>(table_info_hdl);
-  *field_id_ret = tableInfo->dataFieldIdGet(data_field_name);
+  auto dataFieldInfo =
+      tableInfo->dataFieldGet(data_field_name, strlen(data_field_name), 0);
+  *field_id_ret = dataFieldInfo ? dataFieldInfo->idGet() : 0;
   return TDI_SUCCESS;
 }
 
@@ -447,7 +455,9 @@ tdi_status_t tdi_data_field_id_with_action_get(
     const tdi_id_t action_id,
     tdi_id_t *field_id_ret) {
   auto tableInfo = reinterpret_cast<const tdi::TableInfo *>(table_info_hdl);
-  *field_id_ret = tableInfo->dataFieldIdGet(data_field_name, action_id);
+  auto dataFieldInfo = tableInfo->dataFieldGet(
+      data_field_name, strlen(data_field_name), action_id);
+  *field_id_ret = dataFieldInfo ? dataFieldInfo->idGet() : 0;
   return TDI_SUCCESS;
 }
 
@@ -800,7 +810,11 @@ tdi_status_t tdi_action_name_to_id(const tdi_table_info_hdl *table_info_hdl,
                                    const char *action_name,
                                    tdi_id_t *action_id_ret) {
   auto tableInfo = reinterpret_cast<const tdi::TableInfo *>(table_info_hdl);
-  auto actionInfo = tableInfo->actionGet(std::string(action_name));
+  auto actionInfo = tableInfo->actionGet(action_name, strlen(action_name));
+  if (!actionInfo) {
+    *action_id_ret = 0;
+    return TDI_OBJECT_NOT_FOUND;
+  }
   *action_id_ret = actionInfo->idGet();
   return TDI_SUCCESS;
 }
@@ -14,6 +14,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <future>
+#include <set>
+#include <string>
+#include <vector>
+
 #include <tdi/common/tdi_utils.hpp>
 
 #include "tdi_dummy_info.hpp"
@@ -30,30 +36,71 @@ Device::Device(const tdi_dev_id_t &device_id,
                void *cookie)
     : tdi::tna::Device(
           device_id, arch_type, device_config, cookie) {
-  // Parse tdi json for every program
+  // Parse tdi json for every program. Devices running the same program
+  // share its TdiInfo
+  auto load_program = [this](const tdi::ProgramConfig &program_config) {
+    std::shared_ptr<const TdiInfo> tdi_info;
+    auto sts = TdiInfoRegistry::getInstance().tdiInfoGet(
+        program_config.prog_name_,
+        program_config.tdi_info_file_paths_,
+        this->tdiInfoParserCreate(),
+        this->tableFactoryCreate(),
+        &tdi_info);
+    if (sts != TDI_SUCCESS) {
+      LOG_ERROR("%s:%d Failed to load program %s",
+                __func__,
+                __LINE__,
+                program_config.prog_name_.c_str());
+    }
+    return tdi_info;
+  };
+
+  std::vector<const tdi::ProgramConfig *> programs;
+  std::set<std::string> program_names;
   for (const auto &program_config : device_config) {
-    if (tdi_info_map_.find(program_config.prog_name_) != tdi_info_map_.end()) {
+    if (!program_names.insert(program_config.prog_name_).second) {
       LOG_ERROR("%s:%d Program for %s already exists",
                 __func__,
                 __LINE__,
                 program_config.prog_name_.c_str());
       continue;
     }
-    auto tdi_info_mapper = std::unique_ptr<tdi::TdiInfoMapper>(
-        new tdi::tna::dummy::TdiInfoMapper());
-    auto table_factory =
-        std::unique_ptr<tdi::TableFactory>(new tdi::tna::dummy::TableFactory());
+    programs.push_back(&program_config);
+  }
 
-    auto tdi_info_parser = std::unique_ptr<TdiInfoParser>(
-        new TdiInfoParser(std::move(tdi_info_mapper)));
-    tdi_info_parser->parseTdiInfo(program_config.tdi_info_file_paths_);
-    auto tdi_info = tdi::TdiInfo::makeTdiInfo(program_config.prog_name_,
-                                              std::move(tdi_info_parser),
-                                              table_factory.get());
-    tdi_info_map_[program_config.prog_name_] = std::move(tdi_info);
+  // Programs are independent, parse them concurrently in parallel mode
+  size_t num_threads =
+      std::min(TdiInfoParser::defaultParseThreadsGet(), programs.size());
+  if (num_threads > 1) {
+    TdiThreadPool pool(num_threads);
+    std::vector<std::future<std::shared_ptr<const TdiInfo>>> tasks;
+    for (const auto &program_config : programs) {
+      tasks.push_back(pool.submitTask(load_program, *program_config));
+    }
+    for (size_t i = 0; i < programs.size(); i++) {
+      auto tdi_info = tasks[i].get();
+      if (tdi_info) tdi_info_map_[programs[i]->prog_name_] = tdi_info;
+    }
+  } else {
+    for (const auto &program_config : programs) {
+      auto tdi_info = load_program(*program_config);
+      if (tdi_info) tdi_info_map_[program_config->prog_name_] = tdi_info;
+    }
   }
 }
 
+std::unique_ptr<TdiInfoParser> Device::tdiInfoParserCreate() const {
+  auto tdi_info_mapper = std::unique_ptr<tdi::TdiInfoMapper>(
+      new tdi::tna::dummy::TdiInfoMapper());
+  return std::unique_ptr<TdiInfoParser>(
+      new TdiInfoParser(std::move(tdi_info_mapper)));
+}
+
+std::unique_ptr<const tdi::TableFactory> Device::tableFactoryCreate() const {
+  return std::unique_ptr<const tdi::TableFactory>(
+      new tdi::tna::dummy::TableFactory());
+}
+
 tdi_status_t Init::tdiModuleInit(void *target_options) {
   auto &dev_mgr_obj = DevMgr::getInstance();
   LOG_DBG("%s:%d TDI Device Add called", __func__, __LINE__);
@@ -67,6 +67,12 @@ class Device : public tdi::tna::Device {
       std::unique_ptr<tdi::Flags> * /*flags*/) const override final {
     return TDI_SUCCESS;
   }
+
+ protected:
+  virtual std::unique_ptr<tdi::TdiInfoParser> tdiInfoParserCreate()
+      const override final;
+  virtual std::unique_ptr<const tdi::TableFactory> tableFactoryCreate()
+      const override final;
 };
 
 /**
@@ -19,8 +19,10 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
+#include <typeinfo>
 #include <vector>
 
 #include <tdi/common/tdi_info.hpp>
@@ -30,99 +32,160 @@ namespace tdi {
 
 namespace {
 
-std::vector<std::string> splitString(const std::string &s,
-                                     const std::string &delimiter) {
-  size_t pos = 0;
-  size_t start_pos = 0;
-  std::vector<std::string> token_list;
-  while ((pos = s.find(delimiter, start_pos)) != std::string::npos) {
-    token_list.push_back(s.substr(start_pos, pos - start_pos));
-    start_pos = pos + delimiter.length();
+// Memory accounting, see TdiInfo::memoryUsageGet. Node sizes are those of
+// libstdc++, 3 pointers and a color for tree nodes and a next pointer and a
+// cached hash for hash nodes
+const size_t kTreeNodeBytes = 4 * sizeof(void *);
+const size_t kHashNodeBytes = 2 * sizeof(void *);
+
+template <typename T>
+size_t treeBytes(const T &tree) {
+  return tree.size() * (kTreeNodeBytes + sizeof(typename T::value_type));
+}
+
+template <typename T>
+size_t nameMapBytes(const std::map<std::string, T> &name_map) {
+  size_t bytes = treeBytes(name_map);
+  for (const auto &kv : name_map) {
+    bytes += StringPool::stringHeapBytes(kv.first);
   }
-  token_list.push_back(s.substr(start_pos, pos - start_pos));
-  return token_list;
+  return bytes;
 }
 
-/*
- * @brief Generate unique names
- * Split the name using . as delimiter. Then create partially qualified
- * names.
- * tokens(pipe0.SwitchIngress.forward) = set(pipe0, SwitchIngress, forward)
- * full_name_list = [pipe0.SwitchIngress.forward, SwitchIngress.forward,
- * forward]
- */
+// NameIndex entries, plus one bucket each
+size_t nameIndexBytes(const size_t &size) {
+  return size * (kHashNodeBytes + sizeof(NameRef) + 2 * sizeof(void *));
+}
 
-std::set<std::string> generateUniqueNames(const std::string &obj_name) {
-  auto tokens = splitString(obj_name, ".");
-  std::string last_token = "";
-  std::set<std::string> full_name_list;
-  for (auto it = tokens.rbegin(); it != tokens.rend(); ++it) {
-    auto token = *it;
-    if (last_token == "") {
-      full_name_list.insert(token);
-      last_token = token;
-    } else {
-      full_name_list.insert(token + "." + last_token);
-      last_token = token + "." + last_token;
-    }
+// ShortNameIndex nodes, each with its edge plus one bucket
+template <typename T>
+size_t shortNameIndexBytes(const ShortNameIndex<T> &index) {
+  return index.nodesGet() *
+         (sizeof(T *) + sizeof(uint32_t) + kHashNodeBytes + sizeof(uint32_t) +
+          sizeof(NameRef) + 2 * sizeof(void *));
+}
+
+void dataFieldsUsageAdd(const DataFieldInfo &field, TdiInfoMemoryUsage *usage) {
+  usage->data_fields += sizeof(DataFieldInfo);
+  usage->num_data_fields++;
+  const auto &annotations = field.annotationsGet();
+  const auto &oneof_siblings = field.oneofSiblingsGet();
+  if (!annotations.empty() || !oneof_siblings.empty()) {
+    usage->num_data_fields_with_extras++;
+    usage->data_field_extras +=
+        sizeof(annotations) + sizeof(oneof_siblings) +
+        sizeof(std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>>) +
+        sizeof(std::map<std::string, tdi_id_t>) + treeBytes(annotations) +
+        treeBytes(oneof_siblings);
   }
-  return full_name_list;
 }
 
-/* @brief This function converts a nameMap to a fullNameMap. A fullNameMap is a
- *mapping of
- * all possible names of a table entity to the table object's raw pointer.
- *
- * pipe0.SI.forward = <forward_table_1>
- * SI.forward       = <forward_table_1>
- *
- * pipe0.SE.forward = <forward_table_2>
- * SE.forward       = <forward_table_2>
- *
- * pipe0.SI.fib = <fib_table>
- * SI.fib       = <fib_table>
- * fib          = <fib_table>
- */
-template <typename T>
-void populateFullNameMap(
-    const std::map<std::string, std::unique_ptr<T>> &nameMap,
-    std::map<std::string, const T *> *fullNameMap) {
-  std::set<std::string> names_to_remove;
-  // We need to trim the possible names down since all are not possible.
-  // Loop over all the tables
-  for (const auto &name_pair : nameMap) {
-    // Generate all possible names for all the tables. The below map will
-    // contain
-    // mapping of
-    // a table name to all the possible table names.
-    const auto possible_name_list = generateUniqueNames(name_pair.first);
-    // Loop over all the possible names. If they are not present in the map,
-    // then add them to the map. Else, just mark this name in a set kept to
-    // remove these later
-    for (const auto &prospective_name : possible_name_list) {
-      if ((*fullNameMap).find(prospective_name) != (*fullNameMap).end()) {
-        names_to_remove.insert(prospective_name);
-      } else {
-        (*fullNameMap)[prospective_name] = name_pair.second.get();
-      }
-    }
+void dataFieldsUsageAdd(
+    const std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> &fields,
+    TdiInfoMemoryUsage *usage) {
+  for (const auto &kv : fields) {
+    if (kv.second) dataFieldsUsageAdd(*kv.second, usage);
   }
+}
+
+void tableInfoUsageAdd(const TableInfo &table_info,
+                       TdiInfoMemoryUsage *usage) {
+  size_t &bytes = usage->table_infos;
+  bytes +=
+      sizeof(TableInfo) + StringPool::stringHeapBytes(table_info.nameGet());
+  bytes += treeBytes(table_info.tableKeyMapGet()) +
+           treeBytes(table_info.tableDataMapGet()) +
+           treeBytes(table_info.tableActionMapGet());
+  bytes += nameMapBytes(table_info.name_key_map_) +
+           nameMapBytes(table_info.name_data_map_) +
+           nameMapBytes(table_info.name_action_map_) +
+           nameMapBytes(table_info.name_notifications_map_);
+  bytes += treeBytes(table_info.dependsOnGet()) +
+           treeBytes(table_info.operationsSupported()) +
+           treeBytes(table_info.attributesSupported()) +
+           treeBytes(table_info.annotationsGet());
+  // Name indexes and arrays by ordinal
+  size_t num_fields = table_info.keyFieldCountGet() +
+                      table_info.dataFieldCountGet() +
+                      table_info.actionCountGet();
+  bytes += nameIndexBytes(num_fields) + num_fields * sizeof(void *);
+  bytes += table_info.dataFieldIndexBytesGet();
 
-  // Remove the marked names from the map as well.
-  for (const auto &name : names_to_remove) {
-    (*fullNameMap).erase(name);
+  usage->key_fields +=
+      table_info.tableKeyMapGet().size() * sizeof(KeyFieldInfo);
+  dataFieldsUsageAdd(table_info.tableDataMapGet(), usage);
+  for (const auto &kv : table_info.tableActionMapGet()) {
+    const auto &action = *kv.second;
+    usage->actions += sizeof(ActionInfo) +
+                      StringPool::stringHeapBytes(action.nameGet()) +
+                      treeBytes(action.actionDataMapGet()) +
+                      nameMapBytes(action.data_fields_names_) +
+                      nameIndexBytes(action.dataFieldCountGet()) +
+                      action.dataFieldCountGet() * sizeof(void *) +
+                      treeBytes(action.annotationsGet());
+    dataFieldsUsageAdd(action.actionDataMapGet(), usage);
   }
 }
 
+// Lookups in flight on the schema of any TdiInfo. Shared by all of them,
+// a TdiInfo is allocated with new, which doesn't align the reader slots
+// before C++17. Replaced schemas are waited for under the mutex, as
+// readersWait() only allows one writer at a time
+ReaderEpochs &schemaReadersGet() {
+  static ReaderEpochs readers;
+  return readers;
+}
+
+void schemaReadersWait() {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  schemaReadersGet().readersWait();
+}
+
+// Counts a lookup on the current schema of a TdiInfo for its scope
+class SchemaReader {
+ public:
+  SchemaReader() : epoch_(schemaReadersGet().readLock(&slot_)){};
+  ~SchemaReader() { schemaReadersGet().readUnlock(slot_, epoch_); };
+
+ private:
+  ReaderEpochs::Slot *slot_{nullptr};
+  const size_t epoch_;
+};
+
 }  // anonymous namespace
 
+TdiInfo::Schema::~Schema() {
+  for (const auto &name : tables_carried) tableMap.at(name).release();
+  for (const auto &name : learns_carried) learnMap.at(name).release();
+}
+
 std::unique_ptr<const TdiInfo> TdiInfo::makeTdiInfo(
     const std::string &p4_name,
     std::unique_ptr<TdiInfoParser> tdi_info_parser,
     const tdi::TableFactory *factory) {
   try {
     std::unique_ptr<const TdiInfo> tdi_info(
-        new TdiInfo(p4_name, std::move(tdi_info_parser), factory));
+        new TdiInfo(p4_name, std::move(tdi_info_parser), factory, nullptr));
+    return tdi_info;
+  } catch (...) {
+    LOG_ERROR("%s:%d Failed to create TdiInfo", __func__, __LINE__);
+    return nullptr;
+  }
+}
+
+std::unique_ptr<const TdiInfo> TdiInfo::makeTdiInfo(
+    const std::string &p4_name,
+    std::unique_ptr<TdiInfoParser> tdi_info_parser,
+    std::unique_ptr<const tdi::TableFactory> factory) {
+  if (!factory) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return nullptr;
+  }
+  try {
+    auto factory_ptr = factory.get();
+    std::unique_ptr<const TdiInfo> tdi_info(new TdiInfo(
+        p4_name, std::move(tdi_info_parser), factory_ptr, std::move(factory)));
     return tdi_info;
   } catch (...) {
     LOG_ERROR("%s:%d Failed to create TdiInfo", __func__, __LINE__);
@@ -132,11 +195,45 @@ std::unique_ptr<const TdiInfo> TdiInfo::makeTdiInfo(
 
 TdiInfo::TdiInfo(const std::string &p4_name,
                  std::unique_ptr<TdiInfoParser> tdi_info_parser,
-                 const tdi::TableFactory *factory)
-    : p4_name_(p4_name), tdi_info_parser_(std::move(tdi_info_parser)) {
+                 const tdi::TableFactory *factory,
+                 std::unique_ptr<const tdi::TableFactory> owned_factory)
+    : lazy_tables_(tdi_info_parser->lazyParseGet() && owned_factory),
+      table_factory_(std::move(owned_factory)),
+      p4_name_(p4_name) {
+  Schema *schema = new Schema();
+  schema_owner_.reset(schema);
+  schema->tdi_info_parser = std::move(tdi_info_parser);
+  auto &tableMap = schema->tableMap;
+  auto &tableIdMap = schema->tableIdMap;
+  auto &learnMap = schema->learnMap;
+  auto &learnIdMap = schema->learnIdMap;
+  if (lazy_tables_) {
+    // Only index the tables here, see lazyTableGet()
+    for (const auto &kv : schema->tdi_info_parser->tableIdIndexGet()) {
+      lazy_tables_list_.emplace_back(&kv.first);
+      lazy_table_index_.insert(kv.first, &lazy_tables_list_.back());
+      if (lazyTableIdMap.find(kv.second) != lazyTableIdMap.end()) {
+        LOG_WARN("%s:%d Table:%s ID %d Already exists. Not adding again",
+                  __func__,
+                  __LINE__,
+                  kv.first.c_str(),
+                  kv.second);
+        continue;
+      }
+      lazyTableIdMap[kv.second] = &lazy_tables_list_.back();
+    }
+  } else if (schema->tdi_info_parser->lazyParseGet()) {
+    // The factory can't be kept, build everything now
+    for (const auto &kv : schema->tdi_info_parser->tableIdIndexGet()) {
+      const TableInfo *table_info = nullptr;
+      schema->tdi_info_parser->tableInfoBuild(kv.first, &table_info);
+    }
+  }
+
   // Go over all table_info and learn_info in the parser object and
-  // create Table and Learn objects for them
-  for (const auto &kv : tdi_info_parser_->tableInfoMapGet()) {
+  // create Table and Learn objects for them. With lazy tables this only
+  // covers tables the parser already built, e.g. from the schema cache
+  for (const auto &kv : schema->tdi_info_parser->tableInfoMapGet()) {
     if (tableMap.find(kv.first) != tableMap.end()) {
       LOG_WARN("%s:%d Table:%s Already exists. Not adding another",
                 __func__,
@@ -163,10 +260,12 @@ TdiInfo::TdiInfo(const std::string &p4_name,
       tableMap[kv.first] = std::move(table);
     }
   }
-  populateFullNameMap<tdi::Table>(tableMap, &fullTableMap);
+  for (const auto &kv : tableMap) {
+    schema->full_table_index.insert(kv.first, kv.second.get());
+  }
 
   // Creating Learn
-  for (const auto &kv : tdi_info_parser_->learnInfoMapGet()) {
+  for (const auto &kv : schema->tdi_info_parser->learnInfoMapGet()) {
     if (learnMap.find(kv.first) != learnMap.end()) {
       LOG_ERROR("%s:%d Learn Table:%s Already exists",
                 __func__,
@@ -194,7 +293,236 @@ TdiInfo::TdiInfo(const std::string &p4_name,
       learnMap[kv.first] = std::move(learn);
     }
   }
-  populateFullNameMap<tdi::Learn>(learnMap, &fullLearnMap);
+  for (const auto &kv : learnMap) {
+    schema->full_learn_index.insert(kv.first, kv.second.get());
+  }
+  schema_.store(schema);
+}
+
+const Table *TdiInfo::lazyTableGet(const LazyTable &lazy_table) const {
+  const Table *table = lazy_table.table.load(std::memory_order_acquire);
+  if (table || lazy_table.failed.load(std::memory_order_relaxed)) {
+    return table;
+  }
+  std::lock_guard<std::mutex> lock(lazy_table_mutex_);
+  table = lazy_table.table.load(std::memory_order_relaxed);
+  if (!table && !lazy_table.failed.load(std::memory_order_relaxed)) {
+    table = lazyTableBuild(*lazy_table.name);
+    if (table) {
+      lazy_table.table.store(table, std::memory_order_release);
+    } else {
+      // Not retried, the schema and the factory don't change
+      lazy_table.failed.store(true, std::memory_order_relaxed);
+    }
+  }
+  return table;
+}
+
+const Table *TdiInfo::lazyTableBuild(const std::string &name) const {
+  // Never replaced with lazy tables
+  Schema *schema = schema_.load();
+  auto &tableMap = schema->tableMap;
+  auto it = tableMap.find(name);
+  if (it != tableMap.end()) return it->second.get();
+  const TableInfo *table_info = nullptr;
+  if (schema->tdi_info_parser->tableInfoBuild(name, &table_info) !=
+      TDI_SUCCESS) {
+    return nullptr;
+  }
+  auto table = table_factory_->makeTable(this, table_info);
+  if (!table) {
+    LOG_WARN("%s:%d Unable to create Table:%s",
+              __func__,
+              __LINE__,
+              name.c_str());
+    return nullptr;
+  }
+  const Table *table_ptr = table.get();
+  schema->tableIdMap[table_info->idGet()] = table_ptr;
+  tableMap[name] = std::move(table);
+  return table_ptr;
+}
+
+void TdiInfo::lazyTablesBuildAll() const {
+  for (const auto &kv : lazyTableIdMap) {
+    const LazyTable &lazy_table = *kv.second;
+    if (lazy_table.table.load(std::memory_order_relaxed) ||
+        lazy_table.failed.load(std::memory_order_relaxed)) {
+      continue;
+    }
+    auto table = lazyTableBuild(*lazy_table.name);
+    if (table) {
+      lazy_table.table.store(table, std::memory_order_release);
+    } else {
+      lazy_table.failed.store(true, std::memory_order_relaxed);
+    }
+  }
+}
+
+tdi_status_t TdiInfo::schemaReload(
+    std::unique_ptr<TdiInfoParser> tdi_info_parser,
+    const std::vector<std::string> &tdi_info_file_paths,
+    const tdi::TableFactory *factory,
+    TdiInfoReloadResult *result) {
+  if (!tdi_info_parser || !factory) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  if (lazy_tables_) {
+    LOG_ERROR("%s:%d %s: Schema reload not supported with lazy tables",
+              __func__,
+              __LINE__,
+              p4_name_.c_str());
+    return TDI_NOT_SUPPORTED;
+  }
+  // Only reloads change schema_
+  std::lock_guard<std::mutex> lock(lazy_table_mutex_);
+  Schema *schema = schema_.load();
+  // Unchanged TableInfo and LearnInfo objects move to the new parser, their
+  // strings must outlive the current one
+  tdi_info_parser->stringPoolShare(*schema->tdi_info_parser);
+  auto status = tdi_info_parser->parseTdiInfo(tdi_info_file_paths);
+  if (status != TDI_SUCCESS) {
+    LOG_ERROR("%s:%d %s: Failed to parse the new schema",
+              __func__,
+              __LINE__,
+              p4_name_.c_str());
+    return status;
+  }
+  if (tdi_info_parser->lazyParseGet()) {
+    for (const auto &kv : tdi_info_parser->tableIdIndexGet()) {
+      const TableInfo *table_info = nullptr;
+      tdi_info_parser->tableInfoBuild(kv.first, &table_info);
+    }
+  }
+
+  // Build the new schema off to the side, lookups keep using the current
+  // one. The Table objects of the changed and new tables are created
+  // first, nothing is touched if any of them fails
+  TdiInfoReloadResult reload_result;
+  std::unique_ptr<Schema> new_schema(new Schema());
+  const auto &old_table_infos = schema->tdi_info_parser->tableInfoMapGet();
+  std::vector<std::string> unchanged_tables;
+  for (const auto &kv : tdi_info_parser->tableInfoMapGet()) {
+    if (!kv.second) continue;
+    auto table_it = schema->tableMap.find(kv.first);
+    auto info_it = old_table_infos.find(kv.first);
+    if (table_it != schema->tableMap.end() &&
+        info_it != old_table_infos.end() && info_it->second &&
+        TdiInfoParser::tableInfoEqual(*info_it->second, *kv.second)) {
+      unchanged_tables.push_back(kv.first);
+      continue;
+    }
+    auto table = factory->makeTable(this, kv.second.get());
+    if (!table) {
+      LOG_ERROR("%s:%d %s: Unable to create Table:%s, schema not reloaded",
+                __func__,
+                __LINE__,
+                p4_name_.c_str(),
+                kv.first.c_str());
+      return TDI_UNEXPECTED;
+    }
+    if (table_it != schema->tableMap.end()) {
+      reload_result.tables_changed.push_back(kv.first);
+    } else {
+      reload_result.tables_added.push_back(kv.first);
+    }
+    new_schema->tableMap[kv.first] = std::move(table);
+  }
+  for (const auto &name : unchanged_tables) {
+    // Keep the Table along with the TableInfo it points to. The freshly
+    // parsed copy goes away with the current parser. Both schemas hold the
+    // Table until the current one is freed
+    tdi_info_parser->tableInfoSwap(schema->tdi_info_parser.get(), name);
+    new_schema->tableMap[name].reset(schema->tableMap.at(name).get());
+    schema->tables_carried.push_back(name);
+  }
+  reload_result.tables_unchanged = unchanged_tables.size();
+  for (const auto &kv : schema->tableMap) {
+    if (new_schema->tableMap.find(kv.first) == new_schema->tableMap.end()) {
+      reload_result.tables_removed.push_back(kv.first);
+    }
+  }
+
+  const auto &old_learn_infos = schema->tdi_info_parser->learnInfoMapGet();
+  for (const auto &kv : tdi_info_parser->learnInfoMapGet()) {
+    if (!kv.second) continue;
+    auto learn_it = schema->learnMap.find(kv.first);
+    auto info_it = old_learn_infos.find(kv.first);
+    if (learn_it != schema->learnMap.end() &&
+        info_it != old_learn_infos.end() && info_it->second &&
+        TdiInfoParser::learnInfoEqual(*info_it->second, *kv.second)) {
+      tdi_info_parser->learnInfoSwap(schema->tdi_info_parser.get(), kv.first);
+      new_schema->learnMap[kv.first].reset(learn_it->second.get());
+      schema->learns_carried.push_back(kv.first);
+      continue;
+    }
+    new_schema->learnMap[kv.first] =
+        std::unique_ptr<Learn>(new Learn(kv.second.get()));
+  }
+  new_schema->tdi_info_parser = std::move(tdi_info_parser);
+  nameMapsRebuild(new_schema.get());
+
+  // Publish, then wait for the lookups that may still be on the replaced
+  // schema. It is only freed by the next reload, along with the tables it
+  // alone holds, so that Table pointers obtained from it stay valid until
+  // then
+  schema_.store(new_schema.get());
+  schemaReadersWait();
+  retired_schema_ = std::move(schema_owner_);
+  schema_owner_ = std::move(new_schema);
+
+  LOG_DBG("%s:%d %s: Reloaded schema, %zu tables added, %zu changed, "
+          "%zu removed, %zu unchanged",
+          __func__,
+          __LINE__,
+          p4_name_.c_str(),
+          reload_result.tables_added.size(),
+          reload_result.tables_changed.size(),
+          reload_result.tables_removed.size(),
+          reload_result.tables_unchanged);
+  if (result) *result = std::move(reload_result);
+  return TDI_SUCCESS;
+}
+
+void TdiInfo::nameMapsRebuild(Schema *schema) {
+  auto &tableIdMap = schema->tableIdMap;
+  auto &learnIdMap = schema->learnIdMap;
+  tableIdMap.clear();
+  for (const auto &kv : schema->tableMap) {
+    auto id = kv.second->tableInfoGet()->idGet();
+    if (tableIdMap.find(id) != tableIdMap.end()) {
+      LOG_WARN("%s:%d Table:%s ID %d Already exists. Not adding again",
+                __func__,
+                __LINE__,
+                kv.first.c_str(),
+                id);
+      continue;
+    }
+    tableIdMap[id] = kv.second.get();
+  }
+  schema->full_table_index.clear();
+  for (const auto &kv : schema->tableMap) {
+    schema->full_table_index.insert(kv.first, kv.second.get());
+  }
+
+  learnIdMap.clear();
+  for (const auto &kv : schema->learnMap) {
+    auto id = kv.second->learnInfoGet()->idGet();
+    if (learnIdMap.find(id) != learnIdMap.end()) {
+      LOG_WARN("%s:%d Learn :%s ID %d Already exists. Not adding again",
+                __func__,
+                __LINE__,
+                kv.first.c_str(),
+                id);
+      continue;
+    }
+    learnIdMap[id] = kv.second.get();
+  }
+  schema->full_learn_index.clear();
+  for (const auto &kv : schema->learnMap) {
+    schema->full_learn_index.insert(kv.first, kv.second.get());
+  }
 }
 
 tdi_status_t TdiInfo::tablesGet(
@@ -203,7 +531,13 @@ tdi_status_t TdiInfo::tablesGet(
     LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
     return TDI_INVALID_ARG;
   }
-  for (auto const &item : tableMap) {
+  std::unique_lock<std::mutex> lock(lazy_table_mutex_, std::defer_lock);
+  if (lazy_tables_) {
+    lock.lock();
+    lazyTablesBuildAll();
+  }
+  SchemaReader reader;
+  for (auto const &item : schema_.load()->tableMap) {
     table_vec_ret->push_back(item.second.get());
   }
   return TDI_SUCCESS;
@@ -211,25 +545,59 @@ tdi_status_t TdiInfo::tablesGet(
 
 tdi_status_t TdiInfo::tableFromNameGet(const std::string &name,
                                        const Table **table_ret) const {
-  if (invalid_table_names.find(name) != invalid_table_names.end()) {
-    LOG_ERROR("%s:%d Table \"%s\" was optimized out",
+  return tableFromNameGet(name.data(), name.size(), table_ret);
+}
+
+tdi_status_t TdiInfo::tableFromNameGet(const char *name,
+                                       const size_t &len,
+                                       const Table **table_ret) const {
+  // Targets rarely mark tables as optimized out, only build a string
+  // if there is something to check against
+  if (!invalid_table_names.empty() &&
+      invalid_table_names.find(std::string(name, len)) !=
+          invalid_table_names.end()) {
+    LOG_ERROR("%s:%d Table \"%.*s\" was optimized out",
               __func__,
               __LINE__,
-              name.c_str());
+              static_cast<int>(len),
+              name);
     return TDI_INVALID_ARG;
   }
-  auto it = this->fullTableMap.find(name);
-  if (it == this->fullTableMap.end()) {
-    LOG_ERROR("%s:%d Table \"%s\" not found", __func__, __LINE__, name.c_str());
-    return TDI_OBJECT_NOT_FOUND;
+  const Table *table = nullptr;
+  if (lazy_tables_) {
+    auto lazy_table = lazy_table_index_.find(name, len);
+    if (lazy_table) table = lazyTableGet(*lazy_table);
   } else {
-    *table_ret = it->second;
-    return TDI_SUCCESS;
+    SchemaReader reader;
+    table = schema_.load()->full_table_index.find(name, len);
   }
+  if (!table) {
+    LOG_ERROR("%s:%d Table \"%.*s\" not found",
+              __func__,
+              __LINE__,
+              static_cast<int>(len),
+              name);
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  *table_ret = table;
+  return TDI_SUCCESS;
 }
 
 tdi_status_t TdiInfo::tableFromIdGet(const tdi_id_t &id,
                                      const Table **table_ret) const {
+  if (lazy_tables_) {
+    auto it = lazyTableIdMap.find(id);
+    const Table *table = nullptr;
+    if (it != lazyTableIdMap.end()) table = lazyTableGet(*it->second);
+    if (!table) {
+      LOG_ERROR("%s:%d Table_id \"%d\" not found", __func__, __LINE__, id);
+      return TDI_OBJECT_NOT_FOUND;
+    }
+    *table_ret = table;
+    return TDI_SUCCESS;
+  }
+  SchemaReader reader;
+  const auto &tableIdMap = schema_.load()->tableIdMap;
   auto it = tableIdMap.find(id);
   if (it == tableIdMap.end()) {
     LOG_ERROR("%s:%d Table_id \"%d\" not found", __func__, __LINE__, id);
@@ -246,7 +614,8 @@ tdi_status_t TdiInfo::learnsGet(
     LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
     return TDI_INVALID_ARG;
   }
-  for (auto &item : learnMap) {
+  SchemaReader reader;
+  for (auto &item : schema_.load()->learnMap) {
     learn_vec_ret->push_back(item.second.get());
   }
   return TDI_SUCCESS;
@@ -254,17 +623,24 @@ tdi_status_t TdiInfo::learnsGet(
 
 tdi_status_t TdiInfo::learnFromNameGet(std::string name,
                                        const Learn **learn_ret) const {
-  if (this->fullLearnMap.find(name) == this->fullLearnMap.end()) {
+  const Learn *learn = nullptr;
+  {
+    SchemaReader reader;
+    learn = schema_.load()->full_learn_index.find(name);
+  }
+  if (!learn) {
     LOG_ERROR(
         "%s:%d Learn Obj \"%s\" not found", __func__, __LINE__, name.c_str());
     return TDI_OBJECT_NOT_FOUND;
   }
-  *learn_ret = this->fullLearnMap.at(name);
+  *learn_ret = learn;
   return TDI_SUCCESS;
 }
 
 tdi_status_t TdiInfo::learnFromIdGet(tdi_id_t id,
                                      const Learn **learn_ret) const {
+  SchemaReader reader;
+  const auto &learnIdMap = schema_.load()->learnIdMap;
   auto it = learnIdMap.find(id);
   if (it == learnIdMap.end()) {
     LOG_ERROR("%s:%d Learn_id \"%d\" not found", __func__, __LINE__, id);
@@ -277,12 +653,169 @@ tdi_status_t TdiInfo::learnFromIdGet(tdi_id_t id,
 
 const std::map<std::string, std::unique_ptr<tdi::Table>> &TdiInfo::tableMapGet()
     const {
-  return tableMap;
+  // Once all the tables are built the map no longer changes
+  if (lazy_tables_) {
+    std::lock_guard<std::mutex> lock(lazy_table_mutex_);
+    lazyTablesBuildAll();
+  }
+  return schema_.load()->tableMap;
 }
 
 const std::map<std::string, std::unique_ptr<tdi::Learn>> &TdiInfo::learnMapGet()
     const {
-  return learnMap;
+  return schema_.load()->learnMap;
+}
+
+tdi_status_t TdiInfo::memoryUsageGet(TdiInfoMemoryUsage *usage) const {
+  if (!usage) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  *usage = TdiInfoMemoryUsage();
+  // Lazy tables add to the maps and reloads replace the schema under the
+  // mutex
+  std::lock_guard<std::mutex> lock(lazy_table_mutex_);
+  const Schema &schema = *schema_.load();
+  const auto &tdi_info_parser = *schema.tdi_info_parser;
+  for (const auto &kv : tdi_info_parser.tableInfoMapGet()) {
+    if (kv.second) tableInfoUsageAdd(*kv.second, usage);
+  }
+  for (const auto &kv : tdi_info_parser.learnInfoMapGet()) {
+    if (!kv.second) continue;
+    const auto &learn_info = *kv.second;
+    auto field_ids = learn_info.dataFieldIdListGet();
+    const size_t field_node_bytes =
+        kTreeNodeBytes + sizeof(tdi_id_t) + sizeof(void *);
+    usage->learn_infos += sizeof(LearnInfo) +
+                          StringPool::stringHeapBytes(learn_info.nameGet()) +
+                          field_ids.size() * field_node_bytes +
+                          treeBytes(learn_info.annotationsGet());
+    for (const auto &id : field_ids) {
+      auto field = learn_info.dataFieldGet(id);
+      if (field) dataFieldsUsageAdd(*field, usage);
+    }
+  }
+  usage->string_pool = tdi_info_parser.stringPoolGet().bytesGet();
+  const auto &pending_tables = tdi_info_parser.pendingTablesGet();
+  usage->pending_tables = nameMapBytes(pending_tables);
+  for (const auto &kv : pending_tables) {
+    usage->pending_tables += StringPool::stringHeapBytes(kv.second);
+  }
+
+  size_t &bytes = usage->tdi_info;
+  bytes += sizeof(TdiInfo) + StringPool::stringHeapBytes(p4_name_);
+  bytes += sizeof(Schema);
+  bytes += nameMapBytes(schema.tableMap) +
+           schema.tableMap.size() * sizeof(tdi::Table);
+  bytes += shortNameIndexBytes(schema.full_table_index) +
+           treeBytes(schema.tableIdMap);
+  bytes += lazy_tables_list_.size() * sizeof(LazyTable);
+  bytes += shortNameIndexBytes(lazy_table_index_) + treeBytes(lazyTableIdMap);
+  bytes += nameMapBytes(schema.learnMap) +
+           schema.learnMap.size() * sizeof(tdi::Learn);
+  bytes += shortNameIndexBytes(schema.full_learn_index) +
+           treeBytes(schema.learnIdMap);
+  bytes += treeBytes(invalid_table_names);
+  for (const auto &name : invalid_table_names) {
+    bytes += StringPool::stringHeapBytes(name);
+  }
+  return TDI_SUCCESS;
+}
+
+TdiInfoRegistry &TdiInfoRegistry::getInstance() {
+  // Never destroyed, devices can outlive static destruction
+  static TdiInfoRegistry *registry = new TdiInfoRegistry();
+  return *registry;
+}
+
+tdi_status_t TdiInfoRegistry::tdiInfoGet(
+    const std::string &p4_name,
+    const std::vector<std::string> &tdi_info_file_paths,
+    std::unique_ptr<TdiInfoParser> tdi_info_parser,
+    std::unique_ptr<const tdi::TableFactory> factory,
+    std::shared_ptr<const TdiInfo> *tdi_info) {
+  if (!tdi_info_parser || !factory || !tdi_info) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  uint64_t schema_hash = 0;
+  auto status =
+      tdi_info_parser->schemaHashCompute(tdi_info_file_paths, &schema_hash);
+  if (status != TDI_SUCCESS) return status;
+
+  std::shared_ptr<Entry> entry;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Drop the entries of programs no device uses anymore
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second->tdi_info.expired() && it->second.use_count() == 1) {
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    const tdi::TableFactory &factory_ref = *factory;
+    auto &slot =
+        entries_[Key(p4_name, typeid(factory_ref).name(), schema_hash)];
+    if (!slot) slot = std::make_shared<Entry>();
+    entry = slot;
+  }
+
+  std::lock_guard<std::mutex> lock(entry->mutex);
+  {
+    // Taking a reference is atomic with tdiInfoDetach()
+    std::lock_guard<std::mutex> registry_lock(mutex_);
+    *tdi_info = entry->tdi_info.lock();
+  }
+  if (*tdi_info) {
+    LOG_DBG("%s:%d Sharing TdiInfo of %s",
+            __func__,
+            __LINE__,
+            p4_name.c_str());
+    return TDI_SUCCESS;
+  }
+  status = tdi_info_parser->parseTdiInfo(tdi_info_file_paths);
+  if (status != TDI_SUCCESS) return status;
+  std::shared_ptr<const TdiInfo> new_tdi_info = TdiInfo::makeTdiInfo(
+      p4_name, std::move(tdi_info_parser), std::move(factory));
+  if (!new_tdi_info) return TDI_UNEXPECTED;
+  {
+    std::lock_guard<std::mutex> registry_lock(mutex_);
+    entry->tdi_info = new_tdi_info;
+  }
+  *tdi_info = std::move(new_tdi_info);
+  return TDI_SUCCESS;
+}
+
+tdi_status_t TdiInfoRegistry::tdiInfoDetach(
+    const std::shared_ptr<const TdiInfo> &tdi_info) {
+  if (!tdi_info) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Other references can only be taken from the registry, under mutex_,
+  // or copied from existing ones. So the count can't grow while it is held
+  if (tdi_info.use_count() > 1) return TDI_IN_USE;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second->tdi_info.lock() == tdi_info) {
+      // A tdiInfoGet() already holding the entry must not find it either
+      it->second->tdi_info.reset();
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return TDI_SUCCESS;
+}
+
+size_t TdiInfoRegistry::sizeGet() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t size = 0;
+  for (const auto &kv : entries_) {
+    if (!kv.second->tdi_info.expired()) size++;
+  }
+  return size;
 }
 
 }  // namespace tdi
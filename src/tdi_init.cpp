@@ -13,6 +13,11 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <type_traits>
+
 // tdi includes
 #include <tdi/common/tdi_info.hpp>
 #include <tdi/common/tdi_init.hpp>
@@ -22,8 +27,6 @@
 
 namespace tdi {
 
-DevMgr *DevMgr::dev_mgr_instance = nullptr;
-std::mutex DevMgr::dev_mgr_instance_mutex;
 std::unique_ptr<WarmInitImpl> DevMgr::warm_init_impl(nullptr);
 
 tdi_status_t Device::tdiInfoGet(const std::string &prog_name,
@@ -50,7 +53,63 @@ tdi_status_t Device::p4NamesGet(
 
 tdi_status_t Device::deviceConfigGet(
     const std::vector<tdi::ProgramConfig> **device_config) const {
-  *device_config = &(this->device_config_);
+  *device_config = this->device_config_ptr_.load();
+  return TDI_SUCCESS;
+}
+
+tdi_status_t Device::programReload(const tdi::ProgramConfig &program_config,
+                                   TdiInfoReloadResult *result) {
+  auto it = this->tdi_info_map_.find(program_config.prog_name_);
+  if (it == this->tdi_info_map_.end()) {
+    LOG_ERROR("%s:%d Program %s not found for dev : %d",
+              __func__,
+              __LINE__,
+              program_config.prog_name_.c_str(),
+              this->device_id_);
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  auto tdi_info_parser = this->tdiInfoParserCreate();
+  auto table_factory = this->tableFactoryCreate();
+  if (!tdi_info_parser || !table_factory) {
+    LOG_ERROR("%s:%d Program reload not supported for dev : %d",
+              __func__,
+              __LINE__,
+              this->device_id_);
+    return TDI_NOT_SUPPORTED;
+  }
+  // The registry entry is keyed by the old files. Fails if another device
+  // shares the TdiInfo, no device can start sharing it once detached
+  if (TdiInfoRegistry::getInstance().tdiInfoDetach(it->second) !=
+      TDI_SUCCESS) {
+    LOG_ERROR("%s:%d Program %s is shared with other devices, dev : %d",
+              __func__,
+              __LINE__,
+              program_config.prog_name_.c_str(),
+              this->device_id_);
+    return TDI_IN_USE;
+  }
+  // TdiInfo objects are created non-const by makeTdiInfo() and only handed
+  // out as const
+  auto tdi_info = const_cast<TdiInfo *>(it->second.get());
+  auto sts = tdi_info->schemaReload(std::move(tdi_info_parser),
+                                    program_config.tdi_info_file_paths_,
+                                    table_factory.get(),
+                                    result);
+  if (sts != TDI_SUCCESS) {
+    return sts;
+  }
+
+  // ProgramConfig is not assignable, rebuild the vector
+  std::unique_ptr<std::vector<tdi::ProgramConfig>> device_config(
+      new std::vector<tdi::ProgramConfig>());
+  for (const auto &config : *this->device_config_) {
+    device_config->push_back(config.prog_name_ == program_config.prog_name_
+                                 ? program_config
+                                 : config);
+  }
+  this->device_config_ptr_.store(device_config.get());
+  this->retired_device_config_ = std::move(this->device_config_);
+  this->device_config_ = std::move(device_config);
   return TDI_SUCCESS;
 }
 
@@ -71,28 +130,58 @@ tdi_status_t Device::createFlags(const uint64_t &flags_val,
 }
 
 DevMgr &DevMgr::getInstance() {
-  if (dev_mgr_instance == nullptr) {
-    dev_mgr_instance_mutex.lock();
-    if (dev_mgr_instance == nullptr) {
-      dev_mgr_instance = new DevMgr();
+  // Initialized once even with concurrent callers. Never destroyed, like
+  // the devices it holds. Static storage keeps the reader slots aligned,
+  // operator new doesn't have to before C++17
+  static std::aligned_storage<sizeof(DevMgr), alignof(DevMgr)>::type storage;
+  static DevMgr *dev_mgr_instance = new (&storage) DevMgr();
+  return *dev_mgr_instance;
+}
+
+DevMgr::DevMgr() : dev_snapshot_(nullptr) {}
+
+bool DevMgr::deviceLookup(const tdi_dev_id_t &dev_id,
+                          const Device **device,
+                          std::shared_ptr<const Device> *shared) const {
+  ReaderEpochs::Slot *slot = nullptr;
+  auto epoch = readers_.readLock(&slot);
+  bool found = false;
+  // Only loads, so that concurrent lookups share the snapshot's cache
+  // lines
+  auto snapshot = dev_snapshot_.load();
+  if (snapshot) {
+    auto it = std::lower_bound(
+        snapshot->begin(),
+        snapshot->end(),
+        dev_id,
+        [](const DeviceSnapshot::value_type &entry, const tdi_dev_id_t &id) {
+          return entry.first < id;
+        });
+    if (it != snapshot->end() && it->first == dev_id) {
+      if (device) *device = it->second.get();
+      if (shared) *shared = it->second;
+      found = true;
     }
-    dev_mgr_instance_mutex.unlock();
   }
-  return *(DevMgr::dev_mgr_instance);
+  readers_.readUnlock(slot, epoch);
+  return found;
 }
 
 tdi_status_t DevMgr::deviceGet(const tdi_dev_id_t &dev_id,
                                const tdi::Device **device) const {
-  if (this->dev_map_.find(dev_id) == this->dev_map_.end()) {
-    LOG_ERROR("%s:%d Device Object not found for dev : %d",
-              __func__,
-              __LINE__,
-              dev_id);
-    return TDI_OBJECT_NOT_FOUND;
-  }
+  if (deviceLookup(dev_id, device, nullptr)) return TDI_SUCCESS;
+  LOG_ERROR(
+      "%s:%d Device Object not found for dev : %d", __func__, __LINE__, dev_id);
+  return TDI_OBJECT_NOT_FOUND;
+}
 
-  *device = this->dev_map_.at(dev_id).get();
-  return TDI_SUCCESS;
+tdi_status_t DevMgr::deviceGet(
+    const tdi_dev_id_t &dev_id,
+    std::shared_ptr<const tdi::Device> *device) const {
+  if (deviceLookup(dev_id, nullptr, device)) return TDI_SUCCESS;
+  LOG_ERROR(
+      "%s:%d Device Object not found for dev : %d", __func__, __LINE__, dev_id);
+  return TDI_OBJECT_NOT_FOUND;
 }
 
 tdi_status_t DevMgr::deviceIdListGet(
@@ -101,24 +190,67 @@ tdi_status_t DevMgr::deviceIdListGet(
     LOG_ERROR("%s:%d Please allocate space for out param", __func__, __LINE__);
     return TDI_INVALID_ARG;
   }
-  for (const auto &pair : this->dev_map_) {
-    if ((*device_id_list).find(pair.first) == (*device_id_list).end()) {
-      (*device_id_list).insert(pair.first);
+  ReaderEpochs::Slot *slot = nullptr;
+  auto epoch = readers_.readLock(&slot);
+  auto snapshot = dev_snapshot_.load();
+  if (snapshot) {
+    for (const auto &pair : *snapshot) {
+      if ((*device_id_list).find(pair.first) == (*device_id_list).end()) {
+        (*device_id_list).insert(pair.first);
+      }
     }
   }
+  readers_.readUnlock(slot, epoch);
   return TDI_SUCCESS;
 }
 
 tdi_status_t DevMgr::deviceRemove(const tdi_dev_id_t &dev_id) {
-
-  if (this->dev_map_.find(dev_id) != this->dev_map_.end())
-    this->dev_map_.erase(dev_id);
+  std::shared_ptr<Device> device;
+  {
+    std::lock_guard<std::mutex> lock(dev_map_mutex_);
+    auto it = this->dev_map_.find(dev_id);
+    if (it != this->dev_map_.end()) {
+      device = std::move(it->second);
+      this->dev_map_.erase(it);
+      snapshotPublish();
+    }
+  }
+  // Destroyed here unless a caller of deviceGet() still holds it. No lookup
+  // uses the old snapshot anymore
+  device.reset();
 
   LOG_DBG(
       "%s:%d  Device Remove called for dev : %d", __func__, __LINE__, dev_id);
   return TDI_SUCCESS;
 }
 
+tdi_status_t DevMgr::programReload(const tdi_dev_id_t &dev_id,
+                                   const tdi::ProgramConfig &program_config,
+                                   TdiInfoReloadResult *result) {
+  std::lock_guard<std::mutex> lock(dev_map_mutex_);
+  auto it = this->dev_map_.find(dev_id);
+  if (it == this->dev_map_.end()) {
+    LOG_ERROR("%s:%d Device Object not found for dev : %d",
+              __func__,
+              __LINE__,
+              dev_id);
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  return it->second->programReload(program_config, result);
+}
+
+void DevMgr::snapshotPublish() {
+  std::unique_ptr<DeviceSnapshot> snapshot(new DeviceSnapshot());
+  snapshot->reserve(dev_map_.size());
+  for (const auto &kv : dev_map_) {
+    snapshot->emplace_back(kv.first, kv.second);
+  }
+  dev_snapshot_.store(snapshot.get());
+  readers_.readersWait();
+  // Frees the replaced snapshot and drops its device references
+  snapshot_ = std::move(snapshot);
+}
+
 void DevMgr::warmInitImplSet(std::unique_ptr<WarmInitImpl> impl) {
   warm_init_impl = std::move(impl);
 }
@@ -0,0 +1,340 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/** @file tdi_json_bench.cpp
+ *
+ *  @brief Startup benchmark. Generates a synthetic tdi.json and times
+ *  TdiInfoParser::parseTdiInfo(), TdiInfo::makeTdiInfo() and the short name
+ *  resolution of the tables, along with the peak RSS of every phase
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <tdi/common/tdi_info.hpp>
+#include <tdi/common/tdi_json_parser/tdi_info_parser.hpp>
+#include <tdi/common/tdi_json_parser/tdi_name_index.hpp>
+
+#include <dummy/tdi_dummy_info.hpp>
+
+namespace {
+
+struct BenchConfig {
+  size_t tables{1000};
+  size_t keys{4};
+  size_t actions{4};
+  size_t fields{4};
+  // Percentage of tables, keys, actions and fields with an annotation
+  size_t annotations{25};
+  // Tables are spread over this many controls with the same leaf names, so
+  // that short names conflict
+  size_t controls{4};
+  size_t iterations{5};
+  size_t threads{1};
+  std::string out;
+};
+
+void usage(const char *prog) {
+  std::printf(
+      "Usage: %s [options]\n"
+      "  --tables N       Number of tables (1000)\n"
+      "  --keys N         Key fields per table (4)\n"
+      "  --actions N      Actions per table (4)\n"
+      "  --fields N       Data fields per action (4)\n"
+      "  --annotations N  Percentage of annotated objects, 0-100 (25)\n"
+      "  --controls N     Controls the tables are spread over (4)\n"
+      "  --iterations N   Iterations of every phase (5)\n"
+      "  --threads N      Parse threads, see parseThreadsSet() (1)\n"
+      "  --out PATH       Keep the generated tdi.json at PATH\n",
+      prog);
+}
+
+bool parseArgs(int argc, char *argv[], BenchConfig *config) {
+  const std::map<std::string, size_t *> size_args = {
+      {"--tables", &config->tables},
+      {"--keys", &config->keys},
+      {"--actions", &config->actions},
+      {"--fields", &config->fields},
+      {"--annotations", &config->annotations},
+      {"--controls", &config->controls},
+      {"--iterations", &config->iterations},
+      {"--threads", &config->threads}};
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) return false;
+    if (arg == "--out") {
+      config->out = argv[++i];
+      continue;
+    }
+    auto it = size_args.find(arg);
+    if (it == size_args.end()) return false;
+    char *end = nullptr;
+    *it->second = std::strtoul(argv[++i], &end, 10);
+    if (*end) return false;
+  }
+  return config->tables && config->controls && config->iterations &&
+         config->annotations <= 100;
+}
+
+const char *const kMatchTypes[] = {"Exact", "Ternary", "LPM"};
+
+// Writes the schema without whitespace. Annotated objects are picked by a
+// fixed LCG so that runs are reproducible
+class JsonGenerator {
+ public:
+  explicit JsonGenerator(const BenchConfig &config) : config_(config){};
+
+  std::string generate() {
+    out_.clear();
+    out_ += "{\"schema_version\":\"1.0.0\",\"tables\":[";
+    for (size_t t = 0; t < config_.tables; t++) {
+      if (t) out_ += ",";
+      table(t);
+    }
+    out_ += "],\"learn_filters\":[]}\n";
+    return out_;
+  }
+
+ private:
+  void table(const size_t &t) {
+    std::string control = "Control" + std::to_string(t % config_.controls);
+    out_ += "{\"name\":\"pipe." + control + ".table_" +
+            std::to_string(t / config_.controls) + "\"";
+    out_ += ",\"id\":" + std::to_string(kTableIdBase + t);
+    out_ += ",\"table_type\":\"MatchAction_Direct\",\"size\":1024";
+    annotations();
+    out_ += ",\"depends_on\":[],\"has_const_default_action\":false,\"key\":[";
+    for (size_t k = 0; k < config_.keys; k++) {
+      if (k) out_ += ",";
+      out_ += "{\"id\":" + std::to_string(k + 1) + ",\"name\":\"hdr.f" +
+              std::to_string(k) + "\",\"repeated\":false";
+      annotations();
+      out_ += ",\"mandatory\":false,\"match_type\":\"";
+      out_ += kMatchTypes[k % 3];
+      out_ += "\",\"type\":{\"type\":\"bytes\",\"width\":32}}";
+    }
+    out_ += "],\"action_specs\":[";
+    for (size_t a = 0; a < config_.actions; a++) {
+      if (a) out_ += ",";
+      out_ += "{\"id\":" +
+              std::to_string(kActionIdBase + t * config_.actions + a) +
+              ",\"name\":\"" + control + ".action_" + std::to_string(a) +
+              "\",\"action_scope\":\"TableAndDefault\"";
+      annotations();
+      out_ += ",\"data\":[";
+      for (size_t f = 0; f < config_.fields; f++) {
+        if (f) out_ += ",";
+        out_ += "{\"id\":" + std::to_string(f + 1) + ",\"name\":\"param_" +
+                std::to_string(f) +
+                "\",\"repeated\":false,\"mandatory\":true,"
+                "\"read_only\":false";
+        annotations();
+        out_ += ",\"type\":{\"type\":\"bytes\",\"width\":16}}";
+      }
+      out_ += "]}";
+    }
+    out_ += "],\"data\":[],\"supported_operations\":[],"
+            "\"attributes\":[\"EntryScope\"]}";
+  }
+
+  void annotations() {
+    out_ += ",\"annotations\":[";
+    seed_ = seed_ * 6364136223846793005ULL + 1442695040888963407ULL;
+    if ((seed_ >> 33) % 100 < config_.annotations) {
+      out_ += "{\"name\":\"@bench\",\"value\":\"" +
+              std::to_string((seed_ >> 40) % 16) + "\"}";
+    }
+    out_ += "]";
+  }
+
+  static const size_t kTableIdBase = 0x1000000;
+  static const size_t kActionIdBase = 0x2000000;
+  const BenchConfig &config_;
+  std::string out_;
+  uint64_t seed_{1};
+};
+
+// Peak RSS of a phase. Linux resets the high water mark of VmRSS on a write
+// of 5 to clear_refs. Without it the peak of the process is all there is
+class PeakRss {
+ public:
+  void reset() {
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    resettable_ = clear_refs.good();
+    start_kib_ = statusGet("VmRSS:");
+  }
+  // Peak RSS above the RSS at reset(), in KiB
+  long peakKibGet() const {
+    long peak = resettable_ ? statusGet("VmHWM:") : maxRssGet();
+    return std::max(peak - start_kib_, 0L);
+  }
+  bool resettableGet() const { return resettable_; };
+
+ private:
+  static long statusGet(const char *field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+      if (line.compare(0, std::strlen(field), field) == 0) {
+        return std::strtol(line.c_str() + std::strlen(field), nullptr, 10);
+      }
+    }
+    return 0;
+  }
+  static long maxRssGet() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+  bool resettable_{false};
+  long start_kib_{0};
+};
+
+struct PhaseResult {
+  std::vector<double> ms;
+  long peak_kib{0};
+
+  void add(const std::chrono::steady_clock::time_point &start,
+           const PeakRss &rss) {
+    ms.push_back(std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start)
+                     .count());
+    peak_kib = std::max(peak_kib, rss.peakKibGet());
+  }
+  void print(const char *name) {
+    std::sort(ms.begin(), ms.end());
+    std::printf("%-22s %10.3f %10.3f %10.3f %12ld\n",
+                name,
+                ms.front(),
+                ms[ms.size() / 2],
+                ms.back(),
+                peak_kib);
+  }
+};
+
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  BenchConfig config;
+  if (!parseArgs(argc, argv, &config)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::string json_path = config.out;
+  if (json_path.empty()) {
+    char tmp_path[] = "/tmp/tdi_json_bench_XXXXXX";
+    int fd = mkstemp(tmp_path);
+    if (fd < 0) {
+      std::perror("mkstemp");
+      return 1;
+    }
+    close(fd);
+    json_path = tmp_path;
+  }
+  {
+    JsonGenerator generator(config);
+    std::string json = generator.generate();
+    std::ofstream file(json_path);
+    file << json;
+    if (!file.good()) {
+      std::fprintf(stderr, "Unable to write %s\n", json_path.c_str());
+      return 1;
+    }
+    std::printf(
+        "%zu tables, %zu keys, %zu actions, %zu fields, %zu%% annotated, "
+        "%zu controls, %zu threads, tdi.json %.1f MiB\n",
+        config.tables,
+        config.keys,
+        config.actions,
+        config.fields,
+        config.annotations,
+        config.controls,
+        config.threads,
+        json.size() / (1024.0 * 1024.0));
+  }
+
+  PhaseResult parse_result, make_result, name_map_result;
+  PeakRss rss;
+  tdi::TdiInfoMemoryUsage usage;
+  size_t num_tables = 0;
+  for (size_t i = 0; i < config.iterations; i++) {
+    auto tdi_info_parser =
+        std::unique_ptr<tdi::TdiInfoParser>(new tdi::TdiInfoParser(
+            std::unique_ptr<tdi::TdiInfoMapper>(
+                new tdi::tna::dummy::TdiInfoMapper())));
+    tdi_info_parser->schemaCacheDirSet("");
+    tdi_info_parser->parseThreadsSet(config.threads);
+
+    rss.reset();
+    auto start = std::chrono::steady_clock::now();
+    if (tdi_info_parser->parseTdiInfo({json_path}) != TDI_SUCCESS) {
+      std::fprintf(stderr, "Failed to parse %s\n", json_path.c_str());
+      return 1;
+    }
+    parse_result.add(start, rss);
+
+    tdi::tna::dummy::TableFactory table_factory;
+    rss.reset();
+    start = std::chrono::steady_clock::now();
+    auto tdi_info = tdi::TdiInfo::makeTdiInfo(
+        "tdi_json_bench", std::move(tdi_info_parser), &table_factory);
+    if (!tdi_info) {
+      std::fprintf(stderr, "Failed to create TdiInfo\n");
+      return 1;
+    }
+    make_result.add(start, rss);
+
+    // makeTdiInfo() builds one short name index, this times it alone
+    tdi::ShortNameIndex<const tdi::Table> short_name_index;
+    rss.reset();
+    start = std::chrono::steady_clock::now();
+    for (const auto &kv : tdi_info->tableMapGet()) {
+      short_name_index.insert(kv.first, kv.second.get());
+    }
+    name_map_result.add(start, rss);
+
+    num_tables = tdi_info->tableMapGet().size();
+    tdi_info->memoryUsageGet(&usage);
+  }
+  if (config.out.empty()) std::remove(json_path.c_str());
+
+  std::printf("%zu tables built, TdiInfo memory %zu KiB\n",
+              num_tables,
+              usage.totalGet() / 1024);
+  std::printf("%-22s %10s %10s %10s %12s\n",
+              "phase",
+              "min ms",
+              "median ms",
+              "max ms",
+              rss.resettableGet() ? "peak KiB" : "proc peak KiB");
+  parse_result.print("parseTdiInfo");
+  make_result.print("makeTdiInfo");
+  name_map_result.print("ShortNameIndex");
+  return num_tables == config.tables ? 0 : 1;
+}
@@ -14,6 +14,12 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -28,27 +34,86 @@
 
 namespace tdi {
 
-CjsonObjHandler::CjsonObjHandler(const std::string &fileContent) {
-  this->root = cJSON_Parse(fileContent.c_str());
+JsonFileBuffer::~JsonFileBuffer() { this->reset(); }
+
+void JsonFileBuffer::reset() {
+  if (map_) {
+    munmap(map_, size_ + 1);
+    map_ = nullptr;
+  }
+  size_ = 0;
+  std::string().swap(buf_);
+}
+
+tdi_status_t JsonFileBuffer::load(const std::string &path) {
+  this->reset();
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  struct stat st;
+  bool is_reg = (fstat(fd, &st) == 0) && S_ISREG(st.st_mode);
+  size_t file_size = is_reg ? static_cast<size_t>(st.st_size) : 0;
+  long page_size = sysconf(_SC_PAGESIZE);
+  // Only map if the last page has room for the terminating zero. It is
+  // stored explicitly, the private copy of the page keeps it even if the
+  // file grows meanwhile
+  if (file_size && page_size > 0 &&
+      file_size % static_cast<size_t>(page_size)) {
+    void *addr = mmap(
+        nullptr, file_size + 1, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      madvise(addr, file_size, MADV_SEQUENTIAL);
+      map_ = static_cast<char *>(addr);
+      map_[file_size] = '\0';
+      size_ = file_size;
+      close(fd);
+      return TDI_SUCCESS;
+    }
+  }
+  buf_.reserve(file_size);
+  char chunk[65536];
+  ssize_t len;
+  while ((len = read(fd, chunk, sizeof(chunk))) != 0) {
+    if (len < 0) {
+      if (errno == EINTR) continue;
+      close(fd);
+      this->reset();
+      return TDI_OBJECT_NOT_FOUND;
+    }
+    buf_.append(chunk, static_cast<size_t>(len));
+  }
+  close(fd);
+  size_ = buf_.size();
+  return TDI_SUCCESS;
+}
+
+CjsonObjHandler::CjsonObjHandler(const char *text) {
+  this->root = cJSON_Parse(text);
   if (!this->root) {
     std::string error(cJSON_GetErrorPtr());
   }
 }
 CjsonObjHandler::~CjsonObjHandler() { cJSON_Delete(this->root); }
 
-Cjson::Cjson(const Cjson &parent, const std::string &key) {
-  root = cJSON_GetObjectItem(parent.root, key.c_str());
+Cjson::Cjson(const Cjson &parent, const std::string &key)
+    : Cjson(parent, key.c_str()) {}
+
+Cjson::Cjson(const Cjson &parent, const char *key) {
+  root = cJSON_GetObjectItem(parent.root, key);
   this->cjson_mem_tracker = parent.cjson_mem_tracker;
 }
 
 Cjson Cjson::createCjsonFromFile(const std::string &fileContent) {
+  return Cjson::createCjsonFromBuffer(fileContent.c_str());
+}
+Cjson Cjson::createCjsonFromBuffer(const char *text) {
   Cjson obj;
-  Cjson::createCjsonFromFileInternal(fileContent, obj);
+  Cjson::createCjsonFromFileInternal(text, obj);
   return obj;
 }
-void Cjson::createCjsonFromFileInternal(const std::string &fileContent,
-                                        Cjson &obj) {
-  obj.cjson_mem_tracker = std::make_shared<CjsonObjHandler>(fileContent);
+void Cjson::createCjsonFromFileInternal(const char *text, Cjson &obj) {
+  obj.cjson_mem_tracker = std::make_shared<CjsonObjHandler>(text);
   obj.root = obj.cjson_mem_tracker->rootGet();
 }
 
@@ -78,25 +143,15 @@ std::string Cjson::getCjsonKey() const {
 
 std::vector<std::shared_ptr<Cjson>> Cjson::getCjsonChildVec() const {
   std::vector<std::shared_ptr<Cjson>> ret_vec;
-  if (root) {
-    int count = cJSON_GetArraySize(root);
-    if (count != 0) {
-      for (int i = 0; i < count; i++) {
-        ret_vec.push_back(std::make_shared<Cjson>(*this, i));
-      }
-    }
+  for (const auto &child : this->children()) {
+    ret_vec.push_back(std::make_shared<Cjson>(child));
   }
   return ret_vec;
 }
 std::vector<std::string> Cjson::getCjsonChildStringVec() const {
   std::vector<std::string> ret_vec;
-  if (root) {
-    int count = cJSON_GetArraySize(root);
-    if (count != 0) {
-      for (int i = 0; i < count; i++) {
-        ret_vec.push_back(std::string(Cjson(*this, i)));
-      }
-    }
+  for (const auto &child : this->children()) {
+    ret_vec.push_back(std::string(child));
   }
   return ret_vec;
 }
@@ -181,11 +236,10 @@ Cjson::operator float() const {
 
 Cjson Cjson::operator[](int index) const { return Cjson(*this, index); }
 
-Cjson Cjson::operator[](const char *key) const {
-  return Cjson(*this, std::string(key));
-}
+// Keys are looked up as C strings, without building a std::string
+Cjson Cjson::operator[](const char *key) const { return Cjson(*this, key); }
 Cjson Cjson::operator[](const std::string &key) const {
-  return (*this)[key.c_str()];
+  return Cjson(*this, key.c_str());
 }
 Cjson &Cjson::operator+=(const Cjson &other) {
   cJSON_AddItemReferenceToArray(this->root, other.root);
@@ -199,6 +253,15 @@ void Cjson::updateChildNode(const std::string &key, const std::string &val) {
   cJSON_AddStringToObject(this->root, key.c_str(), val.c_str());
 }
 
+std::string Cjson::printUnformatted() const {
+  if (!root) return std::string();
+  auto cjson_out_str = cJSON_PrintUnformatted(root);
+  if (!cjson_out_str) return std::string();
+  std::string text(cjson_out_str);
+  bf_sys_free(cjson_out_str);
+  return text;
+}
+
 std::ostream &operator<<(std::ostream &out, const Cjson &c) {
   auto cjson_out_str = cJSON_Print(c.root);
   out << cjson_out_str << std::endl;
@@ -0,0 +1,707 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Binary image of the TableInfo/LearnInfo graph built by TdiInfoParser.
+//
+// Layout, all integers little endian:
+//   magic "TDISCHEM" | u32 version | u64 schema hash | u64 payload size |
+//   u64 payload checksum | payload
+// The payload is a flat encoding of the objects in the order of their
+// constructor arguments. Bump kSchemaCacheVersion on any change to it or to
+// the objects it encodes; images of other versions are ignored.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <tdi/common/tdi_info.hpp>
+#include <tdi/common/tdi_json_parser/tdi_cjson.hpp>
+#include <tdi/common/tdi_json_parser/tdi_info_parser.hpp>
+#include <tdi/common/tdi_utils.hpp>
+
+namespace tdi {
+
+namespace {
+
+const char kSchemaCacheMagic[8] = {'T', 'D', 'I', 'S', 'C', 'H', 'E', 'M'};
+const uint32_t kSchemaCacheVersion = 1;
+const size_t kSchemaCacheHeaderSize = sizeof(kSchemaCacheMagic) +
+                                      sizeof(uint32_t) + 3 * sizeof(uint64_t);
+
+// FNV-1a
+class Fnv1a {
+ public:
+  void update(const void *data, size_t len) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < len; i++) {
+      hash_ ^= bytes[i];
+      hash_ *= 1099511628211ULL;
+    }
+  }
+  void update(const std::string &str) {
+    uint64_t len = str.size();
+    update(&len, sizeof(len));
+    update(str.data(), str.size());
+  }
+  const uint64_t &get() const { return hash_; };
+
+ private:
+  uint64_t hash_{14695981039346656037ULL};
+};
+
+class Writer {
+ public:
+  void u8(const uint8_t &v) { buf_.push_back(v); }
+  void u32(const uint32_t &v) { fixed(v, 4); }
+  void u64(const uint64_t &v) { fixed(v, 8); }
+  void f32(const float &v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    u32(bits);
+  }
+  void str(const std::string &v) {
+    u32(static_cast<uint32_t>(v.size()));
+    buf_.insert(buf_.end(), v.begin(), v.end());
+  }
+  void strVec(const std::vector<std::string> &v) {
+    u32(static_cast<uint32_t>(v.size()));
+    for (const auto &s : v) str(s);
+  }
+  template <typename T>
+  void u32Set(const std::set<T> &v) {
+    u32(static_cast<uint32_t>(v.size()));
+    for (const auto &e : v) u32(static_cast<uint32_t>(e));
+  }
+  void annotations(const std::set<Annotation> &v) {
+    u32(static_cast<uint32_t>(v.size()));
+    for (const auto &a : v) {
+      str(a.name_);
+      str(a.value_);
+    }
+  }
+  const std::vector<uint8_t> &bufGet() const { return buf_; };
+
+ private:
+  void fixed(const uint64_t &v, const size_t &n) {
+    for (size_t i = 0; i < n; i++) buf_.push_back((v >> (8 * i)) & 0xFF);
+  }
+  std::vector<uint8_t> buf_;
+};
+
+// Every read is bounds checked. Once a read fails all later reads fail and
+// return zero values, so decoders check okGet() once at the end of an object
+class Reader {
+ public:
+  Reader(const uint8_t *data, size_t len, StringPool &pool)
+      : data_(data), len_(len), pool_(pool){};
+  uint8_t u8() {
+    if (!take(1)) return 0;
+    return data_[pos_ - 1];
+  }
+  bool b() { return u8() != 0; }
+  uint32_t u32() { return static_cast<uint32_t>(fixed(4)); }
+  uint64_t u64() { return fixed(8); }
+  float f32() {
+    uint32_t bits = u32();
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+  std::string str() {
+    uint32_t n = u32();
+    if (!take(n)) return std::string();
+    return std::string(reinterpret_cast<const char *>(data_ + pos_ - n), n);
+  }
+  std::vector<std::string> strVec() {
+    std::vector<std::string> v;
+    uint32_t n = count();
+    for (uint32_t i = 0; i < n; i++) v.push_back(str());
+    return v;
+  }
+  template <typename T>
+  std::set<T> u32Set() {
+    std::set<T> v;
+    uint32_t n = count();
+    for (uint32_t i = 0; i < n; i++) v.insert(static_cast<T>(u32()));
+    return v;
+  }
+  std::set<Annotation> annotations() {
+    std::set<Annotation> v;
+    uint32_t n = count();
+    for (uint32_t i = 0; i < n; i++) {
+      std::string name = str();
+      std::string value = str();
+      v.emplace(pool_, name, value);
+    }
+    return v;
+  }
+  // Element count, bounded by the remaining bytes so that a corrupt count
+  // cannot cause huge allocations
+  uint32_t count() {
+    uint32_t n = u32();
+    if (n > len_ - pos_) {
+      ok_ = false;
+      return 0;
+    }
+    return n;
+  }
+  const bool &okGet() const { return ok_; };
+  // Pool the strings of the decoded objects are interned in
+  StringPool &poolGet() { return pool_; };
+  bool atEnd() const { return pos_ == len_; };
+
+ private:
+  bool take(const size_t &n) {
+    if (!ok_ || n > len_ - pos_) {
+      ok_ = false;
+      return false;
+    }
+    pos_ += n;
+    return true;
+  }
+  uint64_t fixed(const size_t &n) {
+    if (!take(n)) return 0;
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++) {
+      v |= static_cast<uint64_t>(data_[pos_ - n + i]) << (8 * i);
+    }
+    return v;
+  }
+  const uint8_t *data_;
+  size_t len_;
+  size_t pos_{0};
+  bool ok_{true};
+  StringPool &pool_;
+};
+
+}  // anonymous namespace
+
+// Encoding and decoding need the private constructors and members of the
+// info classes, which are friends of TdiInfoParser only
+class TdiInfoCacheCodec {
+ public:
+  static void writeKeyField(Writer &w, const KeyFieldInfo &f) {
+    w.u32(f.field_id_);
+    w.str(f.name_);
+    w.u64(f.size_bits_);
+    w.u32(static_cast<uint32_t>(f.match_type_));
+    w.u32(static_cast<uint32_t>(f.data_type_));
+    w.u8(f.mandatory_);
+    w.strVec(f.enum_choices_);
+    w.annotations(f.annotations_);
+    w.u64(f.default_value_);
+    w.f32(f.default_fl_value_);
+    w.str(f.default_str_value_);
+    w.u8(f.is_field_slice_);
+    w.u8(f.is_ptr_);
+    w.u8(f.match_priority_);
+  }
+  static std::unique_ptr<KeyFieldInfo> readKeyField(Reader &r) {
+    auto id = r.u32();
+    auto name = r.str();
+    auto size_bits = r.u64();
+    auto match_type = static_cast<tdi_match_type_e>(r.u32());
+    auto data_type = static_cast<tdi_field_data_type_e>(r.u32());
+    auto mandatory = r.b();
+    auto choices = r.strVec();
+    auto annotations = r.annotations();
+    auto default_value = r.u64();
+    auto default_fl_value = r.f32();
+    auto default_str_value = r.str();
+    auto is_field_slice = r.b();
+    auto is_ptr = r.b();
+    auto match_priority = r.b();
+    if (!r.okGet()) return nullptr;
+    return std::unique_ptr<KeyFieldInfo>(new KeyFieldInfo(r.poolGet(),
+                                                          id,
+                                                          name,
+                                                          size_bits,
+                                                          match_type,
+                                                          data_type,
+                                                          mandatory,
+                                                          choices,
+                                                          annotations,
+                                                          default_value,
+                                                          default_fl_value,
+                                                          default_str_value,
+                                                          is_field_slice,
+                                                          is_ptr,
+                                                          match_priority));
+  }
+
+  static void writeDataField(Writer &w, const DataFieldInfo &f) {
+    w.u32(f.field_id_);
+    w.str(f.name_);
+    w.u64(f.size_bits_);
+    w.u32(static_cast<uint32_t>(f.data_type_));
+    w.u8(f.mandatory_);
+    w.u8(f.read_only_);
+    w.strVec(f.enum_choices_);
+    w.annotations(f.annotationsGet());
+    w.u64(f.default_value_);
+    w.f32(f.default_fl_value_);
+    w.str(f.default_str_value_);
+    w.u8(f.repeated_);
+    w.u8(f.container_valid_);
+    w.u32Set(f.oneofSiblingsGet());
+  }
+  static std::unique_ptr<DataFieldInfo> readDataField(Reader &r) {
+    auto id = r.u32();
+    auto name = r.str();
+    auto size_bits = r.u64();
+    auto data_type = static_cast<tdi_field_data_type_e>(r.u32());
+    auto mandatory = r.b();
+    auto read_only = r.b();
+    auto choices = r.strVec();
+    auto annotations = r.annotations();
+    auto default_value = r.u64();
+    auto default_fl_value = r.f32();
+    auto default_str_value = r.str();
+    auto repeated = r.b();
+    auto container_valid = r.b();
+    auto oneof_siblings = r.u32Set<tdi_id_t>();
+    if (!r.okGet()) return nullptr;
+    return std::unique_ptr<DataFieldInfo>(new DataFieldInfo(r.poolGet(),
+                                                            id,
+                                                            name,
+                                                            size_bits,
+                                                            data_type,
+                                                            mandatory,
+                                                            read_only,
+                                                            choices,
+                                                            annotations,
+                                                            default_value,
+                                                            default_fl_value,
+                                                            default_str_value,
+                                                            repeated,
+                                                            container_valid,
+                                                            oneof_siblings));
+  }
+
+  static void writeDataFields(
+      Writer &w, const std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> &m) {
+    w.u32(static_cast<uint32_t>(m.size()));
+    for (const auto &kv : m) writeDataField(w, *kv.second);
+  }
+  static bool readDataFields(
+      Reader &r, std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> *m) {
+    uint32_t n = r.count();
+    for (uint32_t i = 0; i < n; i++) {
+      auto field = readDataField(r);
+      if (!field) return false;
+      (*m)[field->field_id_] = std::move(field);
+    }
+    return r.okGet();
+  }
+
+  static void writeAction(Writer &w, const ActionInfo &a) {
+    w.u32(a.action_id_);
+    w.str(a.name_);
+    writeDataFields(w, a.data_fields_);
+    w.annotations(a.annotations_);
+  }
+  static std::unique_ptr<ActionInfo> readAction(Reader &r) {
+    auto id = r.u32();
+    auto name = r.str();
+    std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> data_fields;
+    if (!readDataFields(r, &data_fields)) return nullptr;
+    auto annotations = r.annotations();
+    if (!r.okGet()) return nullptr;
+    return std::unique_ptr<ActionInfo>(
+        new ActionInfo(id, name, std::move(data_fields), annotations));
+  }
+
+  static void writeNotificationParams(
+      Writer &w,
+      const std::map<tdi_id_t, std::unique_ptr<NotificationParamInfo>> &m) {
+    w.u32(static_cast<uint32_t>(m.size()));
+    for (const auto &kv : m) {
+      const auto &p = *kv.second;
+      w.u32(p.field_id_);
+      w.str(p.name_);
+      w.u8(p.repeated_);
+      w.u64(p.size_bits_);
+      w.u32(static_cast<uint32_t>(p.data_type_));
+      w.u8(p.mandatory_);
+      w.strVec(p.enum_choices_);
+      w.annotations(p.annotations_);
+      w.u64(p.default_value_);
+      w.f32(p.default_fl_value_);
+      w.str(p.default_str_value_);
+    }
+  }
+  static bool readNotificationParams(
+      Reader &r,
+      std::map<tdi_id_t, std::unique_ptr<NotificationParamInfo>> *m) {
+    uint32_t n = r.count();
+    for (uint32_t i = 0; i < n; i++) {
+      auto id = r.u32();
+      auto name = r.str();
+      auto repeated = r.b();
+      auto size_bits = r.u64();
+      auto data_type = static_cast<tdi_field_data_type_e>(r.u32());
+      auto mandatory = r.b();
+      auto choices = r.strVec();
+      auto annotations = r.annotations();
+      auto default_value = r.u64();
+      auto default_fl_value = r.f32();
+      auto default_str_value = r.str();
+      if (!r.okGet()) return false;
+      (*m)[id] = std::unique_ptr<NotificationParamInfo>(
+          new NotificationParamInfo(r.poolGet(),
+                                    id,
+                                    name,
+                                    repeated,
+                                    size_bits,
+                                    data_type,
+                                    mandatory,
+                                    choices,
+                                    annotations,
+                                    default_value,
+                                    default_fl_value,
+                                    default_str_value));
+    }
+    return r.okGet();
+  }
+
+  static void writeNotification(Writer &w, const NotificationInfo &n) {
+    w.u32(n.notification_id_);
+    w.str(n.name_);
+    writeNotificationParams(w, n.registration_params_fields_);
+    writeNotificationParams(w, n.callback_params_fields_);
+    w.annotations(n.annotations_);
+  }
+  static std::unique_ptr<NotificationInfo> readNotification(Reader &r) {
+    auto id = r.u32();
+    auto name = r.str();
+    std::map<tdi_id_t, std::unique_ptr<NotificationParamInfo>> registration;
+    std::map<tdi_id_t, std::unique_ptr<NotificationParamInfo>> callback;
+    if (!readNotificationParams(r, &registration) ||
+        !readNotificationParams(r, &callback)) {
+      return nullptr;
+    }
+    auto annotations = r.annotations();
+    if (!r.okGet()) return nullptr;
+    return std::unique_ptr<NotificationInfo>(new NotificationInfo(
+        id, name, std::move(registration), std::move(callback), annotations));
+  }
+
+  // Table APIs and context infos are set by targets at runtime and are not
+  // part of the image
+  static void writeTable(Writer &w, const TableInfo &t) {
+    w.u32(t.id_);
+    w.str(t.name_);
+    w.u32(static_cast<uint32_t>(t.table_type_));
+    w.u64(t.size_);
+    w.u8(t.has_const_default_action_);
+    w.u8(t.is_const_);
+    w.u32(static_cast<uint32_t>(t.table_key_map_.size()));
+    for (const auto &kv : t.table_key_map_) writeKeyField(w, *kv.second);
+    writeDataFields(w, t.table_data_map_);
+    w.u32(static_cast<uint32_t>(t.table_action_map_.size()));
+    for (const auto &kv : t.table_action_map_) writeAction(w, *kv.second);
+    w.u32(static_cast<uint32_t>(t.table_notification_map_.size()));
+    for (const auto &kv : t.table_notification_map_) {
+      writeNotification(w, *kv.second);
+    }
+    w.u32Set(t.depends_on_set_);
+    w.u32Set(t.operations_type_set_);
+    w.u32Set(t.attributes_type_set_);
+    w.annotations(t.annotations_);
+  }
+  static std::unique_ptr<TableInfo> readTable(Reader &r) {
+    auto id = r.u32();
+    auto name = r.str();
+    auto table_type = static_cast<tdi_table_type_e>(r.u32());
+    auto size = r.u64();
+    auto has_const_default_action = r.b();
+    auto is_const = r.b();
+    std::map<tdi_id_t, std::unique_ptr<KeyFieldInfo>> key_map;
+    uint32_t n = r.count();
+    for (uint32_t i = 0; i < n; i++) {
+      auto key_field = readKeyField(r);
+      if (!key_field) return nullptr;
+      key_map[key_field->field_id_] = std::move(key_field);
+    }
+    std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> data_map;
+    if (!readDataFields(r, &data_map)) return nullptr;
+    std::map<tdi_id_t, std::unique_ptr<ActionInfo>> action_map;
+    n = r.count();
+    for (uint32_t i = 0; i < n; i++) {
+      auto action = readAction(r);
+      if (!action) return nullptr;
+      action_map[action->action_id_] = std::move(action);
+    }
+    std::map<tdi_id_t, std::unique_ptr<NotificationInfo>> notification_map;
+    n = r.count();
+    for (uint32_t i = 0; i < n; i++) {
+      auto notification = readNotification(r);
+      if (!notification) return nullptr;
+      notification_map[notification->notification_id_] =
+          std::move(notification);
+    }
+    auto depends_on = r.u32Set<tdi_id_t>();
+    auto operations = r.u32Set<tdi_operations_type_e>();
+    auto attributes = r.u32Set<tdi_attributes_type_e>();
+    auto annotations = r.annotations();
+    if (!r.okGet()) return nullptr;
+    return std::unique_ptr<TableInfo>(new TableInfo(id,
+                                                    name,
+                                                    table_type,
+                                                    size,
+                                                    has_const_default_action,
+                                                    is_const,
+                                                    std::move(key_map),
+                                                    std::move(data_map),
+                                                    std::move(action_map),
+                                                    std::move(notification_map),
+                                                    depends_on,
+                                                    SupportedApis(),
+                                                    operations,
+                                                    attributes,
+                                                    annotations));
+  }
+
+  static void writeLearn(Writer &w, const LearnInfo &l) {
+    w.u32(l.id_);
+    w.str(l.name_);
+    writeDataFields(w, l.learn_field_map_);
+    w.annotations(l.annotations_);
+  }
+  static std::unique_ptr<LearnInfo> readLearn(Reader &r) {
+    auto id = r.u32();
+    auto name = r.str();
+    std::map<tdi_id_t, std::unique_ptr<DataFieldInfo>> fields;
+    if (!readDataFields(r, &fields)) return nullptr;
+    auto annotations = r.annotations();
+    if (!r.okGet()) return nullptr;
+    return std::unique_ptr<LearnInfo>(
+        new LearnInfo(id, name, std::move(fields), annotations));
+  }
+};
+
+uint64_t TdiInfoParser::schemaHashGet(
+    const std::vector<std::unique_ptr<JsonFileBuffer>> &contents) const {
+  Fnv1a hash;
+  for (const auto &content : contents) {
+    uint64_t len = content->sizeGet();
+    hash.update(&len, sizeof(len));
+    hash.update(content->dataGet(), content->sizeGet());
+  }
+  // The enums stored in the image come from the arch specific mapper
+  for (const auto &kv : tdi_info_mapper_->tableEnumMapGet()) {
+    hash.update(kv.first);
+    hash.update(&kv.second, sizeof(kv.second));
+  }
+  for (const auto &kv : tdi_info_mapper_->matchEnumMapGet()) {
+    hash.update(kv.first);
+    hash.update(&kv.second, sizeof(kv.second));
+  }
+  for (const auto &kv : tdi_info_mapper_->operationsEnumMapGet()) {
+    hash.update(kv.first);
+    hash.update(&kv.second, sizeof(kv.second));
+  }
+  for (const auto &kv : tdi_info_mapper_->attributesEnumMapGet()) {
+    hash.update(kv.first);
+    hash.update(&kv.second, sizeof(kv.second));
+  }
+  return hash.get();
+}
+
+tdi_status_t TdiInfoParser::schemaHashCompute(
+    const std::vector<std::string> &tdi_info_file_paths,
+    uint64_t *schema_hash) const {
+  if (!schema_hash) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  std::vector<std::unique_ptr<JsonFileBuffer>> contents;
+  for (const auto &path : tdi_info_file_paths) {
+    std::unique_ptr<JsonFileBuffer> content(new JsonFileBuffer());
+    if (content->load(path) != TDI_SUCCESS) {
+      LOG_ERROR("%s:%d Unable to read TDI Json File %s",
+                __func__,
+                __LINE__,
+                path.c_str());
+      return TDI_OBJECT_NOT_FOUND;
+    }
+    contents.push_back(std::move(content));
+  }
+  *schema_hash = schemaHashGet(contents);
+  return TDI_SUCCESS;
+}
+
+bool TdiInfoParser::tableInfoEqual(const TableInfo &a, const TableInfo &b) {
+  Writer wa, wb;
+  TdiInfoCacheCodec::writeTable(wa, a);
+  TdiInfoCacheCodec::writeTable(wb, b);
+  return wa.bufGet() == wb.bufGet();
+}
+
+bool TdiInfoParser::learnInfoEqual(const LearnInfo &a, const LearnInfo &b) {
+  Writer wa, wb;
+  TdiInfoCacheCodec::writeLearn(wa, a);
+  TdiInfoCacheCodec::writeLearn(wb, b);
+  return wa.bufGet() == wb.bufGet();
+}
+
+std::string TdiInfoParser::schemaCachePathGet(
+    const uint64_t &schema_hash) const {
+  char name[64];
+  std::snprintf(name,
+                sizeof(name),
+                "tdi_schema_%016llx.bin",
+                static_cast<unsigned long long>(schema_hash));
+  return schema_cache_dir_ + "/" + name;
+}
+
+tdi_status_t TdiInfoParser::schemaCacheWrite(
+    const std::string &path, const uint64_t &schema_hash) const {
+  Writer payload;
+  payload.u32(static_cast<uint32_t>(table_info_map_.size()));
+  for (const auto &kv : table_info_map_) {
+    // parseTable can leave a null entry for an invalid table
+    payload.str(kv.first);
+    payload.u8(kv.second != nullptr);
+    if (kv.second) TdiInfoCacheCodec::writeTable(payload, *kv.second);
+  }
+  payload.u32(static_cast<uint32_t>(learn_info_map_.size()));
+  for (const auto &kv : learn_info_map_) {
+    payload.str(kv.first);
+    payload.u8(kv.second != nullptr);
+    if (kv.second) TdiInfoCacheCodec::writeLearn(payload, *kv.second);
+  }
+  const auto &body = payload.bufGet();
+  Fnv1a checksum;
+  checksum.update(body.data(), body.size());
+
+  Writer header;
+  header.u32(kSchemaCacheVersion);
+  header.u64(schema_hash);
+  header.u64(body.size());
+  header.u64(checksum.get());
+
+  // Write to a temporary file and rename it so that concurrent starts never
+  // see a partial image
+  std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (file.fail()) return TDI_UNEXPECTED;
+    file.write(kSchemaCacheMagic, sizeof(kSchemaCacheMagic));
+    file.write(reinterpret_cast<const char *>(header.bufGet().data()),
+               header.bufGet().size());
+    file.write(reinterpret_cast<const char *>(body.data()), body.size());
+    if (!file.good()) {
+      file.close();
+      std::remove(tmp_path.c_str());
+      return TDI_UNEXPECTED;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return TDI_UNEXPECTED;
+  }
+  LOG_DBG("%s:%d Wrote TDI schema cache %s", __func__, __LINE__, path.c_str());
+  return TDI_SUCCESS;
+}
+
+tdi_status_t TdiInfoParser::schemaCacheRead(const std::string &path,
+                                            const uint64_t &schema_hash) {
+  // Map the image, the decoded objects copy what they keep out of it. The
+  // image is only ever replaced with rename(), never rewritten in place
+  JsonFileBuffer file;
+  auto status = file.load(path);
+  if (status != TDI_SUCCESS) return status;
+  const uint8_t *image = reinterpret_cast<const uint8_t *>(file.dataGet());
+  const size_t image_size = file.sizeGet();
+  if (image_size < kSchemaCacheHeaderSize ||
+      std::memcmp(image, kSchemaCacheMagic, sizeof(kSchemaCacheMagic))) {
+    LOG_WARN("%s:%d %s is not a TDI schema cache", __func__, __LINE__,
+             path.c_str());
+    return TDI_INVALID_ARG;
+  }
+  Reader header(image + sizeof(kSchemaCacheMagic),
+                kSchemaCacheHeaderSize - sizeof(kSchemaCacheMagic),
+                *string_pool_);
+  auto version = header.u32();
+  auto hash = header.u64();
+  auto body_size = header.u64();
+  auto body_checksum = header.u64();
+  const uint8_t *body = image + kSchemaCacheHeaderSize;
+  if (version != kSchemaCacheVersion || hash != schema_hash ||
+      body_size != image_size - kSchemaCacheHeaderSize) {
+    LOG_DBG("%s:%d Ignoring stale TDI schema cache %s",
+            __func__,
+            __LINE__,
+            path.c_str());
+    return TDI_INVALID_ARG;
+  }
+  Fnv1a checksum;
+  checksum.update(body, body_size);
+  if (checksum.get() != body_checksum) {
+    LOG_WARN("%s:%d Ignoring corrupt TDI schema cache %s",
+             __func__,
+             __LINE__,
+             path.c_str());
+    return TDI_INVALID_ARG;
+  }
+
+  // Decode into local maps, only replacing the parser's on success
+  Reader r(body, body_size, *string_pool_);
+  std::map<std::string, std::unique_ptr<TableInfo>> table_info_map;
+  std::map<std::string, std::unique_ptr<LearnInfo>> learn_info_map;
+  uint32_t n = r.count();
+  for (uint32_t i = 0; i < n && r.okGet(); i++) {
+    auto name = r.str();
+    if (!r.b()) {
+      table_info_map[name] = nullptr;
+      continue;
+    }
+    auto table_info = TdiInfoCacheCodec::readTable(r);
+    if (!table_info) break;
+    table_info_map[name] = std::move(table_info);
+  }
+  n = r.count();
+  for (uint32_t i = 0; i < n && r.okGet(); i++) {
+    auto name = r.str();
+    if (!r.b()) {
+      learn_info_map[name] = nullptr;
+      continue;
+    }
+    auto learn_info = TdiInfoCacheCodec::readLearn(r);
+    if (!learn_info) break;
+    learn_info_map[name] = std::move(learn_info);
+  }
+  if (!r.okGet() || !r.atEnd() ||
+      table_info_map.size() + learn_info_map.size() == 0) {
+    LOG_WARN("%s:%d Ignoring malformed TDI schema cache %s",
+             __func__,
+             __LINE__,
+             path.c_str());
+    return TDI_INVALID_ARG;
+  }
+  table_info_map_ = std::move(table_info_map);
+  learn_info_map_ = std::move(learn_info_map);
+  LOG_DBG("%s:%d Loaded TDI schema cache %s", __func__, __LINE__, path.c_str());
+  return TDI_SUCCESS;
+}
+
+}  // namespace tdi
@@ -14,11 +14,16 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstdlib>
 #include <exception>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <regex>
+#include <thread>
+#include <utility>
 
 #include <tdi/common/tdi_info.hpp>
 #include <tdi/common/tdi_json_parser/tdi_info_parser.hpp>
@@ -65,9 +70,9 @@ tdi_field_data_type_e dataTypeStrToEnum(const std::string &type,
 // This function returns if a key field is a field slice or not
 bool checkIsFieldSlice(const tdi::Cjson &key_field) {
   tdi::Cjson key_annotations = key_field["annotations"];
-  for (const auto &annotation : key_annotations.getCjsonChildVec()) {
-    std::string annotation_name = (*annotation)["name"];
-    std::string annotation_value = (*annotation)["value"];
+  for (const auto &annotation : key_annotations.children()) {
+    std::string annotation_name = annotation["name"];
+    std::string annotation_value = annotation["value"];
     if ((annotation_name == "isFieldSlice") && (annotation_value == "true")) {
       return true;
     }
@@ -78,7 +83,30 @@ bool checkIsFieldSlice(const tdi::Cjson &key_field) {
 }  // anonymous namespace
 
 TdiInfoParser::TdiInfoParser(std::unique_ptr<TdiInfoMapper> tdi_info_mapper)
-    : tdi_info_mapper_(std::move(tdi_info_mapper)) {}
+    : tdi_info_mapper_(std::move(tdi_info_mapper)),
+      string_pool_(std::make_shared<StringPool>()) {
+  const char *cache_dir = std::getenv("TDI_SCHEMA_CACHE_DIR");
+  if (cache_dir) schema_cache_dir_ = cache_dir;
+  parse_threads_ = defaultParseThreadsGet();
+}
+
+size_t TdiInfoParser::defaultParseThreadsGet() {
+  const char *threads = std::getenv("TDI_PARSE_THREADS");
+  if (!threads || !*threads) return 1;
+  char *end = nullptr;
+  unsigned long num_threads = std::strtoul(threads, &end, 10);
+  if (*end) {
+    LOG_WARN("%s:%d Ignoring invalid TDI_PARSE_THREADS \"%s\"",
+             __func__,
+             __LINE__,
+             threads);
+    return 1;
+  }
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return num_threads;
+}
 
 tdi_table_type_e TdiInfoParser::tableTypeStrToEnum(const std::string &type) {
   if (tdi_info_mapper_->tableEnumMapGet().find(type) !=
@@ -158,8 +186,8 @@ void TdiInfoParser::parseFieldWidth(const tdi::Cjson &node,
     if (node["type"]["width"].exists()) {
         width = static_cast<unsigned int>(node["type"]["width"]);
     }
-    for (const auto &choice : node["type"]["choices"].getCjsonChildVec()) {
-      choices.push_back(static_cast<std::string>(*choice));
+    for (const auto &choice : node["type"]["choices"].children()) {
+      choices.push_back(static_cast<std::string>(choice));
     }
     // If string default value is listed populate it, else its empty
     if (node["type"]["default_value"].exists()) {
@@ -193,8 +221,8 @@ std::unique_ptr<KeyFieldInfo> TdiInfoParser::parseKeyField(
       matchTypeStrToEnum(table_key_cjson[tdi_json::TABLE_KEY_MATCH_TYPE]);
   tdi_field_data_type_e field_data_type;
   size_t width;
-  uint64_t default_value;
-  float default_fl_value;
+  uint64_t default_value = 0;
+  float default_fl_value = 0.0;
   std::string default_str_value;
   std::vector<std::string> choices;
   std::string data_type;
@@ -207,7 +235,8 @@ std::unique_ptr<KeyFieldInfo> TdiInfoParser::parseKeyField(
                   choices);
 
   // create key_field structure and fill it
-  auto tmp = new KeyFieldInfo(id,
+  auto tmp = new KeyFieldInfo(*string_pool_,
+                              id,
                               name,
                               width,
                               match_type,
@@ -241,10 +270,10 @@ std::unique_ptr<KeyFieldInfo> TdiInfoParser::parseKeyField(
 std::set<tdi::Annotation> TdiInfoParser::parseAnnotations(
     const tdi::Cjson &annotation_cjson) {
   std::set<tdi::Annotation> annotations;
-  for (const auto &annotation : annotation_cjson.getCjsonChildVec()) {
-    std::string annotation_name = (*annotation)["name"];
-    std::string annotation_value = (*annotation)["value"];
-    annotations.emplace(annotation_name, annotation_value);
+  for (const auto &annotation : annotation_cjson.children()) {
+    std::string annotation_name = annotation["name"];
+    std::string annotation_value = annotation["value"];
+    annotations.emplace(*string_pool_, annotation_name, annotation_value);
   }
   return annotations;
 }
@@ -267,8 +296,8 @@ std::unique_ptr<struct DataFieldInfo> TdiInfoParser::parseDataField(
   std::set<tdi_id_t> oneof_siblings;
   if (data_json["oneof"].exists()) {
     // Create a set of all the oneof members IDs
-    for (const auto &oneof_data : data_json["oneof"].getCjsonChildVec()) {
-      oneof_siblings.insert(static_cast<tdi_id_t>((*oneof_data)["id"]));
+    for (const auto &oneof_data : data_json["oneof"].children()) {
+      oneof_siblings.insert(static_cast<tdi_id_t>(oneof_data["id"]));
     }
     data_json = data_json["oneof"][oneof_index];
     // remove this field's ID from the siblings. One
@@ -282,8 +311,8 @@ std::unique_ptr<struct DataFieldInfo> TdiInfoParser::parseDataField(
   std::vector<std::string> choices;
   // Default value of the field. We currently only support listing upto 64 bits
   // of default value
-  uint64_t default_value;
-  float default_fl_value;
+  uint64_t default_value = 0;
+  float default_fl_value = 0.0;
   std::string default_str_value;
   parseFieldWidth(data_json,
                   field_data_type,
@@ -304,7 +333,8 @@ std::unique_ptr<struct DataFieldInfo> TdiInfoParser::parseDataField(
     container_valid = true;
   }
   std::unique_ptr<struct DataFieldInfo> data_field(
-      new struct DataFieldInfo(data_id,
+      new struct DataFieldInfo(*string_pool_,
+                               data_id,
                                data_name,
                                width,
                                field_data_type,
@@ -340,9 +370,9 @@ std::unique_ptr<ActionInfo> TdiInfoParser::parseAction(
 
   // get action profile data_json
   tdi::Cjson action_data_cjson = action_json["data"];
-  for (const auto &action_data : action_data_cjson.getCjsonChildVec()) {
+  for (const auto &action_data : action_data_cjson.children()) {
     uint64_t oneof_index = 0;
-    auto data_field = parseDataField(*action_data, oneof_index);
+    auto data_field = parseDataField(action_data, oneof_index);
     if (data_fields.find(data_field->idGet()) != data_fields.end()) {
       LOG_ERROR("%s:%d ID \"%u\" Exists for data ",
                 __func__,
@@ -373,8 +403,8 @@ std::unique_ptr<NotificationParamInfo> TdiInfoParser::parseNotificationParams(
       notification_param_json[tdi_json::TABLE_NOTIFICATIONS_REPEATED];
   tdi_field_data_type_e field_data_type;
   size_t width;
-  uint64_t default_value;
-  float default_fl_value;
+  uint64_t default_value = 0;
+  float default_fl_value = 0.0;
   std::string default_str_value;
   std::vector<std::string> choices;
   std::string data_type;
@@ -389,6 +419,7 @@ std::unique_ptr<NotificationParamInfo> TdiInfoParser::parseNotificationParams(
   // create notification_params structure and fill it
   std::unique_ptr<NotificationParamInfo> notification_params(
       new NotificationParamInfo(
+          *string_pool_,
           id,
           name,
           repeated,
@@ -418,9 +449,8 @@ std::unique_ptr<NotificationInfo> TdiInfoParser::parseNotificationInfo(
 
   tdi::Cjson registration_params_cjson =
       notification_json[tdi_json::TABLE_NOTIFICATIONS_REGISTRATION_PARAMS];
-  for (const auto &registration_data :
-       registration_params_cjson.getCjsonChildVec()) {
-    auto notification_param = parseNotificationParams(*registration_data);
+  for (const auto &registration_data : registration_params_cjson.children()) {
+    auto notification_param = parseNotificationParams(registration_data);
     if (registration_params_fields.find(notification_param->idGet()) !=
         registration_params_fields.end()) {
       LOG_ERROR("%s:%d ID \"%u\" Exists for registration params ",
@@ -439,8 +469,8 @@ std::unique_ptr<NotificationInfo> TdiInfoParser::parseNotificationInfo(
 
   tdi::Cjson callback_params_cjson =
       notification_json[tdi_json::TABLE_NOTIFICATIONS_CALLBACK_PARAMS];
-  for (const auto &callback_data : callback_params_cjson.getCjsonChildVec()) {
-    auto notification_param = parseNotificationParams(*callback_data);
+  for (const auto &callback_data : callback_params_cjson.children()) {
+    auto notification_param = parseNotificationParams(callback_data);
     if (callback_params_fields.find(notification_param->idGet()) !=
         callback_params_fields.end()) {
       LOG_ERROR("%s:%d ID \"%u\" Exists for callback params ",
@@ -471,9 +501,8 @@ std::unique_ptr<tdi::LearnInfo> TdiInfoParser::parseLearn(
 
   // parse each field
   int oneof_size = 1;
-  for (const auto &field :
-       learn_tdi[tdi_json::LEARN_FIELDS].getCjsonChildVec()) {
-    auto learn_field = parseDataField(*field, oneof_size);
+  for (const auto &field : learn_tdi[tdi_json::LEARN_FIELDS].children()) {
+    auto learn_field = parseDataField(field, oneof_size);
     if (learn_field == nullptr) {
       continue;
     }
@@ -540,8 +569,8 @@ std::unique_ptr<tdi::TableInfo> TdiInfoParser::parseTable(
   // getting key   //
   ///////////////////
   tdi::Cjson table_key_cjson = table_tdi[tdi_json::TABLE_KEY];
-  for (const auto &key : table_key_cjson.getCjsonChildVec()) {
-    std::unique_ptr<KeyFieldInfo> key_field = parseKeyField(*key);
+  for (const auto &key : table_key_cjson.children()) {
+    std::unique_ptr<KeyFieldInfo> key_field = parseKeyField(key);
     if (key_field == nullptr) {
       continue;
     }
@@ -562,15 +591,15 @@ std::unique_ptr<tdi::TableInfo> TdiInfoParser::parseTable(
   // getting data   //
   ////////////////////
   tdi::Cjson table_data_cjson = table_tdi[tdi_json::TABLE_DATA];
-  for (const auto &data_json : table_data_cjson.getCjsonChildVec()) {
+  for (const auto &data_json : table_data_cjson.children()) {
     std::string data_name;
     int oneof_size = 1;
-    if ((*data_json)["oneof"].exists()) {
-      oneof_size = (*data_json)["oneof"].array_size();
+    if (data_json["oneof"].exists()) {
+      oneof_size = data_json["oneof"].array_size();
     }
     tdi::Cjson temp;
     for (int oneof_loop = 0; oneof_loop < oneof_size; oneof_loop++) {
-      auto data_field = parseDataField(*data_json, oneof_loop);
+      auto data_field = parseDataField(data_json, oneof_loop);
       tdi_id_t data_field_id = data_field->idGet();
       if (table_data_map.find(data_field_id) != table_data_map.end()) {
         LOG_ERROR("%s:%d Id \"%u\" Exists for common data of table %s",
@@ -589,34 +618,32 @@ std::unique_ptr<tdi::TableInfo> TdiInfoParser::parseTable(
   // getting depends on //
   ////////////////////////
   tdi::Cjson depends_on_cjson = table_tdi[tdi_json::TABLE_DEPENDS_ON];
-  for (const auto &tbl_id : depends_on_cjson.getCjsonChildVec()) {
-    depends_on_set.insert(*tbl_id);
+  for (const auto &tbl_id : depends_on_cjson.children()) {
+    depends_on_set.insert(tbl_id);
   }
 
   ////////////////////////
   // getting operations //
   ////////////////////////
-  std::vector<std::string> operations_v =
-      table_tdi["supported_operations"].getCjsonChildStringVec();
-  for (auto const &item : operations_v) {
-    operations_type_set.insert(operationsTypeStrToEnum(item));
+  for (const auto &item : table_tdi["supported_operations"].children()) {
+    operations_type_set.insert(
+        operationsTypeStrToEnum(static_cast<std::string>(item)));
   }
 
   ////////////////////////
   // getting attributes //
   ////////////////////////
-  std::vector<std::string> attributes_v =
-      table_tdi["attributes"].getCjsonChildStringVec();
-  for (auto const &item : attributes_v) {
-    attributes_type_set.insert(attributesTypeStrToEnum(item));
+  for (const auto &item : table_tdi["attributes"].children()) {
+    attributes_type_set.insert(
+        attributesTypeStrToEnum(static_cast<std::string>(item)));
   }
 
   ////////////////////
   // getting action //
   ////////////////////
   tdi::Cjson table_action_spec_cjson = table_tdi[tdi_json::TABLE_ACTION_SPECS];
-  for (const auto &action : table_action_spec_cjson.getCjsonChildVec()) {
-    auto action_info = parseAction(*action);
+  for (const auto &action : table_action_spec_cjson.children()) {
+    auto action_info = parseAction(action);
     auto elem = table_action_map.find(action_info->idGet());
     if (elem == table_action_map.end()) {
       table_action_map[action_info->idGet()] = (std::move(action_info));
@@ -634,8 +661,8 @@ std::unique_ptr<tdi::TableInfo> TdiInfoParser::parseTable(
   // getting notifications //
   ///////////////////////////
   tdi::Cjson table_notifications_cjson = table_tdi[tdi_json::TABLE_NOTIFICATIONS];
-  for (const auto &notifications : table_notifications_cjson.getCjsonChildVec()) {
-    auto notification_info = parseNotificationInfo(*notifications);
+  for (const auto &notifications : table_notifications_cjson.children()) {
+    auto notification_info = parseNotificationInfo(notifications);
     auto elem = table_notifications_map.find(notification_info->idGet());
     if (elem == table_notifications_map.end()) {
       table_notifications_map[notification_info->idGet()] = (std::move(notification_info));
@@ -684,30 +711,187 @@ tdi_status_t TdiInfoParser::parseTdiInfo(
     LOG_CRIT("Unable to find any TDI Json Schema File");
     return TDI_OBJECT_NOT_FOUND;
   }
+  // The files are mmapped rather than copied into strings. Each mapping is
+  // dropped as soon as cJSON has parsed it
+  std::vector<std::unique_ptr<JsonFileBuffer>> contents;
   for (auto const &tdiJsonFile : tdi_info_file_paths) {
-    std::ifstream file(tdiJsonFile);
-    if (file.fail()) {
+    std::unique_ptr<JsonFileBuffer> content(new JsonFileBuffer());
+    if (content->load(tdiJsonFile) != TDI_SUCCESS) {
       LOG_CRIT("Unable to find TDI Json File %s", tdiJsonFile.c_str());
       return TDI_OBJECT_NOT_FOUND;
     }
-    std::string content((std::istreambuf_iterator<char>(file)),
-                        std::istreambuf_iterator<char>());
-    tdi::Cjson root_cjson = tdi::Cjson::createCjsonFromFile(content);
+    contents.push_back(std::move(content));
+  }
+
+  loaded_from_cache_ = false;
+  uint64_t schema_hash = 0;
+  std::string cache_path;
+  if (!schema_cache_dir_.empty()) {
+    schema_hash = schemaHashGet(contents);
+    cache_path = schemaCachePathGet(schema_hash);
+    if (schemaCacheRead(cache_path, schema_hash) == TDI_SUCCESS) {
+      loaded_from_cache_ = true;
+      for (const auto &kv : table_info_map_) {
+        if (kv.second) table_id_index_[kv.first] = kv.second->idGet();
+      }
+      return TDI_SUCCESS;
+    }
+  }
+
+  // In parallel mode every table and learn is parsed by its own task. The
+  // json text itself is parsed serially since cJSON keeps its error state
+  // in a global. Results are merged in file order so that later files
+  // override earlier ones as in a serial parse
+  std::unique_ptr<TdiThreadPool> pool;
+  if (parse_threads_ > 1 && !lazy_parse_) {
+    pool.reset(new TdiThreadPool(parse_threads_));
+  }
+  std::vector<std::pair<std::string, std::future<std::unique_ptr<TableInfo>>>>
+      table_tasks;
+  std::vector<std::pair<std::string, std::future<std::unique_ptr<LearnInfo>>>>
+      learn_tasks;
+  auto parse_table = [this](const tdi::Cjson &table) {
+    return this->parseTable(table);
+  };
+  auto parse_learn = [this](const tdi::Cjson &learn) {
+    return this->parseLearn(learn);
+  };
+
+  for (size_t i = 0; i < contents.size(); i++) {
+    tdi::Cjson root_cjson =
+        tdi::Cjson::createCjsonFromBuffer(contents[i]->dataGet());
+    contents[i]->reset();
+    if (!root_cjson.exists()) {
+      LOG_CRIT("Unable to parse TDI Json File %s",
+               tdi_info_file_paths[i].c_str());
+      return TDI_INVALID_ARG;
+    }
     tdi::Cjson tables_cjson = root_cjson[tdi_json::TABLES];
-    for (const auto &table : tables_cjson.getCjsonChildVec()) {
+    for (const auto &table : tables_cjson.children()) {
       // B. parse file to form tdi_table_info object
       std::string table_name =
-          static_cast<std::string>((*table)[tdi_json::TABLE_NAME]);
-      table_info_map_[table_name] = this->parseTable(*table);
+          static_cast<std::string>(table[tdi_json::TABLE_NAME]);
+      tdi_id_t table_id = table[tdi_json::TABLE_ID];
+      table_id_index_[table_name] = table_id;
+      if (lazy_parse_) {
+        // Only the text is kept, the DOM of the file is freed below
+        pending_tables_[table_name] = table.printUnformatted();
+      } else if (pool) {
+        table_tasks.emplace_back(table_name,
+                                 pool->submitTask(parse_table, table));
+      } else {
+        table_info_map_[table_name] = this->parseTable(table);
+      }
     }
 
     tdi::Cjson learns_cjson = root_cjson[tdi_json::LEARN_FILTERS];
-    for (const auto &learn : learns_cjson.getCjsonChildVec()) {
+    for (const auto &learn : learns_cjson.children()) {
       // C. parse file to form tdi_learn_info object
-      std::string learn_name = static_cast<std::string>((*learn)["name"]);
-      learn_info_map_[learn_name] = this->parseLearn(*learn);
+      std::string learn_name = static_cast<std::string>(learn["name"]);
+      if (pool) {
+        learn_tasks.emplace_back(learn_name,
+                                 pool->submitTask(parse_learn, learn));
+      } else {
+        learn_info_map_[learn_name] = this->parseLearn(learn);
+      }
+    }
+  }
+  for (auto &task : table_tasks) {
+    table_info_map_[task.first] = task.second.get();
+  }
+  for (auto &task : learn_tasks) {
+    learn_info_map_[task.first] = task.second.get();
+  }
+
+  // A failure to write the cache only costs the next start a full parse
+  if (!cache_path.empty() && !lazy_parse_ &&
+      schemaCacheWrite(cache_path, schema_hash) != TDI_SUCCESS) {
+    LOG_WARN("%s:%d Unable to write TDI schema cache %s",
+             __func__,
+             __LINE__,
+             cache_path.c_str());
+  }
+  return TDI_SUCCESS;
+}
+
+tdi_status_t TdiInfoParser::tableInfoBuild(const std::string &name,
+                                          const TableInfo **table_info) {
+  if (!table_info) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  auto it = table_info_map_.find(name);
+  if (it == table_info_map_.end()) {
+    auto pending_it = pending_tables_.find(name);
+    if (pending_it == pending_tables_.end()) {
+      LOG_ERROR("%s:%d Table \"%s\" not found",
+                __func__,
+                __LINE__,
+                name.c_str());
+      return TDI_OBJECT_NOT_FOUND;
     }
+    LOG_DBG("%s:%d Building table %s", __func__, __LINE__, name.c_str());
+    tdi::Cjson table_cjson =
+        tdi::Cjson::createCjsonFromBuffer(pending_it->second.c_str());
+    pending_tables_.erase(pending_it);
+    it = table_info_map_
+             .emplace(name,
+                      table_cjson.exists() ? this->parseTable(table_cjson)
+                                           : nullptr)
+             .first;
+  }
+  if (!it->second) {
+    LOG_ERROR("%s:%d Table \"%s\" failed to parse",
+              __func__,
+              __LINE__,
+              name.c_str());
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  *table_info = it->second.get();
+  return TDI_SUCCESS;
+}
+
+tdi_status_t TdiInfoParser::tableInfoSwap(TdiInfoParser *other,
+                                          const std::string &name) {
+  if (!other || other->string_pool_ != string_pool_) {
+    LOG_ERROR("%s:%d Parsers do not share a string pool",
+              __func__,
+              __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  auto it = table_info_map_.find(name);
+  auto other_it = other->table_info_map_.find(name);
+  if (it == table_info_map_.end() || !it->second ||
+      other_it == other->table_info_map_.end() || !other_it->second) {
+    LOG_ERROR("%s:%d Table \"%s\" not built by both parsers",
+              __func__,
+              __LINE__,
+              name.c_str());
+    return TDI_OBJECT_NOT_FOUND;
+  }
+  it->second.swap(other_it->second);
+  return TDI_SUCCESS;
+}
+
+tdi_status_t TdiInfoParser::learnInfoSwap(TdiInfoParser *other,
+                                          const std::string &name) {
+  if (!other || other->string_pool_ != string_pool_) {
+    LOG_ERROR("%s:%d Parsers do not share a string pool",
+              __func__,
+              __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  auto it = learn_info_map_.find(name);
+  auto other_it = other->learn_info_map_.find(name);
+  if (it == learn_info_map_.end() || !it->second ||
+      other_it == other->learn_info_map_.end() || !other_it->second) {
+    LOG_ERROR("%s:%d Learn \"%s\" not built by both parsers",
+              __func__,
+              __LINE__,
+              name.c_str());
+    return TDI_OBJECT_NOT_FOUND;
   }
+  it->second.swap(other_it->second);
   return TDI_SUCCESS;
 }
 
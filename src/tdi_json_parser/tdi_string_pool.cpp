@@ -0,0 +1,80 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <tdi/common/tdi_json_parser/tdi_string_pool.hpp>
+
+namespace tdi {
+
+const std::string &StringPool::intern(const std::string &str) {
+  auto &stripe = stripes_[std::hash<std::string>()(str) % kStripes];
+  std::lock_guard<std::mutex> lock(stripe.mtx);
+  auto it = stripe.strings.insert(str);
+  if (it.second) {
+    // Node of the hash set and its bucket pointer
+    stripe.bytes += sizeof(std::string) + 2 * sizeof(void *) +
+                    stringHeapBytes(*it.first);
+  }
+  return *it.first;
+}
+
+const std::vector<std::string> &StringPool::intern(
+    const std::vector<std::string> &strs) {
+  size_t hash = strs.size();
+  for (const auto &str : strs) {
+    hash = hash * 31 + std::hash<std::string>()(str);
+  }
+  auto &stripe = stripes_[hash % kStripes];
+  std::lock_guard<std::mutex> lock(stripe.mtx);
+  auto it = stripe.string_lists.insert(strs);
+  if (it.second) {
+    // Node of the tree
+    stripe.bytes += sizeof(std::vector<std::string>) + 4 * sizeof(void *) +
+                    strs.size() * sizeof(std::string);
+    for (const auto &str : strs) stripe.bytes += stringHeapBytes(str);
+  }
+  return *it.first;
+}
+
+size_t StringPool::sizeGet() const {
+  size_t size = 0;
+  for (auto &stripe : stripes_) {
+    std::lock_guard<std::mutex> lock(stripe.mtx);
+    size += stripe.strings.size() + stripe.string_lists.size();
+  }
+  return size;
+}
+
+size_t StringPool::bytesGet() const {
+  size_t bytes = 0;
+  for (auto &stripe : stripes_) {
+    std::lock_guard<std::mutex> lock(stripe.mtx);
+    bytes += stripe.bytes + stripe.strings.bucket_count() * sizeof(void *);
+  }
+  return bytes;
+}
+
+StringPool &StringPool::defaultGet() {
+  // Never destroyed, annotations may outlive static destruction
+  static StringPool *pool = new StringPool();
+  return *pool;
+}
+
+}  // namespace tdi
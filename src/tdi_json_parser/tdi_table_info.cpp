@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <exception>
 #include <fstream>
 #include <iostream>
@@ -28,19 +29,92 @@
 namespace tdi {
 
 bool Annotation::operator<(const Annotation &other) const {
-  return (this->full_name_ < other.full_name_);
+  return (this->full_name_ != other.full_name_) &&
+         (*this->full_name_ < *other.full_name_);
 }
 bool Annotation::operator==(const Annotation &other) const {
-  return (this->full_name_ == other.full_name_);
+  // Annotations interned in the same pool are equal iff their names are
+  // the same object
+  return (this->full_name_ == other.full_name_) ||
+         (*this->full_name_ == *other.full_name_);
 }
 bool Annotation::operator==(const std::string &other_str) const {
-  return (this->full_name_ == other_str);
+  return (*this->full_name_ == other_str);
 }
 tdi_status_t Annotation::fullNameGet(std::string *full_name) const {
-  *full_name = full_name_;
+  *full_name = *full_name_;
   return TDI_SUCCESS;
 }
 
+const DataFieldInfo::Extras &DataFieldInfo::noExtrasGet() {
+  static const Extras no_extras;
+  return no_extras;
+}
+
+std::vector<tdi_id_t> DataFieldInfo::containerDataFieldIdListGet() const {
+  std::vector<tdi_id_t> id_vec;
+  for (const auto &kv : extrasGet().container_) {
+    id_vec.push_back(kv.first);
+  }
+  return id_vec;
+}
+
+void TableInfo::dataFieldIndexBuild() {
+  // Common fields first, in ordinal order, then the IDs only found in
+  // actions
+  std::map<tdi_id_t, uint32_t> index_by_id;
+  auto index_assign = [this, &index_by_id](DataFieldInfo *field) {
+    auto it = index_by_id.find(field->idGet());
+    if (it == index_by_id.end()) {
+      it = index_by_id
+               .emplace(field->idGet(),
+                        static_cast<uint32_t>(data_field_index_ids_.size()))
+               .first;
+      data_field_index_ids_.push_back(field->idGet());
+    }
+    field->index_ = it->second;
+  };
+  for (const auto &kv : table_data_map_) {
+    index_assign(kv.second.get());
+  }
+  for (const auto &kv : table_action_map_) {
+    for (const auto &field_kv : kv.second->data_fields_) {
+      index_assign(field_kv.second.get());
+    }
+  }
+
+  // Map IDs directly as long as the array stays small compared to the
+  // number of fields, action parameters are numbered from 1
+  const tdi_id_t direct_limit = std::max<tdi_id_t>(
+      64, 4 * static_cast<tdi_id_t>(data_field_index_ids_.size()));
+  tdi_id_t direct_size = 0;
+  for (const auto &kv : index_by_id) {
+    if (kv.first < direct_limit) {
+      direct_size = kv.first + 1;
+    } else {
+      data_field_index_sparse_.push_back(kv);
+    }
+  }
+  data_field_index_by_id_.assign(direct_size, UINT32_MAX);
+  for (const auto &kv : index_by_id) {
+    if (kv.first < direct_size) data_field_index_by_id_[kv.first] = kv.second;
+  }
+}
+
+uint32_t TableInfo::dataFieldIndexSparseGet(const tdi_id_t &field_id) const {
+  auto it = std::lower_bound(
+      data_field_index_sparse_.begin(),
+      data_field_index_sparse_.end(),
+      field_id,
+      [](const std::pair<tdi_id_t, uint32_t> &kv, const tdi_id_t &id) {
+        return kv.first < id;
+      });
+  if (it == data_field_index_sparse_.end() || it->first != field_id) {
+    return UINT32_MAX;
+  }
+  return it->second;
+}
+
 std::vector<tdi_id_t> TableInfo::keyFieldIdListGet() const {
   std::vector<tdi_id_t> id_vec;
   for (const auto &kv : table_key_map_) {
@@ -51,19 +125,27 @@ std::vector<tdi_id_t> TableInfo::keyFieldIdListGet() const {
 }
 
 const KeyFieldInfo *TableInfo::keyFieldGet(const std::string &name) const {
-  if (name_key_map_.find(name) == name_key_map_.end()) {
-    LOG_WARN("%s:%d %s Field \"%s\" not found in key field list",
+  return keyFieldGet(name.data(), name.size());
+}
+
+const KeyFieldInfo *TableInfo::keyFieldGet(const char *name,
+                                           const size_t &len) const {
+  auto key_field = key_name_index_.find(name, len);
+  if (!key_field) {
+    LOG_WARN("%s:%d %s Field \"%.*s\" not found in key field list",
               __func__,
               __LINE__,
               nameGet().c_str(),
-              name.c_str());
+              static_cast<int>(len),
+              name);
     return nullptr;
   }
-  return name_key_map_.at(name);
+  return key_field;
 }
 
 const KeyFieldInfo *TableInfo::keyFieldGet(const tdi_id_t &field_id) const {
-  if (table_key_map_.find(field_id) == table_key_map_.end()) {
+  auto it = table_key_map_.find(field_id);
+  if (it == table_key_map_.end()) {
     LOG_WARN("%s:%d %s Field \"%d\" not found in key field list",
               __func__,
               __LINE__,
@@ -71,7 +153,7 @@ const KeyFieldInfo *TableInfo::keyFieldGet(const tdi_id_t &field_id) const {
               field_id);
     return nullptr;
   }
-  return table_key_map_.at(field_id).get();
+  return it->second.get();
 }
 
 std::vector<tdi_id_t> TableInfo::dataFieldIdListGet(
@@ -117,22 +199,32 @@ tdi_id_t TableInfo::dataFieldIdGet(const std::string &name,
 
 const DataFieldInfo *TableInfo::dataFieldGet(const std::string &name,
                                              const tdi_id_t &action_id) const {
-  if (action_id &&
-      table_action_map_.find(action_id) != table_action_map_.end()) {
-    auto action_info = table_action_map_.at(action_id).get();
-    if (action_info->data_fields_names_.find(name) !=
-        action_info->data_fields_names_.end()) {
-      return action_info->data_fields_names_.at(name);
+  return dataFieldGet(name.data(), name.size(), action_id);
+}
+
+const DataFieldInfo *TableInfo::dataFieldGet(const char *name,
+                                             const size_t &len,
+                                             const tdi_id_t &action_id) const {
+  if (action_id) {
+    auto action_it = table_action_map_.find(action_id);
+    if (action_it != table_action_map_.end()) {
+      auto data_field =
+          action_it->second->data_fields_name_index_.find(name, len);
+      if (data_field) {
+        return data_field;
+      }
     }
   }
-  if (name_data_map_.find(name) != name_data_map_.end()) {
-    return name_data_map_.at(name);
+  auto data_field = data_name_index_.find(name, len);
+  if (data_field) {
+    return data_field;
   }
-  LOG_WARN("%s:%d %s Field \"%s\" not found in data field list",
+  LOG_WARN("%s:%d %s Field \"%.*s\" not found in data field list",
             __func__,
             __LINE__,
             nameGet().c_str(),
-            name.c_str());
+            static_cast<int>(len),
+            name);
   return nullptr;
 }
 
@@ -142,16 +234,19 @@ const DataFieldInfo *TableInfo::dataFieldGet(const std::string &name) const {
 
 const DataFieldInfo *TableInfo::dataFieldGet(const tdi_id_t &field_id,
                                              const tdi_id_t &action_id) const {
-  if (action_id &&
-      table_action_map_.find(action_id) != table_action_map_.end()) {
-    auto action_info = table_action_map_.at(action_id).get();
-    if (action_info->data_fields_.find(field_id) !=
-        action_info->data_fields_.end()) {
-      return action_info->data_fields_.at(field_id).get();
+  if (action_id) {
+    auto action_it = table_action_map_.find(action_id);
+    if (action_it != table_action_map_.end()) {
+      const auto &fields = action_it->second->data_fields_;
+      auto field_it = fields.find(field_id);
+      if (field_it != fields.end()) {
+        return field_it->second.get();
+      }
     }
   }
-  if (table_data_map_.find(field_id) != table_data_map_.end()) {
-    return table_data_map_.at(field_id).get();
+  auto it = table_data_map_.find(field_id);
+  if (it != table_data_map_.end()) {
+    return it->second.get();
   }
   LOG_WARN("%s:%d %s Field \"%d\" not found in data field list",
             __func__,
@@ -166,20 +261,28 @@ const DataFieldInfo *TableInfo::dataFieldGet(const tdi_id_t &field_id) const {
 }
 
 const ActionInfo *TableInfo::actionGet(const std::string &name) const {
-  if (name_action_map_.find(name) != name_action_map_.end()) {
-    return name_action_map_.at(name);
+  return actionGet(name.data(), name.size());
+}
+
+const ActionInfo *TableInfo::actionGet(const char *name,
+                                       const size_t &len) const {
+  auto action = action_name_index_.find(name, len);
+  if (action) {
+    return action;
   }
-  LOG_WARN("%s:%d %s Action  \"%s\" not found",
+  LOG_WARN("%s:%d %s Action  \"%.*s\" not found",
             __func__,
             __LINE__,
             nameGet().c_str(),
-            name.c_str());
+            static_cast<int>(len),
+            name);
   return nullptr;
 }
 
 const ActionInfo *TableInfo::actionGet(const tdi_id_t &action_id) const {
-  if (table_action_map_.find(action_id) != table_action_map_.end()) {
-    return table_action_map_.at(action_id).get();
+  auto it = table_action_map_.find(action_id);
+  if (it != table_action_map_.end()) {
+    return it->second.get();
   }
   LOG_WARN("%s:%d %s Action  \"%d\" not found",
             __func__,
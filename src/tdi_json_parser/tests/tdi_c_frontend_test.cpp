@@ -0,0 +1,84 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "tdi_test_session.hpp"
+#include "../../c_frontend/tdi_state_c.hpp"
+
+namespace tdi {
+namespace tdi_test {
+
+/**
+ * @brief Test the C frontend session state, with lookups racing with
+ * sessions being inserted and removed
+ */
+TEST(TdiCFrontEndSessionState, concurrentLookup) {
+  auto &c_state = tdi::tdi_c::TdiCFrontEndSessionState::getInstance();
+  std::shared_ptr<Session> stable(new TestSession());
+  c_state.insertShared(stable);
+  ASSERT_EQ(c_state.getSharedPtr(stable.get()), stable);
+  ASSERT_EQ(c_state.getSharedPtr(nullptr), nullptr);
+  TestSession unknown;
+  ASSERT_EQ(c_state.getSharedPtr(&unknown), nullptr);
+
+  std::atomic<bool> done(false);
+  std::atomic<int> failures(0);
+  std::vector<std::shared_ptr<Session>> churn;
+  for (int i = 0; i < 8; i++) churn.emplace_back(new TestSession());
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&]() {
+      size_t j = 0;
+      while (!done.load()) {
+        if (c_state.getSharedPtr(stable.get()) != stable) failures++;
+        auto &expected = churn[j++ % churn.size()];
+        auto session = c_state.getSharedPtr(expected.get());
+        if (session && session != expected) failures++;
+      }
+    });
+  }
+  for (int round = 0; round < 200; round++) {
+    for (const auto &session : churn) c_state.insertShared(session);
+    for (const auto &session : churn) {
+      if (c_state.getSharedPtr(session.get()) != session) failures++;
+    }
+    for (const auto &session : churn) c_state.removeShared(session.get());
+  }
+  done = true;
+  for (auto &reader : readers) reader.join();
+  ASSERT_EQ(failures.load(), 0);
+  for (const auto &session : churn) {
+    ASSERT_EQ(c_state.getSharedPtr(session.get()), nullptr);
+  }
+
+  // The state only drops its reference on remove
+  std::weak_ptr<Session> weak = stable;
+  c_state.insertShared(stable);
+  stable.reset();
+  ASSERT_FALSE(weak.expired());
+  c_state.removeShared(weak.lock().get());
+  ASSERT_TRUE(weak.expired());
+  c_state.removeShared(&unknown);
+}
+
+}  // namespace tdi_test
+}  // namespace tdi
@@ -0,0 +1,169 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <tdi/common/tdi_init.hpp>
+
+/* dummy object includes */
+#include <dummy/tdi_dummy_init.hpp>
+
+namespace tdi {
+namespace tdi_test {
+
+namespace {
+// Any program works, the devices only need to load
+const std::string kProgramName = "tna_exact_match";
+const std::string kJsonPath =
+    std::string(JSONDIR) + "/dummy/" + kProgramName + "/tdi.json";
+}  // anonymous namespace
+
+/**
+ * @brief Test DevMgr lookups racing with deviceAdd() and deviceRemove()
+ */
+TEST(DevMgr, concurrentLookup) {
+  auto &dev_mgr = DevMgr::getInstance();
+  const std::vector<ProgramConfig> config = {
+      ProgramConfig(kProgramName, {kJsonPath}, {})};
+  const tdi_dev_id_t stable_id = 100;
+  ASSERT_EQ(dev_mgr.deviceAdd<tdi::tna::dummy::Device>(
+                stable_id, TDI_ARCH_TYPE_TNA, config, nullptr, nullptr),
+            TDI_SUCCESS);
+  ASSERT_EQ(dev_mgr.deviceAdd<tdi::tna::dummy::Device>(
+                stable_id, TDI_ARCH_TYPE_TNA, config, nullptr, nullptr),
+            TDI_ALREADY_EXISTS);
+  const Device *stable = nullptr;
+  ASSERT_EQ(dev_mgr.deviceGet(stable_id, &stable), TDI_SUCCESS);
+
+  std::atomic<bool> done(false);
+  std::atomic<int> failures(0);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&]() {
+      while (!done.load()) {
+        const Device *device = nullptr;
+        if (dev_mgr.deviceGet(stable_id, &device) != TDI_SUCCESS ||
+            device != stable) {
+          failures++;
+        }
+        std::set<tdi_dev_id_t> ids;
+        dev_mgr.deviceIdListGet(&ids);
+        if (ids.find(stable_id) == ids.end()) failures++;
+      }
+    });
+  }
+  for (tdi_dev_id_t id = stable_id + 1; id < stable_id + 9; id++) {
+    ASSERT_EQ(dev_mgr.deviceAdd<tdi::tna::dummy::Device>(
+                  id, TDI_ARCH_TYPE_TNA, config, nullptr, nullptr),
+              TDI_SUCCESS);
+    const Device *device = nullptr;
+    ASSERT_EQ(dev_mgr.deviceGet(id, &device), TDI_SUCCESS);
+    ASSERT_EQ(dev_mgr.deviceRemove(id), TDI_SUCCESS);
+    ASSERT_EQ(dev_mgr.deviceGet(id, &device), TDI_OBJECT_NOT_FOUND);
+  }
+  done = true;
+  for (auto &reader : readers) reader.join();
+  ASSERT_EQ(failures.load(), 0);
+
+  ASSERT_EQ(dev_mgr.deviceRemove(stable_id), TDI_SUCCESS);
+  ASSERT_EQ(dev_mgr.deviceGet(stable_id, &stable), TDI_OBJECT_NOT_FOUND);
+}
+
+/**
+ * @brief Stress DevMgr lookups against several threads adding and removing
+ * devices. Every device found must still be alive and be the one looked up
+ */
+TEST(DevMgr, addRemoveStress) {
+  auto &dev_mgr = DevMgr::getInstance();
+  const std::vector<ProgramConfig> config = {
+      ProgramConfig(kProgramName, {kJsonPath}, {})};
+  // Keeps the TdiInfo in the registry so that adding a device is cheap
+  const tdi_dev_id_t first_id = 200;
+  ASSERT_EQ(dev_mgr.deviceAdd<tdi::tna::dummy::Device>(
+                first_id, TDI_ARCH_TYPE_TNA, config, nullptr, nullptr),
+            TDI_SUCCESS);
+
+  const int kWriters = 3;
+  const int kIdsPerWriter = 4;
+  std::atomic<bool> done(false);
+  std::atomic<int> failures(0);
+  std::atomic<uint64_t> found(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&]() {
+      tdi_dev_id_t id = first_id;
+      while (!done.load()) {
+        id = first_id + (id - first_id + 1) % (kWriters * kIdsPerWriter + 1);
+        std::shared_ptr<const Device> device;
+        if (dev_mgr.deviceGet(id, &device) == TDI_SUCCESS) {
+          const std::vector<ProgramConfig> *device_config = nullptr;
+          if (!device || device->deviceConfigGet(&device_config) !=
+                             TDI_SUCCESS ||
+              device_config->size() != 1 ||
+              device_config->at(0).prog_name_ != kProgramName) {
+            failures++;
+          }
+          found++;
+        }
+        std::set<tdi_dev_id_t> ids;
+        dev_mgr.deviceIdListGet(&ids);
+        if (ids.find(first_id) == ids.end()) failures++;
+      }
+    });
+  }
+  for (int i = 0; i < kWriters; i++) {
+    threads.emplace_back([&, i]() {
+      for (int round = 0; round < 50; round++) {
+        for (int j = 1; j <= kIdsPerWriter; j++) {
+          tdi_dev_id_t id = first_id + i * kIdsPerWriter + j;
+          if (dev_mgr.deviceAdd<tdi::tna::dummy::Device>(
+                  id, TDI_ARCH_TYPE_TNA, config, nullptr, nullptr) !=
+              TDI_SUCCESS) {
+            failures++;
+          }
+        }
+        for (int j = 1; j <= kIdsPerWriter; j++) {
+          dev_mgr.deviceRemove(first_id + i * kIdsPerWriter + j);
+        }
+      }
+    });
+  }
+  for (int i = 4; i < 4 + kWriters; i++) threads[i].join();
+  done = true;
+  for (int i = 0; i < 4; i++) threads[i].join();
+  ASSERT_EQ(failures.load(), 0);
+  ASSERT_GT(found.load(), 0u);
+
+  std::set<tdi_dev_id_t> ids;
+  ASSERT_EQ(dev_mgr.deviceIdListGet(&ids), TDI_SUCCESS);
+  ASSERT_EQ(ids.count(first_id), 1u);
+  for (tdi_dev_id_t id = first_id + 1;
+       id <= first_id + kWriters * kIdsPerWriter;
+       id++) {
+    ASSERT_EQ(ids.count(id), 0u);
+  }
+  ASSERT_EQ(dev_mgr.deviceRemove(first_id), TDI_SUCCESS);
+}
+
+}  // namespace tdi_test
+}  // namespace tdi
@@ -25,14 +25,29 @@
 #include <string>
 #include <tuple>
 #include <vector>
+#include <algorithm>
 #include <cstring>  // std::memcmp
+#include <map>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <unistd.h>
 
 #include <tdi/common/tdi_defs.h>
 #include <tdi/common/tdi_json_parser/tdi_info_parser.hpp>
 #include <tdi/common/tdi_info.hpp>
 #include <tdi/common/tdi_table.hpp>
+#include <tdi/common/c_frontend/tdi_table.h>
 
 #include "tdi_info_test.hpp"
+#include "tdi_test_session.hpp"
+#ifdef TDI_CODEGEN_TEST
+#include "tdi_json_utest_gen.hpp"
+#endif
 
 // using ::testing::WithParamInterface;
 namespace tdi {
@@ -66,6 +81,273 @@ TEST_P(TnaPort, TestTablesGet) {
   ASSERT_EQ(table_vec.size(), 2);
 }
 
+/**
+ * @brief Test Cjson::children() against indexed access
+ */
+TEST_P(TnaExactMatchInfo, cjsonChildren) {
+  Cjson tables = (*tdi_root_cjson)["tables"];
+  int i = 0;
+  for (const auto &table : tables.children()) {
+    ASSERT_EQ(static_cast<std::string>(table["name"]),
+              static_cast<std::string>(tables[i]["name"]));
+    i++;
+  }
+  ASSERT_EQ(i, static_cast<int>(tables.array_size()));
+  // Range over a temporary and over a missing node
+  ASSERT_EQ(std::distance((*tdi_root_cjson)["tables"].children().begin(),
+                          (*tdi_root_cjson)["tables"].children().end()),
+            i);
+  for (const auto &child : (*tdi_root_cjson)["no_such_key"].children()) {
+    FAIL() << static_cast<std::string>(child);
+  }
+}
+
+/**
+ * @brief Test that JsonFileBuffer returns the file contents, both when
+ * mapped and when the size forces a buffered read
+ */
+TEST_P(TnaExactMatchInfo, jsonFileBuffer) {
+  std::string json_path = std::string(JSONDIR) + "/" + target_name + "/" +
+                          program_name + "/" + std::get<0>(GetParam());
+  std::string content = getTestJsonFileContent(std::get<0>(GetParam()),
+                                               program_name);
+  ASSERT_FALSE(content.empty());
+  JsonFileBuffer buffer;
+  ASSERT_EQ(buffer.load(json_path), TDI_SUCCESS);
+  ASSERT_EQ(buffer.sizeGet(), content.size());
+  ASSERT_EQ(std::string(buffer.dataGet()), content);
+
+  // Appending to a mapped file doesn't move the end of the text
+  char path[] = "/tmp/tdi_json_buffer_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  ASSERT_NE(content.size() % page_size, 0u);
+  ASSERT_EQ(write(fd, content.data(), content.size()),
+            static_cast<ssize_t>(content.size()));
+  ASSERT_EQ(buffer.load(path), TDI_SUCCESS);
+  ASSERT_TRUE(buffer.isMapped());
+  ASSERT_EQ(write(fd, "garbage", 7), 7);
+  ASSERT_EQ(std::string(buffer.dataGet()), content);
+  ASSERT_EQ(ftruncate(fd, 0), 0);
+  buffer.reset();
+
+  // Pad the file with whitespace to a whole number of pages
+  content.resize((content.size() / page_size + 1) * page_size, ' ');
+  ASSERT_EQ(pwrite(fd, content.data(), content.size(), 0),
+            static_cast<ssize_t>(content.size()));
+  close(fd);
+  ASSERT_EQ(buffer.load(path), TDI_SUCCESS);
+  ASSERT_FALSE(buffer.isMapped());
+  ASSERT_EQ(std::string(buffer.dataGet()), content);
+  Cjson root = Cjson::createCjsonFromBuffer(buffer.dataGet());
+  buffer.reset();
+  ASSERT_EQ(root["tables"].array_size(), 3u);
+  std::remove(path);
+
+  ASSERT_EQ(buffer.load("/no/such/file.json"), TDI_OBJECT_NOT_FOUND);
+}
+
+namespace {
+std::unique_ptr<TdiInfoParser> parseWithCache(const std::string &json_path,
+                                              const std::string &cache_dir) {
+  auto tdi_info_parser = testParserMake();
+  tdi_info_parser->schemaCacheDirSet(cache_dir);
+  if (tdi_info_parser->parseTdiInfo({json_path}) != TDI_SUCCESS) {
+    return nullptr;
+  }
+  return tdi_info_parser;
+}
+
+// Data fields of an action, or common data fields for action ID 0
+void expectSameDataFields(const TableInfo &a,
+                          const TableInfo &b,
+                          const tdi_id_t &action_id) {
+  auto ids = action_id ? a.dataFieldIdListGet(action_id)
+                       : a.dataFieldIdListGet();
+  ASSERT_EQ(ids,
+            action_id ? b.dataFieldIdListGet(action_id)
+                      : b.dataFieldIdListGet());
+  for (const auto &id : ids) {
+    auto field = a.dataFieldGet(id, action_id);
+    auto other = b.dataFieldGet(id, action_id);
+    EXPECT_EQ(field->nameGet(), other->nameGet());
+    EXPECT_EQ(field->sizeGet(), other->sizeGet());
+    EXPECT_EQ(field->dataTypeGet(), other->dataTypeGet());
+    EXPECT_EQ(field->oneofSiblingsGet(), other->oneofSiblingsGet());
+  }
+}
+}  // anonymous namespace
+
+/**
+ * @brief Test that the binary schema cache rebuilds the parsed graph and
+ * that a corrupt image falls back to parsing
+ */
+TEST_P(TnaExactMatchInfo, schemaCache) {
+  TestTmpDir tmp_dir;
+  const std::string &cache_dir = tmp_dir.pathGet();
+  ASSERT_FALSE(cache_dir.empty());
+  std::string json_path = std::string(JSONDIR) + "/" + target_name + "/" +
+                          program_name + "/" + std::get<0>(GetParam());
+
+  auto parsed = parseWithCache(json_path, cache_dir);
+  ASSERT_NE(parsed, nullptr);
+  ASSERT_FALSE(parsed->loadedFromCacheGet());
+  auto cached = parseWithCache(json_path, cache_dir);
+  ASSERT_NE(cached, nullptr);
+  ASSERT_TRUE(cached->loadedFromCacheGet());
+
+  const auto &tables = parsed->tableInfoMapGet();
+  ASSERT_EQ(tables.size(), cached->tableInfoMapGet().size());
+  for (const auto &kv : tables) {
+    const auto &table_info = kv.second;
+    const auto &other = cached->tableInfoMapGet().at(kv.first);
+    ASSERT_EQ(table_info == nullptr, other == nullptr);
+    if (!table_info) continue;
+    EXPECT_EQ(table_info->idGet(), other->idGet());
+    EXPECT_EQ(table_info->tableTypeGet(), other->tableTypeGet());
+    EXPECT_EQ(table_info->sizeGet(), other->sizeGet());
+    EXPECT_EQ(table_info->annotationsGet(), other->annotationsGet());
+    ASSERT_EQ(table_info->keyFieldIdListGet(), other->keyFieldIdListGet());
+    for (const auto &id : table_info->keyFieldIdListGet()) {
+      auto key_field = table_info->keyFieldGet(id);
+      auto other_key_field = other->keyFieldGet(id);
+      EXPECT_EQ(key_field->nameGet(), other_key_field->nameGet());
+      EXPECT_EQ(key_field->sizeGet(), other_key_field->sizeGet());
+      EXPECT_EQ(key_field->matchTypeGet(), other_key_field->matchTypeGet());
+    }
+    expectSameDataFields(*table_info, *other, 0);
+    ASSERT_EQ(table_info->actionIdListGet(), other->actionIdListGet());
+    for (const auto &id : table_info->actionIdListGet()) {
+      EXPECT_EQ(table_info->actionGet(id)->nameGet(),
+                other->actionGet(id)->nameGet());
+      expectSameDataFields(*table_info, *other, id);
+    }
+  }
+  ASSERT_EQ(parsed->learnInfoMapGet().size(),
+            cached->learnInfoMapGet().size());
+
+  // Truncate the image, the next parse must ignore it
+  std::vector<std::string> images;
+  DIR *dir = opendir(cache_dir.c_str());
+  ASSERT_NE(dir, nullptr);
+  for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir)) {
+    if (entry->d_name[0] == '.') continue;
+    images.push_back(cache_dir + "/" + entry->d_name);
+  }
+  closedir(dir);
+  ASSERT_EQ(images.size(), 1u);
+  ASSERT_EQ(truncate(images[0].c_str(), 64), 0);
+  auto reparsed = parseWithCache(json_path, cache_dir);
+  ASSERT_NE(reparsed, nullptr);
+  ASSERT_FALSE(reparsed->loadedFromCacheGet());
+  ASSERT_EQ(reparsed->tableInfoMapGet().size(), tables.size());
+}
+
+/**
+ * @brief Test lazy table creation. Tables are built on first lookup and
+ * match the eagerly built ones
+ */
+TEST_P(TnaExactMatchInfo, lazyTables) {
+  std::string json_path = std::string(JSONDIR) + "/" + target_name + "/" +
+                          program_name + "/" + std::get<0>(GetParam());
+  auto tdi_info_parser = testParserMake();
+  tdi_info_parser->lazyParseSet(true);
+  ASSERT_EQ(tdi_info_parser->parseTdiInfo({json_path}), TDI_SUCCESS);
+  ASSERT_EQ(tdi_info_parser->tableIdIndexGet().size(), 3u);
+  ASSERT_TRUE(tdi_info_parser->tableInfoMapGet().empty());
+
+  // TdiInfo owns the parser, which stays valid
+  const TdiInfoParser *parser = tdi_info_parser.get();
+  auto lazy_info = TdiInfo::makeTdiInfo(
+      program_name,
+      std::move(tdi_info_parser),
+      std::unique_ptr<const TableFactory>(
+          new tdi::tna::dummy::TableFactory()));
+  ASSERT_NE(lazy_info, nullptr);
+  ASSERT_TRUE(parser->tableInfoMapGet().empty());
+  ASSERT_EQ(parser->pendingTablesGet().size(), 3u);
+  TdiInfoMemoryUsage usage, eager_usage;
+  ASSERT_EQ(lazy_info->memoryUsageGet(&usage), TDI_SUCCESS);
+  ASSERT_EQ(tdi_info->memoryUsageGet(&eager_usage), TDI_SUCCESS);
+  size_t pending_bytes = usage.pending_tables;
+  ASSERT_GT(pending_bytes, 0u);
+  ASSERT_EQ(eager_usage.pending_tables, 0u);
+  ASSERT_LT(usage.totalGet(), eager_usage.totalGet());
+
+  // Concurrent first lookups all get the one table
+  const Table *table = nullptr;
+  std::vector<const Table *> found(4, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < found.size(); i++) {
+    threads.emplace_back([&lazy_info, &found, i]() {
+      for (int j = 0; j < 100; j++) {
+        lazy_info->tableFromNameGet("ipRoute", &found[i]);
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  ASSERT_EQ(lazy_info->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  for (const auto &found_table : found) ASSERT_EQ(found_table, table);
+  ASSERT_EQ(table->tableInfoGet()->idGet(), 34746517u);
+  ASSERT_EQ(parser->tableInfoMapGet().size(), 1u);
+  ASSERT_EQ(parser->pendingTablesGet().size(), 2u);
+  ASSERT_EQ(lazy_info->memoryUsageGet(&usage), TDI_SUCCESS);
+  ASSERT_LT(usage.pending_tables, pending_bytes);
+  const Table *same_table = nullptr;
+  ASSERT_EQ(lazy_info->tableFromIdGet(34746517, &same_table), TDI_SUCCESS);
+  ASSERT_EQ(same_table, table);
+  ASSERT_EQ(lazy_info->tableFromNameGet("SwitchIngress.ipRoute", &same_table),
+            TDI_SUCCESS);
+  ASSERT_EQ(same_table, table);
+  ASSERT_EQ(parser->tableInfoMapGet().size(), 1u);
+  ASSERT_EQ(lazy_info->tableFromIdGet(1, &same_table), TDI_OBJECT_NOT_FOUND);
+  ASSERT_EQ(lazy_info->tableFromNameGet("no_such_table", &same_table),
+            TDI_OBJECT_NOT_FOUND);
+
+  const Table *eager_table = nullptr;
+  ASSERT_EQ(tdi_info->tableFromNameGet("ipRoute", &eager_table), TDI_SUCCESS);
+  ASSERT_EQ(table->tableInfoGet()->keyFieldIdListGet(),
+            eager_table->tableInfoGet()->keyFieldIdListGet());
+  ASSERT_EQ(table->tableInfoGet()->actionIdListGet(),
+            eager_table->tableInfoGet()->actionIdListGet());
+
+  std::vector<const Table *> tables;
+  ASSERT_EQ(lazy_info->tablesGet(&tables), TDI_SUCCESS);
+  ASSERT_EQ(tables.size(), 3u);
+  ASSERT_EQ(parser->tableInfoMapGet().size(), 3u);
+  ASSERT_EQ(lazy_info->tableMapGet().size(), tdi_info->tableMapGet().size());
+  ASSERT_TRUE(parser->pendingTablesGet().empty());
+  ASSERT_EQ(lazy_info->memoryUsageGet(&usage), TDI_SUCCESS);
+  ASSERT_EQ(usage.pending_tables, 0u);
+}
+
+/**
+ * @brief Test that a parallel parse builds the same tables as a serial one
+ */
+TEST_P(TnaCounterInfo, parallelParse) {
+  std::string json_path = std::string(JSONDIR) + "/" + target_name + "/" +
+                          program_name + "/" + std::get<0>(GetParam());
+  std::unique_ptr<TdiInfoParser> parsers[2];
+  for (size_t i = 0; i < 2; i++) {
+    parsers[i] = testParserMake();
+    parsers[i]->parseThreadsSet(i ? 4 : 1);
+    ASSERT_EQ(parsers[i]->parseTdiInfo({json_path, json_path}), TDI_SUCCESS);
+  }
+  const auto &tables = parsers[0]->tableInfoMapGet();
+  ASSERT_EQ(tables.size(), parsers[1]->tableInfoMapGet().size());
+  for (const auto &kv : tables) {
+    const auto &other = parsers[1]->tableInfoMapGet().at(kv.first);
+    ASSERT_NE(other, nullptr);
+    EXPECT_EQ(kv.second->idGet(), other->idGet());
+    EXPECT_EQ(kv.second->keyFieldIdListGet(), other->keyFieldIdListGet());
+    EXPECT_EQ(kv.second->actionIdListGet(), other->actionIdListGet());
+    expectSameDataFields(*kv.second, *other, 0);
+  }
+  ASSERT_EQ(parsers[0]->learnInfoMapGet().size(),
+            parsers[1]->learnInfoMapGet().size());
+}
+
 /**
  * @brief Test TdiInfo->tableFromIdGet().
  * Correct Table object should be returned
@@ -100,6 +382,74 @@ TEST_P(TnaExactMatchInfo, tableFromNameGet) {
   ASSERT_EQ(table->tableInfoGet()->nameGet(), "pipe.SwitchIngress.forward");
 }
 
+/**
+ * @brief Test name lookups from a (const char *, length) pair. Names
+ * need not be null terminated
+ */
+TEST_P(TnaExactMatchInfo, nameLookupFromCharPtr) {
+  const char buf[] = "pipe.SwitchIngress.ipRoute.extra";
+  const tdi::Table *table;
+  auto status = tdi_info->tableFromNameGet(
+      buf, strlen("pipe.SwitchIngress.ipRoute"), &table);
+  ASSERT_EQ(status, TDI_SUCCESS);
+  ASSERT_EQ(table->tableInfoGet()->nameGet(), "pipe.SwitchIngress.ipRoute");
+  // Short name
+  status = tdi_info->tableFromNameGet(buf + strlen("pipe.SwitchIngress."),
+                                      strlen("ipRoute"),
+                                      &table);
+  ASSERT_EQ(status, TDI_SUCCESS);
+  ASSERT_EQ(table->tableInfoGet()->nameGet(), "pipe.SwitchIngress.ipRoute");
+  status = tdi_info->tableFromNameGet(buf, sizeof(buf) - 1, &table);
+  ASSERT_EQ(status, TDI_OBJECT_NOT_FOUND);
+
+  auto table_info = table->tableInfoGet();
+  const char key_buf[] = "vrfx";
+  ASSERT_EQ(table_info->keyFieldGet(key_buf, 3), table_info->keyFieldGet(1));
+  ASSERT_EQ(table_info->keyFieldGet(key_buf, 4), nullptr);
+  auto nat = table_info->actionGet("SwitchIngress.nat", 17);
+  ASSERT_NE(nat, nullptr);
+  ASSERT_EQ(nat->idGet(), 32755069);
+  auto dst_addr = table_info->dataFieldGet("dstAddr", 7, nat->idGet());
+  ASSERT_NE(dst_addr, nullptr);
+  ASSERT_EQ(dst_addr->idGet(), 2);
+  // dstMac belongs to another action
+  ASSERT_EQ(table_info->dataFieldGet("dstMac", 6, nat->idGet()), nullptr);
+}
+
+/**
+ * @brief Test short names shared by several objects of a ShortNameIndex
+ */
+TEST_P(TnaExactMatchInfo, shortNameIndex) {
+  const std::vector<std::string> names = {"pipe.SwitchIngress.forward",
+                                          "pipe.SwitchEgress.forward",
+                                          "SwitchEgress.forward",
+                                          "pipe.SwitchIngress.ipRoute"};
+  std::vector<int> objects(names.size());
+  tdi::ShortNameIndex<int> index;
+  for (size_t i = 0; i < names.size(); i++) index.insert(names[i], &objects[i]);
+
+  // Fully qualified names always resolve
+  for (size_t i = 0; i < names.size(); i++) {
+    ASSERT_EQ(index.find(names[i]), &objects[i]);
+  }
+  ASSERT_EQ(index.find("SwitchIngress.forward"), &objects[0]);
+  ASSERT_EQ(index.find("ipRoute"), &objects[3]);
+  // Shared by all three forward tables
+  ASSERT_EQ(index.find("forward"), nullptr);
+  // Suffixes only start at a token
+  ASSERT_EQ(index.find("ward"), nullptr);
+  ASSERT_EQ(index.find("Ingress.forward"), nullptr);
+  ASSERT_EQ(index.find(""), nullptr);
+  ASSERT_EQ(index.find(".ipRoute"), nullptr);
+  ASSERT_EQ(index.find("x.pipe.SwitchIngress.ipRoute"), nullptr);
+  // Every suffix but forward resolves
+  ASSERT_EQ(index.size(), 7u);
+
+  index.clear();
+  ASSERT_EQ(index.find(names[0]), nullptr);
+  ASSERT_EQ(index.size(), 0u);
+}
+
 /**
  * @brief Test TableInfo->idGet()
  */
@@ -142,5 +492,1356 @@ TEST_P(TnaCounterInfo, tableInfo_tableTypeGet) {
             TDI_DUMMY_TABLE_TYPE_COUNTER);
 }
 
+/**
+ * @brief Test TableInfo->dataFieldIndexGet(). Indices are dense over the
+ * distinct data field IDs of common fields and of all the actions
+ */
+TEST_P(TnaExactMatchInfo, tableInfo_dataFieldIndexGet) {
+  const tdi::Table *table;
+  auto status =
+      tdi_info->tableFromNameGet("pipe.SwitchIngress.ipRoute", &table);
+  ASSERT_EQ(status, TDI_SUCCESS);
+  auto table_info = table->tableInfoGet();
+  ASSERT_EQ(table_info->dataFieldIndexCountGet(), 9);
+  for (const auto &field_id :
+       {1u, 2u, 3u, 65545u, 65546u, 65547u, 65548u, 65553u, 65554u}) {
+    uint32_t index;
+    status = table_info->dataFieldIndexGet(field_id, &index);
+    ASSERT_EQ(status, TDI_SUCCESS);
+    ASSERT_LT(index, table_info->dataFieldIndexCountGet());
+    ASSERT_EQ(table_info->dataFieldIdFromIndexGet(index), field_id);
+  }
+  uint32_t index;
+  ASSERT_EQ(table_info->dataFieldIndexGet(4, &index), TDI_OBJECT_NOT_FOUND);
+  ASSERT_EQ(table_info->dataFieldIndexGet(65552, &index),
+            TDI_OBJECT_NOT_FOUND);
+  ASSERT_EQ(table_info->dataFieldIndexGet(0xffffffff, &index),
+            TDI_OBJECT_NOT_FOUND);
+
+  // Common fields come first, indexed by their ordinal. Every field carries
+  // its index
+  for (uint32_t i = 0; i < table_info->dataFieldCountGet(); i++) {
+    auto field = table_info->dataFieldByOrdinalGet(i);
+    ASSERT_EQ(field->indexGet(), i);
+    ASSERT_EQ(table_info->dataFieldIndexGet(field->idGet(), &index),
+              TDI_SUCCESS);
+    ASSERT_EQ(index, i);
+  }
+  for (uint32_t a = 0; a < table_info->actionCountGet(); a++) {
+    auto action = table_info->actionByOrdinalGet(a);
+    for (uint32_t f = 0; f < action->dataFieldCountGet(); f++) {
+      auto field = action->dataFieldByOrdinalGet(f);
+      ASSERT_EQ(table_info->dataFieldIdFromIndexGet(field->indexGet()),
+                field->idGet());
+    }
+  }
+}
+
+/**
+ * @brief Test ordinal based accessors of TableInfo. Ordinals follow
+ * increasing IDs
+ */
+/**
+ * @brief Test that schema strings are interned. Fields with the same name
+ * share one string, and annotations compare equal across pools
+ */
+TEST_P(TnaExactMatchInfo, stringPool) {
+  const tdi::Table *table;
+  auto status =
+      tdi_info->tableFromNameGet("pipe.SwitchIngress.ipRoute", &table);
+  ASSERT_EQ(status, TDI_SUCCESS);
+  auto table_info = table->tableInfoGet();
+  auto route = table_info->actionGet("SwitchIngress.route");
+  auto nat = table_info->actionGet("SwitchIngress.nat");
+  ASSERT_NE(route, nullptr);
+  ASSERT_NE(nat, nullptr);
+  auto route_port = table_info->dataFieldGet("dst_port", route->idGet());
+  auto nat_port = table_info->dataFieldGet("dst_port", nat->idGet());
+  ASSERT_NE(route_port, nullptr);
+  ASSERT_NE(nat_port, nullptr);
+  ASSERT_NE(route_port, nat_port);
+  ASSERT_EQ(&route_port->nameGet(), &nat_port->nameGet());
+  ASSERT_EQ(&route_port->allowedChoicesGet(), &nat_port->allowedChoicesGet());
+
+  StringPool pool;
+  Annotation a(pool, "$tdi_field_class", "register_data");
+  Annotation b(pool, "$tdi_field_class", "register_data");
+  Annotation c("$tdi_field_class", "register_data");
+  ASSERT_EQ(&a.name_, &b.name_);
+  ASSERT_NE(&a.name_, &c.name_);
+  ASSERT_TRUE(a == b);
+  ASSERT_TRUE(a == c);
+  ASSERT_FALSE(a < c || c < a);
+  ASSERT_TRUE(a == std::string("$tdi_field_class.register_data"));
+  // Two strings and the full name
+  ASSERT_EQ(pool.sizeGet(), 3u);
+
+  // Concurrent interning of the same strings and lists ends up with one
+  // entry each
+  StringPool shared_pool;
+  std::vector<std::vector<const void *>> interned(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < interned.size(); i++) {
+    threads.emplace_back([&shared_pool, &interned, i]() {
+      for (int j = 0; j < 200; j++) {
+        std::string str = "field_" + std::to_string(j);
+        interned[i].push_back(&shared_pool.intern(str));
+        interned[i].push_back(&shared_pool.intern(
+            std::vector<std::string>{str, "INVALID"}));
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  for (const auto &thread_interned : interned) {
+    ASSERT_EQ(thread_interned, interned[0]);
+  }
+  ASSERT_EQ(shared_pool.sizeGet(), 400u);
+  ASSERT_GT(shared_pool.bytesGet(), 0u);
+}
+
+/**
+ * @brief Test TdiInfo->memoryUsageGet(). None of the data fields of the
+ * program have annotations or oneof siblings, so none have extras
+ */
+TEST_P(TnaExactMatchInfo, memoryUsageGet) {
+  ASSERT_EQ(tdi_info->memoryUsageGet(nullptr), TDI_INVALID_ARG);
+  TdiInfoMemoryUsage usage;
+  ASSERT_EQ(tdi_info->memoryUsageGet(&usage), TDI_SUCCESS);
+  // 9 action data fields and 6 common ones of ipRoute
+  ASSERT_EQ(usage.num_data_fields, 15u);
+  ASSERT_EQ(usage.num_data_fields_with_extras, 0u);
+  ASSERT_EQ(usage.data_field_extras, 0u);
+  ASSERT_GT(usage.table_infos, 0u);
+  ASSERT_GT(usage.key_fields, 0u);
+  ASSERT_GT(usage.actions, 0u);
+  ASSERT_GT(usage.string_pool, 0u);
+  ASSERT_GT(usage.tdi_info, 0u);
+  ASSERT_EQ(usage.totalGet(),
+            usage.table_infos + usage.key_fields + usage.data_fields +
+                usage.actions + usage.learn_infos + usage.string_pool +
+                usage.tdi_info);
+}
+
+/**
+ * @brief Test Device::programReload(). Reloading the same schema keeps all
+ * the Table objects, changing the size of one table only rebuilds that one
+ */
+TEST_P(TnaExactMatchInfo, programReload) {
+  TestTmpDir tmp_dir;
+  ASSERT_FALSE(tmp_dir.pathGet().empty());
+  std::string content =
+      getTestJsonFileContent(std::get<0>(GetParam()), program_name);
+  std::string json_path = tmp_dir.fileWrite("tdi.json", content);
+
+  tdi::tna::dummy::Device device(
+      0, TDI_ARCH_TYPE_TNA, {ProgramConfig(program_name, {json_path}, {})},
+      nullptr, nullptr);
+  const TdiInfo *info = nullptr;
+  ASSERT_EQ(device.tdiInfoGet(program_name, &info), TDI_SUCCESS);
+  const Table *ip_route = nullptr;
+  const Table *forward = nullptr;
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &ip_route), TDI_SUCCESS);
+  ASSERT_EQ(info->tableFromNameGet("forward", &forward), TDI_SUCCESS);
+
+  TdiInfoReloadResult result;
+  ASSERT_EQ(device.programReload(
+                ProgramConfig("no_such_program", {json_path}, {}), &result),
+            TDI_OBJECT_NOT_FOUND);
+  ASSERT_EQ(device.programReload(ProgramConfig(program_name, {json_path}, {}),
+                                 &result),
+            TDI_SUCCESS);
+  ASSERT_EQ(result.tables_unchanged, 3u);
+  ASSERT_TRUE(result.tables_changed.empty());
+  const Table *table = nullptr;
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  ASSERT_EQ(table, ip_route);
+
+  auto pos = content.find("\"pipe.SwitchIngress.ipRoute\"");
+  ASSERT_NE(pos, std::string::npos);
+  const std::string size_str = "\"size\" : 1024";
+  pos = content.find(size_str, pos);
+  ASSERT_NE(pos, std::string::npos);
+  content.replace(pos, size_str.size(), "\"size\" : 2048");
+  // A file that fails to parse leaves the program as is
+  std::string new_json_path =
+      tmp_dir.fileWrite("tdi_new.json", content.substr(0, content.size() / 2));
+  ASSERT_EQ(device.programReload(
+                ProgramConfig(program_name, {new_json_path}, {}), &result),
+            TDI_INVALID_ARG);
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  ASSERT_EQ(table, ip_route);
+  tmp_dir.fileWrite("tdi_new.json", content);
+  ASSERT_EQ(device.programReload(
+                ProgramConfig(program_name, {new_json_path}, {}), &result),
+            TDI_SUCCESS);
+  ASSERT_EQ(result.tables_unchanged, 2u);
+  ASSERT_EQ(result.tables_changed,
+            std::vector<std::string>{"pipe.SwitchIngress.ipRoute"});
+  ASSERT_TRUE(result.tables_added.empty());
+  ASSERT_TRUE(result.tables_removed.empty());
+  ASSERT_EQ(info->tableFromNameGet("forward", &table), TDI_SUCCESS);
+  ASSERT_EQ(table, forward);
+  ASSERT_EQ(info->tableFromNameGet("SwitchIngress.ipRoute", &table),
+            TDI_SUCCESS);
+  ASSERT_EQ(table->tableInfoGet()->sizeGet(), 2048u);
+  ASSERT_EQ(info->tableFromIdGet(34746517, &ip_route), TDI_SUCCESS);
+  ASSERT_EQ(ip_route, table);
+
+  const std::vector<ProgramConfig> *device_config = nullptr;
+  ASSERT_EQ(device.deviceConfigGet(&device_config), TDI_SUCCESS);
+  ASSERT_EQ(device_config->at(0).tdi_info_file_paths_,
+            std::vector<std::string>{new_json_path});
+}
+
+/**
+ * @brief Test table lookups and program config reads running concurrently
+ * with program reloads
+ */
+TEST_P(TnaExactMatchInfo, programReloadConcurrentLookup) {
+  TestTmpDir tmp_dir;
+  ASSERT_FALSE(tmp_dir.pathGet().empty());
+  std::string content =
+      getTestJsonFileContent(std::get<0>(GetParam()), program_name);
+  std::string json_path = tmp_dir.fileWrite("tdi.json", content);
+  auto pos = content.find("\"pipe.SwitchIngress.ipRoute\"");
+  ASSERT_NE(pos, std::string::npos);
+  const std::string size_str = "\"size\" : 1024";
+  pos = content.find(size_str, pos);
+  ASSERT_NE(pos, std::string::npos);
+  content.replace(pos, size_str.size(), "\"size\" : 2048");
+  std::string new_json_path = tmp_dir.fileWrite("tdi_new.json", content);
+
+  tdi::tna::dummy::Device device(
+      0, TDI_ARCH_TYPE_TNA, {ProgramConfig(program_name, {json_path}, {})},
+      nullptr, nullptr);
+  const TdiInfo *info = nullptr;
+  ASSERT_EQ(device.tdiInfoGet(program_name, &info), TDI_SUCCESS);
+  const Table *ip_route = nullptr;
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &ip_route), TDI_SUCCESS);
+
+  // A replaced table stays valid until the next reload
+  ASSERT_EQ(device.programReload(
+                ProgramConfig(program_name, {new_json_path}, {})),
+            TDI_SUCCESS);
+  ASSERT_EQ(ip_route->tableInfoGet()->sizeGet(), 1024u);
+
+  std::atomic<bool> done{false};
+  std::atomic<int> failures{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    // Objects returned are only checked, the back to back reloads may
+    // free them while the reader is descheduled
+    readers.emplace_back([&]() {
+      while (!done) {
+        const Table *table = nullptr;
+        const std::vector<ProgramConfig> *device_config = nullptr;
+        std::vector<const Learn *> learns;
+        if (info->tableFromNameGet("ipRoute", &table) != TDI_SUCCESS ||
+            !table || info->tableFromIdGet(34746517, &table) != TDI_SUCCESS ||
+            !table || info->tableFromNameGet("forward", &table) !=
+                          TDI_SUCCESS ||
+            info->learnsGet(&learns) != TDI_SUCCESS ||
+            device.deviceConfigGet(&device_config) != TDI_SUCCESS ||
+            !device_config) {
+          failures++;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 20; i++) {
+    TdiInfoReloadResult result;
+    const std::string &path = i % 2 ? new_json_path : json_path;
+    ASSERT_EQ(
+        device.programReload(ProgramConfig(program_name, {path}, {}), &result),
+        TDI_SUCCESS);
+    ASSERT_EQ(result.tables_changed,
+              std::vector<std::string>{"pipe.SwitchIngress.ipRoute"});
+  }
+  done = true;
+  for (auto &reader : readers) reader.join();
+  ASSERT_EQ(failures, 0);
+  const Table *table = nullptr;
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  ASSERT_EQ(table->tableInfoGet()->sizeGet(), 2048u);
+}
+
+namespace {
+// Factory failing to create one table
+class FailingTableFactory : public tdi::tna::dummy::TableFactory {
+ public:
+  FailingTableFactory(const std::string &name) : name_(name){};
+  std::unique_ptr<tdi::Table> makeTable(
+      const TdiInfo *tdi_info,
+      const tdi::TableInfo *table_info) const override {
+    if (table_info->nameGet() == name_) {
+      failures_++;
+      return nullptr;
+    }
+    return tdi::tna::dummy::TableFactory::makeTable(tdi_info, table_info);
+  };
+  mutable std::atomic<int> failures_{0};
+
+ private:
+  const std::string name_;
+};
+}  // anonymous namespace
+
+/**
+ * @brief Test that a schema reload failing to create a Table leaves the
+ * TdiInfo unchanged
+ */
+TEST_P(TnaExactMatchInfo, schemaReloadTableFailure) {
+  TestTmpDir tmp_dir;
+  ASSERT_FALSE(tmp_dir.pathGet().empty());
+  std::string content =
+      getTestJsonFileContent(std::get<0>(GetParam()), program_name);
+  auto pos = content.find("\"pipe.SwitchIngress.ipRoute\"");
+  ASSERT_NE(pos, std::string::npos);
+  const std::string size_str = "\"size\" : 1024";
+  pos = content.find(size_str, pos);
+  ASSERT_NE(pos, std::string::npos);
+  content.replace(pos, size_str.size(), "\"size\" : 2048");
+  std::string json_path = tmp_dir.fileWrite("tdi.json", content);
+
+  // TdiInfo objects are created non-const and only handed out as const
+  auto info = const_cast<TdiInfo *>(tdi_info.get());
+  const Table *ip_route = nullptr;
+  const Table *forward = nullptr;
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &ip_route), TDI_SUCCESS);
+  ASSERT_EQ(info->tableFromNameGet("forward", &forward), TDI_SUCCESS);
+  size_t num_tables = info->tableMapGet().size();
+
+  // ipRoute changed and can't be created
+  FailingTableFactory factory("pipe.SwitchIngress.ipRoute");
+  auto parser = testParserMake();
+  TdiInfoReloadResult result;
+  ASSERT_NE(info->schemaReload(std::move(parser), {json_path}, &factory,
+                               &result),
+            TDI_SUCCESS);
+  ASSERT_TRUE(result.tables_removed.empty());
+  ASSERT_EQ(info->tableMapGet().size(), num_tables);
+  const Table *table = nullptr;
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  ASSERT_EQ(table, ip_route);
+  ASSERT_EQ(table->tableInfoGet()->sizeGet(), 1024u);
+  ASSERT_EQ(info->tableFromIdGet(34746517, &table), TDI_SUCCESS);
+  ASSERT_EQ(table, ip_route);
+  ASSERT_EQ(info->tableFromNameGet("forward", &table), TDI_SUCCESS);
+  ASSERT_EQ(table, forward);
+
+  // An unchanged table failing to be created doesn't matter
+  FailingTableFactory forward_factory("pipe.SwitchIngress.forward");
+  parser = testParserMake();
+  ASSERT_EQ(info->schemaReload(std::move(parser), {json_path},
+                               &forward_factory, &result),
+            TDI_SUCCESS);
+  ASSERT_EQ(result.tables_changed,
+            std::vector<std::string>{"pipe.SwitchIngress.ipRoute"});
+  ASSERT_EQ(info->tableFromNameGet("forward", &table), TDI_SUCCESS);
+  ASSERT_EQ(table, forward);
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  ASSERT_EQ(table->tableInfoGet()->sizeGet(), 2048u);
+}
+
+/**
+ * @brief Test that a lazy table the factory fails to create is only tried
+ * once
+ */
+TEST_P(TnaExactMatchInfo, lazyTableFailure) {
+  std::string json_path = std::string(JSONDIR) + "/" + target_name + "/" +
+                          program_name + "/" + std::get<0>(GetParam());
+  auto tdi_info_parser = testParserMake();
+  tdi_info_parser->lazyParseSet(true);
+  ASSERT_EQ(tdi_info_parser->parseTdiInfo({json_path}), TDI_SUCCESS);
+  auto factory = new FailingTableFactory("pipe.SwitchIngress.ipRoute");
+  auto lazy_info =
+      TdiInfo::makeTdiInfo(program_name,
+                           std::move(tdi_info_parser),
+                           std::unique_ptr<const TableFactory>(factory));
+  ASSERT_NE(lazy_info, nullptr);
+  const Table *table = nullptr;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(lazy_info->tableFromNameGet("ipRoute", &table),
+              TDI_OBJECT_NOT_FOUND);
+    ASSERT_EQ(lazy_info->tableFromIdGet(34746517, &table),
+              TDI_OBJECT_NOT_FOUND);
+  }
+  std::vector<const Table *> tables;
+  ASSERT_EQ(lazy_info->tablesGet(&tables), TDI_SUCCESS);
+  ASSERT_EQ(tables.size(), 2u);
+  ASSERT_EQ(factory->failures_, 1);
+  ASSERT_EQ(lazy_info->tableFromNameGet("forward", &table), TDI_SUCCESS);
+}
+
+/**
+ * @brief Test that devices running the same program share its TdiInfo
+ * through TdiInfoRegistry, and that different files are not shared
+ */
+TEST_P(TnaExactMatchInfo, sharedTdiInfo) {
+  std::string json_dir = std::string(JSONDIR) + "/" + target_name + "/";
+  std::string json_path =
+      json_dir + program_name + "/" + std::get<0>(GetParam());
+  std::string other_json_path = json_dir + "tna_counter/tdi.json";
+  auto &registry = TdiInfoRegistry::getInstance();
+  size_t registry_size = registry.sizeGet();
+
+  std::unique_ptr<tdi::tna::dummy::Device> devices[3];
+  const TdiInfo *infos[3];
+  for (int i = 0; i < 3; i++) {
+    devices[i].reset(new tdi::tna::dummy::Device(
+        i, TDI_ARCH_TYPE_TNA,
+        {ProgramConfig(program_name, {i < 2 ? json_path : other_json_path},
+                       {})},
+        nullptr, nullptr));
+    ASSERT_EQ(devices[i]->tdiInfoGet(program_name, &infos[i]), TDI_SUCCESS);
+  }
+  ASSERT_EQ(infos[0], infos[1]);
+  ASSERT_NE(infos[0], infos[2]);
+  ASSERT_EQ(registry.sizeGet(), registry_size + 2);
+
+  // A shared TdiInfo can't be reloaded in place
+  ASSERT_EQ(devices[0]->programReload(
+                ProgramConfig(program_name, {json_path}, {})),
+            TDI_IN_USE);
+
+  // The TdiInfo lives as long as a device uses it
+  devices[0].reset();
+  ASSERT_EQ(registry.sizeGet(), registry_size + 2);
+  const Table *table = nullptr;
+  ASSERT_EQ(infos[1]->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  devices[1].reset();
+  devices[2].reset();
+  ASSERT_EQ(registry.sizeGet(), registry_size);
+
+  // Only the sole reference can be detached, later requests parse anew
+  auto get = [&](std::shared_ptr<const TdiInfo> *info) {
+    return registry.tdiInfoGet(
+        program_name,
+        {json_path},
+        testParserMake(),
+        std::unique_ptr<const TableFactory>(
+            new tdi::tna::dummy::TableFactory()),
+        info);
+  };
+  std::shared_ptr<const TdiInfo> detached, shared;
+  ASSERT_EQ(get(&detached), TDI_SUCCESS);
+  ASSERT_EQ(get(&shared), TDI_SUCCESS);
+  ASSERT_EQ(detached, shared);
+  ASSERT_EQ(registry.tdiInfoDetach(detached), TDI_IN_USE);
+  shared.reset();
+  ASSERT_EQ(registry.tdiInfoDetach(detached), TDI_SUCCESS);
+  ASSERT_EQ(registry.sizeGet(), registry_size);
+  ASSERT_EQ(get(&shared), TDI_SUCCESS);
+  ASSERT_NE(detached, shared);
+  ASSERT_EQ(registry.tdiInfoDetach(nullptr), TDI_INVALID_ARG);
+}
+
+TEST_P(TnaExactMatchInfo, tableInfo_ordinals) {
+  const tdi::Table *table;
+  auto status =
+      tdi_info->tableFromNameGet("pipe.SwitchIngress.ipRoute", &table);
+  ASSERT_EQ(status, TDI_SUCCESS);
+  auto table_info = table->tableInfoGet();
+
+  ASSERT_EQ(table_info->keyFieldCountGet(), 2);
+  ASSERT_EQ(table_info->keyFieldByOrdinalGet(0)->nameGet(), "vrf");
+  ASSERT_EQ(table_info->keyFieldByOrdinalGet(1)->nameGet(),
+            "hdr.ipv4.dst_addr");
+  ASSERT_EQ(table_info->keyFieldByOrdinalGet(2), nullptr);
+  ASSERT_EQ(table_info->keyFieldGet("hdr.ipv4.dst_addr")->ordinalGet(), 1);
+
+  ASSERT_EQ(table_info->dataFieldCountGet(), 6);
+  ASSERT_EQ(table_info->dataFieldByOrdinalGet(0)->idGet(), 65545);
+  ASSERT_EQ(table_info->dataFieldByOrdinalGet(5)->idGet(), 65554);
+  ASSERT_EQ(table_info->dataFieldByOrdinalGet(6), nullptr);
+
+  // Actions sorted by ID : NoAction, route, nat
+  ASSERT_EQ(table_info->actionCountGet(), 3);
+  ASSERT_EQ(table_info->actionByOrdinalGet(0)->nameGet(), "NoAction");
+  auto nat = table_info->actionGet("SwitchIngress.nat");
+  ASSERT_NE(nat, nullptr);
+  ASSERT_EQ(nat->ordinalGet(), 2);
+  ASSERT_EQ(table_info->actionByOrdinalGet(nat->ordinalGet()), nat);
+  ASSERT_EQ(nat->dataFieldCountGet(), 3);
+  auto dst_addr = table_info->dataFieldByOrdinalGet(nat->ordinalGet(), 1);
+  ASSERT_NE(dst_addr, nullptr);
+  ASSERT_EQ(dst_addr->nameGet(), "dstAddr");
+  ASSERT_EQ(dst_addr, table_info->dataFieldGet(2, nat->idGet()));
+  ASSERT_EQ(table_info->dataFieldByOrdinalGet(0, 0), nullptr);
+  ASSERT_EQ(table_info->dataFieldByOrdinalGet(3, 0), nullptr);
+}
+
+/**
+ * @brief Test TableData active fields tracking
+ */
+TEST_P(TnaExactMatchInfo, tableData_isActive) {
+  const tdi::Table *table;
+  auto status =
+      tdi_info->tableFromNameGet("pipe.SwitchIngress.ipRoute", &table);
+  ASSERT_EQ(status, TDI_SUCCESS);
+  bool is_active;
+
+  // All fields active
+  TableData all_data(table, 31369524);
+  ASSERT_TRUE(all_data.allFieldsSetGet());
+  ASSERT_TRUE(all_data.activeFieldsGet().empty());
+  all_data.removeActiveField(65553);
+  all_data.isActive(65553, &is_active);
+  ASSERT_FALSE(is_active);
+  all_data.isActive(1, &is_active);
+  ASSERT_TRUE(is_active);
+
+  // Explicit list of fields, including an ID unknown to the table
+  TableData data(table, 31369524, {1, 3, 65553, 1000});
+  ASSERT_FALSE(data.allFieldsSetGet());
+  ASSERT_EQ(data.activeFieldsGet(),
+            std::set<tdi_id_t>({1, 3, 65553, 1000}));
+  data.isActive(2, &is_active);
+  ASSERT_FALSE(is_active);
+  data.isActive(1000, &is_active);
+  ASSERT_TRUE(is_active);
+  data.removeActiveField(3);
+  data.removeActiveField(1000);
+  data.isActive(3, &is_active);
+  ASSERT_FALSE(is_active);
+  data.isActive(1000, &is_active);
+  ASSERT_FALSE(is_active);
+  // Same set object, refreshed after the active fields changed
+  const std::set<tdi_id_t> &active_fields = data.activeFieldsGet();
+  ASSERT_EQ(&active_fields, &data.activeFieldsGet());
+  ASSERT_EQ(active_fields, std::set<tdi_id_t>({1, 65553}));
+  data.removeActiveField(65553);
+  ASSERT_EQ(data.activeFieldsGet(), std::set<tdi_id_t>({1}));
+
+  // Allocation free variant, reusing the vector
+  std::vector<tdi_id_t> field_list(8, 0);
+  const tdi_id_t *field_list_data = field_list.data();
+  ASSERT_EQ(data.activeFieldsGet(&field_list), TDI_SUCCESS);
+  ASSERT_EQ(field_list, std::vector<tdi_id_t>({1}));
+  ASSERT_EQ(field_list.data(), field_list_data);
+  TableData list_data(table, 31369524, {1, 3, 1000});
+  ASSERT_EQ(list_data.activeFieldsGet(&field_list), TDI_SUCCESS);
+  std::sort(field_list.begin(), field_list.end());
+  ASSERT_EQ(field_list, std::vector<tdi_id_t>({1, 3, 1000}));
+  ASSERT_EQ(all_data.activeFieldsGet(&field_list), TDI_SUCCESS);
+  ASSERT_TRUE(field_list.empty());
+  ASSERT_EQ(data.activeFieldsGet(nullptr), TDI_INVALID_ARG);
+
+  // Reset clears removed fields
+  data.reset(31369524, {2});
+  data.isActive(3, &is_active);
+  ASSERT_FALSE(is_active);
+  data.isActive(2, &is_active);
+  ASSERT_TRUE(is_active);
+  data.reset();
+  data.isActive(3, &is_active);
+  ASSERT_TRUE(is_active);
+}
+
+namespace {
+// Minimal key storing exact match fields as bytes
+class ExactBytesKey : public TableKey {
+ public:
+  ExactBytesKey(const Table *table) : TableKey(table){};
+  using TableKey::setValue;
+  tdi_status_t setValue(const tdi_id_t &field_id,
+                        const KeyFieldValue &field_value) override {
+    auto &value =
+        static_cast<const KeyFieldValueExact<const uint8_t *> &>(field_value);
+    fields_[field_id].assign(value.value_, value.value_ + value.size_);
+    return TDI_SUCCESS;
+  };
+  tdi_status_t getValue(const tdi_id_t &field_id,
+                        KeyFieldValue *field_value) const override {
+    auto value = static_cast<KeyFieldValueExact<uint8_t *> *>(field_value);
+    std::memset(value->value_, 0, value->size_);
+    auto it = fields_.find(field_id);
+    if (it != fields_.end()) {
+      std::memcpy(value->value_,
+                  it->second.data(),
+                  std::min(value->size_, it->second.size()));
+    }
+    return TDI_SUCCESS;
+  };
+
+ private:
+  std::map<tdi_id_t, std::vector<uint8_t>> fields_;
+};
+}  // anonymous namespace
+
+TEST_P(TnaExactMatchInfo, packedKey) {
+  const tdi::Table *table;
+  auto status =
+      tdi_info->tableFromNameGet("pipe.SwitchIngress.ipRoute", &table);
+  ASSERT_EQ(status, TDI_SUCCESS);
+  const PackedKeyLayout *layout = nullptr;
+  ASSERT_EQ(table->packedKeyLayoutGet(&layout), TDI_SUCCESS);
+  const PackedKeyLayout *layout_again = nullptr;
+  ASSERT_EQ(table->packedKeyLayoutGet(&layout_again), TDI_SUCCESS);
+  ASSERT_EQ(layout, layout_again);
+
+  // vrf (16 bits) followed by hdr.ipv4.dst_addr (32 bits), padded to 8
+  ASSERT_EQ(layout->fieldsGet().size(), 2);
+  ASSERT_EQ(layout->fieldsGet()[0].id_, 1);
+  ASSERT_EQ(layout->fieldsGet()[0].offset_, 0);
+  ASSERT_EQ(layout->fieldsGet()[1].id_, 2);
+  ASSERT_EQ(layout->fieldsGet()[1].offset_, 2);
+  ASSERT_EQ(layout->fieldsGet()[1].size_, 4);
+  ASSERT_EQ(layout->sizeGet(), 8);
+  const uint8_t exact_mask[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0, 0};
+  ASSERT_EQ(std::memcmp(layout->exactMaskGet(), exact_mask, 8), 0);
+
+  const uint8_t vrf[] = {0x00, 0x05};
+  const uint8_t dst_addr[] = {10, 0, 0, 1};
+  ExactBytesKey key(table), same_key(table), other_key(table);
+  key.setValue(1, KeyFieldValueExact<const uint8_t *>(vrf, 2));
+  key.setValue(2, KeyFieldValueExact<const uint8_t *>(dst_addr, 4));
+  same_key.setValue(2, KeyFieldValueExact<const uint8_t *>(dst_addr, 4));
+  same_key.setValue(1, KeyFieldValueExact<const uint8_t *>(vrf, 2));
+  other_key.setValue(1, KeyFieldValueExact<const uint8_t *>(vrf, 2));
+
+  PackedKey packed(layout), same_packed(layout), other_packed(layout);
+  ASSERT_EQ(packed.pack(key), TDI_SUCCESS);
+  ASSERT_EQ(same_packed.pack(same_key), TDI_SUCCESS);
+  ASSERT_EQ(other_packed.pack(other_key), TDI_SUCCESS);
+  const uint8_t value[] = {0x00, 0x05, 10, 0, 0, 1, 0, 0};
+  ASSERT_EQ(std::memcmp(packed.valueGet(), value, 8), 0);
+  ASSERT_EQ(std::memcmp(packed.maskGet(), exact_mask, 8), 0);
+  ASSERT_EQ(packed, same_packed);
+  ASSERT_EQ(packed.hash(), same_packed.hash());
+  ASSERT_NE(packed, other_packed);
+  ASSERT_TRUE(other_packed < packed);
+
+  // Round trip through unpack
+  ExactBytesKey unpacked_key(table);
+  ASSERT_EQ(packed.unpack(&unpacked_key), TDI_SUCCESS);
+  PackedKey repacked(layout);
+  ASSERT_EQ(repacked.pack(unpacked_key), TDI_SUCCESS);
+  ASSERT_EQ(packed, repacked);
+
+  // Canonical serialization of TableKey
+  size_t size = 0;
+  ASSERT_EQ(key.serializedSizeGet(&size), TDI_SUCCESS);
+  ASSERT_EQ(size, 6);
+  bool is_equal = false;
+  ASSERT_EQ(key.equals(same_key, &is_equal), TDI_SUCCESS);
+  ASSERT_TRUE(is_equal);
+  ASSERT_EQ(key.equals(other_key, &is_equal), TDI_SUCCESS);
+  ASSERT_FALSE(is_equal);
+  uint64_t hash = 0, same_hash = 0;
+  ASSERT_EQ(key.hash(&hash), TDI_SUCCESS);
+  ASSERT_EQ(same_key.hash(&same_hash), TDI_SUCCESS);
+  ASSERT_EQ(hash, same_hash);
+}
+
+namespace {
+// Minimal key storing ternary and LPM fields as bytes
+class MatchBytesKey : public TableKey {
+ public:
+  MatchBytesKey(const Table *table) : TableKey(table){};
+  using TableKey::setValue;
+  tdi_status_t setValue(const tdi_id_t &field_id,
+                        const KeyFieldValue &field_value) override {
+    auto &field = fields_[field_id];
+    if (static_cast<uint32_t>(field_value.matchTypeGet()) ==
+        TDI_MATCH_TYPE_TERNARY) {
+      auto &value = static_cast<const KeyFieldValueTernary<const uint8_t *> &>(
+          field_value);
+      field.value.assign(value.value_, value.value_ + value.size_);
+      field.mask.assign(value.mask_, value.mask_ + value.size_);
+    } else {
+      auto &value =
+          static_cast<const KeyFieldValueLPM<const uint8_t *> &>(field_value);
+      field.value.assign(value.value_, value.value_ + value.size_);
+      field.prefix_len = value.prefix_len_;
+    }
+    return TDI_SUCCESS;
+  };
+  tdi_status_t getValue(const tdi_id_t &field_id,
+                        KeyFieldValue *field_value) const override {
+    const auto &field = fields_.at(field_id);
+    if (static_cast<uint32_t>(field_value->matchTypeGet()) ==
+        TDI_MATCH_TYPE_TERNARY) {
+      auto value = static_cast<KeyFieldValueTernary<uint8_t *> *>(field_value);
+      std::memcpy(value->value_, field.value.data(), value->size_);
+      std::memcpy(value->mask_, field.mask.data(), value->size_);
+    } else {
+      auto value = static_cast<KeyFieldValueLPM<uint8_t *> *>(field_value);
+      std::memcpy(value->value_, field.value.data(), value->size_);
+      value->prefix_len_ = field.prefix_len;
+    }
+    return TDI_SUCCESS;
+  };
+
+ private:
+  struct Field {
+    std::vector<uint8_t> value;
+    std::vector<uint8_t> mask;
+    uint16_t prefix_len{0};
+  };
+  std::map<tdi_id_t, Field> fields_;
+};
+
+void keyFill(MatchBytesKey *key,
+             const std::vector<uint8_t> &vrf,
+             const std::vector<uint8_t> &vrf_mask,
+             const std::vector<uint8_t> &dst_addr,
+             const uint16_t &prefix_len) {
+  key->setValue(
+      1, KeyFieldValueTernary<const uint8_t *>(vrf.data(), vrf_mask.data(), 2));
+  key->setValue(
+      2, KeyFieldValueLPM<const uint8_t *>(dst_addr.data(), prefix_len, 4));
+}
+
+bool keysEqual(const TableKey &key, const TableKey &other) {
+  bool is_equal = false;
+  EXPECT_EQ(key.equals(other, &is_equal), TDI_SUCCESS);
+  uint64_t hash = 0, other_hash = 0;
+  EXPECT_EQ(key.hash(&hash), TDI_SUCCESS);
+  EXPECT_EQ(other.hash(&other_hash), TDI_SUCCESS);
+  if (is_equal) {
+    EXPECT_EQ(hash, other_hash);
+  }
+  return is_equal;
+}
+}  // anonymous namespace
+
+/**
+ * @brief Test that ternary and LPM keys differing only in don't care bits
+ * serialize, hash and compare equal
+ */
+TEST_P(TnaExactMatchInfo, tableKey_canonical) {
+  // Make ipRoute's vrf ternary and hdr.ipv4.dst_addr LPM
+  std::string content =
+      getTestJsonFileContent(std::get<0>(GetParam()), program_name);
+  size_t pos = content.find("\"name\" : \"vrf\"");
+  ASSERT_NE(pos, std::string::npos);
+  const std::string exact = "\"match_type\" : \"Exact\"";
+  pos = content.find(exact, pos);
+  ASSERT_NE(pos, std::string::npos);
+  content.replace(pos, exact.size(), "\"match_type\" : \"Ternary\"");
+  pos = content.find(exact, pos);
+  ASSERT_NE(pos, std::string::npos);
+  content.replace(pos, exact.size(), "\"match_type\" : \"LPM\"");
+
+  TestTmpDir tmp_dir;
+  ASSERT_FALSE(tmp_dir.pathGet().empty());
+  auto info = tmp_dir.tdiInfoMake(program_name, content);
+  ASSERT_NE(info, nullptr);
+  const Table *table = nullptr;
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  ASSERT_EQ(static_cast<uint32_t>(
+                table->tableInfoGet()->keyFieldGet(1)->matchTypeGet()),
+            TDI_MATCH_TYPE_TERNARY);
+  ASSERT_EQ(static_cast<uint32_t>(
+                table->tableInfoGet()->keyFieldGet(2)->matchTypeGet()),
+            TDI_MATCH_TYPE_LPM);
+
+  MatchBytesKey key(table), same_key(table), other_key(table);
+  keyFill(&key, {0x00, 0x05}, {0x00, 0xff}, {10, 0, 0, 0}, 8);
+  // Only bits outside the mask and past the prefix differ
+  keyFill(&same_key, {0xab, 0x05}, {0x00, 0xff}, {10, 1, 2, 3}, 8);
+  size_t size = 0;
+  ASSERT_EQ(key.serializedSizeGet(&size), TDI_SUCCESS);
+  ASSERT_EQ(size, 10u);
+  std::vector<uint8_t> buf(size), same_buf(size);
+  ASSERT_EQ(key.serialize(buf.data(), size), TDI_SUCCESS);
+  ASSERT_EQ(same_key.serialize(same_buf.data(), size), TDI_SUCCESS);
+  const std::vector<uint8_t> expected = {
+      0x00, 0x05, 0x00, 0xff, 10, 0, 0, 0, 0, 8};
+  ASSERT_EQ(buf, expected);
+  ASSERT_EQ(same_buf, expected);
+  ASSERT_TRUE(keysEqual(key, same_key));
+
+  // Cared about bits, masks and prefix lengths still tell keys apart
+  keyFill(&other_key, {0x00, 0x06}, {0x00, 0xff}, {10, 0, 0, 0}, 8);
+  ASSERT_FALSE(keysEqual(key, other_key));
+  keyFill(&other_key, {0x00, 0x05}, {0x01, 0xff}, {10, 0, 0, 0}, 8);
+  ASSERT_FALSE(keysEqual(key, other_key));
+  keyFill(&other_key, {0x00, 0x05}, {0x00, 0xff}, {10, 0, 0, 0}, 9);
+  ASSERT_FALSE(keysEqual(key, other_key));
+  keyFill(&other_key, {0x00, 0x05}, {0x00, 0xff}, {11, 0, 0, 0}, 8);
+  ASSERT_FALSE(keysEqual(key, other_key));
+
+  // A prefix wider than the field can't be serialized
+  keyFill(&other_key, {0x00, 0x05}, {0x00, 0xff}, {10, 0, 0, 0}, 33);
+  ASSERT_EQ(other_key.serialize(buf.data(), size), TDI_INVALID_ARG);
+}
+
+/**
+ * @brief Test that packed keys of a field narrower than its bytes compare
+ * equal exactly when TableKey::equals says so
+ */
+TEST_P(TnaExactMatchInfo, packedKey_canonical) {
+  // Make ipRoute's vrf a 9 bit ternary field and hdr.ipv4.dst_addr LPM
+  std::string content =
+      getTestJsonFileContent(std::get<0>(GetParam()), program_name);
+  size_t pos = content.find("\"name\" : \"vrf\"");
+  ASSERT_NE(pos, std::string::npos);
+  const std::string exact = "\"match_type\" : \"Exact\"";
+  pos = content.find(exact, pos);
+  ASSERT_NE(pos, std::string::npos);
+  content.replace(pos, exact.size(), "\"match_type\" : \"Ternary\"");
+  const std::string width = "\"width\" : 16";
+  pos = content.find(width, pos);
+  ASSERT_NE(pos, std::string::npos);
+  content.replace(pos, width.size(), "\"width\" : 9");
+  pos = content.find(exact, pos);
+  ASSERT_NE(pos, std::string::npos);
+  content.replace(pos, exact.size(), "\"match_type\" : \"LPM\"");
+
+  TestTmpDir tmp_dir;
+  ASSERT_FALSE(tmp_dir.pathGet().empty());
+  auto info = tmp_dir.tdiInfoMake(program_name, content);
+  ASSERT_NE(info, nullptr);
+  const Table *table = nullptr;
+  ASSERT_EQ(info->tableFromNameGet("ipRoute", &table), TDI_SUCCESS);
+  ASSERT_EQ(table->tableInfoGet()->keyFieldGet(1)->sizeGet(), 9u);
+  const PackedKeyLayout *layout = nullptr;
+  ASSERT_EQ(table->packedKeyLayoutGet(&layout), TDI_SUCCESS);
+
+  MatchBytesKey key(table), other_key(table);
+  PackedKey packed(layout), other_packed(layout);
+  keyFill(&key, {0x00, 0x05}, {0x01, 0xff}, {10, 0, 0, 0}, 8);
+  ASSERT_EQ(packed.pack(key), TDI_SUCCESS);
+  auto check = [&](const bool &expect_equal) {
+    ASSERT_EQ(other_packed.pack(other_key), TDI_SUCCESS);
+    ASSERT_EQ(keysEqual(key, other_key), expect_equal);
+    ASSERT_EQ(packed == other_packed, expect_equal);
+    if (expect_equal) {
+      ASSERT_EQ(packed.hash(), other_packed.hash());
+    }
+  };
+  // Mask and value bits above the 9 bit width are don't care
+  keyFill(&other_key, {0x00, 0x05}, {0xff, 0xff}, {10, 0, 0, 0}, 8);
+  check(true);
+  keyFill(&other_key, {0xfe, 0x05}, {0xff, 0xff}, {10, 0, 0, 0}, 8);
+  check(true);
+  // Bit 8 is still part of the field
+  keyFill(&other_key, {0x01, 0x05}, {0x01, 0xff}, {10, 0, 0, 0}, 8);
+  check(false);
+  keyFill(&other_key, {0x00, 0x05}, {0x00, 0xff}, {10, 0, 0, 0}, 8);
+  check(false);
+}
+
+namespace {
+class TestTarget : public Target {
+ public:
+  TestTarget() : Target(0){};
+};
+
+// Table with a synchronous add and delete, for the default async APIs
+class SyncTable : public Table {
+ public:
+  SyncTable(const TdiInfo *tdi_info, const TableInfo *table_info)
+      : Table(tdi_info, table_info){};
+  tdi_status_t entryAdd(const Session &,
+                        const Target &,
+                        const Flags &,
+                        const TableKey &,
+                        const TableData &) const override {
+    return TDI_SUCCESS;
+  };
+  tdi_status_t entryDel(const Session &,
+                        const Target &,
+                        const Flags &,
+                        const TableKey &) const override {
+    return TDI_OBJECT_NOT_FOUND;
+  };
+};
+}  // anonymous namespace
+
+/**
+ * @brief Test the default async table APIs and their completion tokens
+ */
+TEST_P(TnaExactMatchInfo, asyncTableOps) {
+  const tdi::Table *ip_route;
+  ASSERT_EQ(tdi_info->tableFromNameGet("ipRoute", &ip_route), TDI_SUCCESS);
+  SyncTable table(tdi_info.get(), ip_route->tableInfoGet());
+  TestSession session;
+  TestTarget dev_tgt;
+  Flags flags(0);
+  ExactBytesKey key(&table);
+  TableData data(&table, 31369524);
+
+  std::future<tdi_status_t> added;
+  ASSERT_EQ(table.entryAddAsync(session,
+                                dev_tgt,
+                                flags,
+                                key,
+                                data,
+                                Table::completionFutureMake(&added)),
+            TDI_SUCCESS);
+  ASSERT_EQ(added.get(), TDI_SUCCESS);
+
+  std::vector<tdi_status_t> completions;
+  auto completion_cb = [&completions](const tdi_status_t &status) {
+    completions.push_back(status);
+  };
+  ASSERT_EQ(
+      table.entryDelAsync(session, dev_tgt, flags, key, completion_cb),
+      TDI_SUCCESS);
+  // Not supported by the table, reported through the callback
+  ASSERT_EQ(table.entryModAsync(
+                session, dev_tgt, flags, key, data, completion_cb),
+            TDI_SUCCESS);
+  ASSERT_EQ(session.completeOperations(), TDI_SUCCESS);
+  ASSERT_EQ(completions,
+            std::vector<tdi_status_t>({TDI_OBJECT_NOT_FOUND,
+                                       TDI_NOT_SUPPORTED}));
+
+  // No callback, nothing submitted
+  ASSERT_EQ(table.entryGetAsync(session, dev_tgt, flags, key, &data, nullptr),
+            TDI_INVALID_ARG);
+}
+
+namespace {
+// Table failing add, mod and delete for the keys in fail_keys_
+class BatchTable : public Table {
+ public:
+  BatchTable(const TdiInfo *tdi_info, const TableInfo *table_info)
+      : Table(tdi_info, table_info){};
+  tdi_status_t entryAdd(const Session &,
+                        const Target &,
+                        const Flags &,
+                        const TableKey &key,
+                        const TableData &) const override {
+    calls_++;
+    return fail_keys_.count(&key) ? TDI_ALREADY_EXISTS : TDI_SUCCESS;
+  };
+  tdi_status_t entryMod(const Session &,
+                        const Target &,
+                        const Flags &,
+                        const TableKey &key,
+                        const TableData &) const override {
+    calls_++;
+    return fail_keys_.count(&key) ? TDI_OBJECT_NOT_FOUND : TDI_SUCCESS;
+  };
+  tdi_status_t entryDel(const Session &,
+                        const Target &,
+                        const Flags &,
+                        const TableKey &key) const override {
+    calls_++;
+    return fail_keys_.count(&key) ? TDI_OBJECT_NOT_FOUND : TDI_SUCCESS;
+  };
+  std::set<const TableKey *> fail_keys_;
+  mutable size_t calls_ = 0;
+};
+}  // anonymous namespace
+
+/**
+ * @brief Test the default batch table APIs, every entry is attempted and the
+ * first failure is returned
+ */
+TEST_P(TnaExactMatchInfo, batchTableOps) {
+  const tdi::Table *ip_route;
+  ASSERT_EQ(tdi_info->tableFromNameGet("ipRoute", &ip_route), TDI_SUCCESS);
+  BatchTable table(tdi_info.get(), ip_route->tableInfoGet());
+  TestSession session;
+  TestTarget dev_tgt;
+  Flags flags(0);
+  ExactBytesKey key0(&table), key1(&table), key2(&table), key3(&table);
+  TableData data(&table, 31369524);
+  table.fail_keys_ = {&key1, &key3};
+
+  Table::constKeyDataPairs key_data_pairs = {
+      {&key0, &data}, {&key1, &data}, {&key2, &data}, {&key3, &data}};
+  // A stale status vector of a different size is resized to the batch
+  std::vector<tdi_status_t> status_vec(7, TDI_UNEXPECTED);
+  ASSERT_EQ(table.entryAddBatch(
+                session, dev_tgt, flags, key_data_pairs, &status_vec),
+            TDI_ALREADY_EXISTS);
+  ASSERT_EQ(table.calls_, 4u);
+  ASSERT_EQ(status_vec,
+            std::vector<tdi_status_t>({TDI_SUCCESS,
+                                       TDI_ALREADY_EXISTS,
+                                       TDI_SUCCESS,
+                                       TDI_ALREADY_EXISTS}));
+  ASSERT_EQ(
+      table.entryModBatch(session, dev_tgt, flags, key_data_pairs, nullptr),
+      TDI_OBJECT_NOT_FOUND);
+  ASSERT_EQ(table.calls_, 8u);
+
+  // Null keys or data fail only their own entry
+  table.fail_keys_.clear();
+  key_data_pairs = {{&key0, nullptr}, {&key1, &data}, {nullptr, &data}};
+  ASSERT_EQ(table.entryModBatch(
+                session, dev_tgt, flags, key_data_pairs, &status_vec),
+            TDI_INVALID_ARG);
+  ASSERT_EQ(table.calls_, 9u);
+  ASSERT_EQ(status_vec,
+            std::vector<tdi_status_t>(
+                {TDI_INVALID_ARG, TDI_SUCCESS, TDI_INVALID_ARG}));
+  table.fail_keys_ = {&key2};
+  ASSERT_EQ(table.entryDelBatch(
+                session, dev_tgt, flags, {&key2, nullptr, &key0}, &status_vec),
+            TDI_OBJECT_NOT_FOUND);
+  ASSERT_EQ(table.calls_, 11u);
+  ASSERT_EQ(status_vec,
+            std::vector<tdi_status_t>(
+                {TDI_OBJECT_NOT_FOUND, TDI_INVALID_ARG, TDI_SUCCESS}));
+  ASSERT_EQ(table.entryDelBatch(session, dev_tgt, flags, {}, &status_vec),
+            TDI_SUCCESS);
+  ASSERT_TRUE(status_vec.empty());
+
+  // C frontend, arrays have to be present for a non empty batch
+  auto table_hdl = reinterpret_cast<const tdi_table_hdl *>(&table);
+  auto session_hdl = reinterpret_cast<const tdi_session_hdl *>(&session);
+  auto target_hdl = reinterpret_cast<const tdi_target_hdl *>(&dev_tgt);
+  auto flags_hdl = reinterpret_cast<const tdi_flags_hdl *>(&flags);
+  const tdi_table_key_hdl *keys[] = {
+      reinterpret_cast<const tdi_table_key_hdl *>(&key0),
+      reinterpret_cast<const tdi_table_key_hdl *>(&key2)};
+  const tdi_table_data_hdl *datas[] = {
+      reinterpret_cast<const tdi_table_data_hdl *>(&data),
+      reinterpret_cast<const tdi_table_data_hdl *>(&data)};
+  tdi_status_t status_ret[2] = {TDI_UNEXPECTED, TDI_UNEXPECTED};
+  ASSERT_EQ(tdi_table_entry_add_batch(table_hdl,
+                                      session_hdl,
+                                      target_hdl,
+                                      flags_hdl,
+                                      keys,
+                                      nullptr,
+                                      2,
+                                      status_ret),
+            TDI_INVALID_ARG);
+  ASSERT_EQ(tdi_table_entry_del_batch(
+                table_hdl, session_hdl, target_hdl, flags_hdl, nullptr, 2,
+                status_ret),
+            TDI_INVALID_ARG);
+  ASSERT_EQ(table.calls_, 11u);
+  ASSERT_EQ(tdi_table_entry_add_batch(table_hdl,
+                                      session_hdl,
+                                      target_hdl,
+                                      flags_hdl,
+                                      keys,
+                                      datas,
+                                      2,
+                                      status_ret),
+            TDI_ALREADY_EXISTS);
+  ASSERT_EQ(status_ret[0], TDI_SUCCESS);
+  ASSERT_EQ(status_ret[1], TDI_ALREADY_EXISTS);
+  ASSERT_EQ(tdi_table_entry_mod_batch(table_hdl,
+                                      session_hdl,
+                                      target_hdl,
+                                      flags_hdl,
+                                      nullptr,
+                                      nullptr,
+                                      0,
+                                      nullptr),
+            TDI_SUCCESS);
+}
+
+namespace {
+// Key holding the position of an entry of ScanTable
+class IndexKey : public TableKey {
+ public:
+  IndexKey(const Table *table) : TableKey(table){};
+  tdi_status_t reset() override {
+    index_ = 0;
+    return TDI_SUCCESS;
+  };
+  uint32_t index_ = 0;
+};
+
+// Table with num_entries_ entries, readable with entryGetFirst and
+// entryGetNextN
+class ScanTable : public Table {
+ public:
+  ScanTable(const TdiInfo *tdi_info,
+            const TableInfo *table_info,
+            const uint32_t &num_entries)
+      : Table(tdi_info, table_info), num_entries_(num_entries){};
+  tdi_status_t keyAllocate(
+      std::unique_ptr<TableKey> *key_ret) const override {
+    key_ret->reset(new IndexKey(this));
+    return TDI_SUCCESS;
+  };
+  tdi_status_t dataAllocate(
+      std::unique_ptr<TableData> *data_ret) const override {
+    data_ret->reset(new TableData(this));
+    return TDI_SUCCESS;
+  };
+  tdi_status_t entryGetFirst(const Session &,
+                             const Target &,
+                             const Flags &,
+                             TableKey *key,
+                             TableData *) const override {
+    if (num_entries_ == 0) return TDI_OBJECT_NOT_FOUND;
+    static_cast<IndexKey *>(key)->index_ = 0;
+    return TDI_SUCCESS;
+  };
+  tdi_status_t entryGetNextN(const Session &,
+                             const Target &,
+                             const Flags &,
+                             const TableKey &key,
+                             const uint32_t &n,
+                             keyDataPairs *key_data_pairs,
+                             uint32_t *num_returned) const override {
+    uint32_t index = static_cast<const IndexKey &>(key).index_ + 1;
+    *num_returned = 0;
+    while (*num_returned < n && index < num_entries_) {
+      static_cast<IndexKey *>((*key_data_pairs)[*num_returned].first)
+          ->index_ = index++;
+      (*num_returned)++;
+    }
+    return *num_returned < n ? TDI_OBJECT_NOT_FOUND : TDI_SUCCESS;
+  };
+  const uint32_t num_entries_;
+};
+
+// Chunk sizes and entry positions returned by a whole scan of table
+tdi_status_t scanAll(const ScanTable &table,
+                     const uint32_t &chunk_size,
+                     const bool &prefetch,
+                     std::vector<uint32_t> *chunk_sizes,
+                     std::vector<uint32_t> *indices) {
+  TestSession session;
+  TestTarget dev_tgt;
+  Flags flags(0);
+  std::unique_ptr<Table::EntryIterator> iter;
+  auto status =
+      table.entryScan(session, dev_tgt, flags, chunk_size, prefetch, &iter);
+  if (status != TDI_SUCCESS) return status;
+  while (true) {
+    const Table::constKeyDataPairs *chunk = nullptr;
+    uint32_t num_returned = 0;
+    status = iter->next(&chunk, &num_returned);
+    if (status != TDI_SUCCESS || num_returned == 0) return status;
+    chunk_sizes->push_back(num_returned);
+    for (uint32_t i = 0; i < num_returned; i++) {
+      indices->push_back(
+          static_cast<const IndexKey *>((*chunk)[i].first)->index_);
+    }
+  }
+}
+}  // anonymous namespace
+
+/**
+ * @brief Test Table::entryScan() chunking, on empty tables and around chunk
+ * boundaries, with and without prefetch
+ */
+TEST_P(TnaExactMatchInfo, entryScan) {
+  const tdi::Table *ip_route;
+  ASSERT_EQ(tdi_info->tableFromNameGet("ipRoute", &ip_route), TDI_SUCCESS);
+  const uint32_t chunk_size = 4;
+  for (uint32_t num_entries : {0u, 1u, 3u, 4u, 5u, 8u, 13u}) {
+    ScanTable table(tdi_info.get(), ip_route->tableInfoGet(), num_entries);
+    std::vector<uint32_t> expected_indices;
+    for (uint32_t i = 0; i < num_entries; i++) expected_indices.push_back(i);
+    std::vector<uint32_t> expected_sizes(num_entries / chunk_size,
+                                         chunk_size);
+    if (num_entries % chunk_size) {
+      expected_sizes.push_back(num_entries % chunk_size);
+    }
+    for (bool prefetch : {false, true}) {
+      std::vector<uint32_t> chunk_sizes, indices;
+      ASSERT_EQ(
+          scanAll(table, chunk_size, prefetch, &chunk_sizes, &indices),
+          TDI_SUCCESS);
+      ASSERT_EQ(chunk_sizes, expected_sizes)
+          << num_entries << " entries, prefetch " << prefetch;
+      ASSERT_EQ(indices, expected_indices)
+          << num_entries << " entries, prefetch " << prefetch;
+    }
+    // One entry per chunk, only entryGetFirst for the first one
+    std::vector<uint32_t> chunk_sizes, indices;
+    ASSERT_EQ(scanAll(table, 1, true, &chunk_sizes, &indices), TDI_SUCCESS);
+    ASSERT_EQ(chunk_sizes, std::vector<uint32_t>(num_entries, 1));
+    ASSERT_EQ(indices, expected_indices);
+  }
+
+  ScanTable table(tdi_info.get(), ip_route->tableInfoGet(), 100);
+  TestSession session;
+  TestTarget dev_tgt;
+  Flags flags(0);
+  std::unique_ptr<Table::EntryIterator> iter;
+  ASSERT_EQ(table.entryScan(session, dev_tgt, flags, 0, true, &iter),
+            TDI_INVALID_ARG);
+  ASSERT_EQ(table.entryScan(session, dev_tgt, flags, 4, true, nullptr),
+            TDI_INVALID_ARG);
+  // Dropping the iterator with a prefetch in flight
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(table.entryScan(session, dev_tgt, flags, 4, true, &iter),
+              TDI_SUCCESS);
+    const Table::constKeyDataPairs *chunk = nullptr;
+    uint32_t num_returned = 0;
+    ASSERT_EQ(iter->next(&chunk, &num_returned), TDI_SUCCESS);
+    ASSERT_EQ(num_returned, 4u);
+    iter.reset();
+  }
+}
+
+namespace {
+// Key counting the live keys of its table in live
+class PoolKey : public IndexKey {
+ public:
+  PoolKey(const Table *table, std::shared_ptr<std::atomic<int>> live)
+      : IndexKey(table), live_(live) {
+    (*live_)++;
+  };
+  ~PoolKey() { (*live_)--; };
+
+ private:
+  std::shared_ptr<std::atomic<int>> live_;
+};
+
+// Table counting the allocations and resets behind its object pools
+class PoolTable : public ScanTable {
+ public:
+  PoolTable(const TdiInfo *tdi_info, const TableInfo *table_info)
+      : ScanTable(tdi_info, table_info, 0){};
+  tdi_status_t keyAllocate(
+      std::unique_ptr<TableKey> *key_ret) const override {
+    key_allocs_++;
+    key_ret->reset(new PoolKey(this, live_keys_));
+    return TDI_SUCCESS;
+  };
+  tdi_status_t keyReset(TableKey *key) const override {
+    key_resets_++;
+    key->reset();
+    return reset_status_;
+  };
+  tdi_status_t dataAllocate(
+      std::unique_ptr<TableData> *data_ret) const override {
+    data_allocs_++;
+    return ScanTable::dataAllocate(data_ret);
+  };
+  tdi_status_t dataAllocate(
+      const tdi_id_t &action_id,
+      std::unique_ptr<TableData> *data_ret) const override {
+    data_allocs_++;
+    data_ret->reset(new TableData(this, action_id));
+    return TDI_SUCCESS;
+  };
+  tdi_status_t dataReset(TableData *data) const override {
+    return data->reset();
+  };
+  tdi_status_t dataReset(const tdi_id_t &action_id,
+                         TableData *data) const override {
+    return data->reset(action_id);
+  };
+  std::shared_ptr<std::atomic<int>> live_keys_ =
+      std::make_shared<std::atomic<int>>(0);
+  tdi_status_t reset_status_ = TDI_SUCCESS;
+  mutable size_t key_allocs_ = 0;
+  mutable size_t key_resets_ = 0;
+  mutable size_t data_allocs_ = 0;
+};
+}  // anonymous namespace
+
+/**
+ * @brief Test the per-thread key and data free lists of Table
+ */
+TEST_P(TnaExactMatchInfo, objectPool) {
+  const tdi::Table *ip_route;
+  ASSERT_EQ(tdi_info->tableFromNameGet("ipRoute", &ip_route), TDI_SUCCESS);
+  const tdi_id_t action_id = 31369524;
+  PoolTable table(tdi_info.get(), ip_route->tableInfoGet());
+  PoolTable other(tdi_info.get(), ip_route->tableInfoGet());
+
+  // Released keys are reset and reused, foreign keys are rejected
+  std::vector<std::unique_ptr<TableKey>> keys;
+  ASSERT_EQ(table.keyAllocateN(3, &keys), TDI_SUCCESS);
+  static_cast<IndexKey *>(keys[0].get())->index_ = 7;
+  ASSERT_EQ(other.keyAllocateN(1, &keys), TDI_SUCCESS);
+  ASSERT_EQ(keys.size(), 4u);
+  ASSERT_EQ(table.keyRelease(&keys), TDI_INVALID_ARG);
+  ASSERT_TRUE(keys.empty());
+  ASSERT_EQ(table.key_resets_, 3u);
+  ASSERT_EQ(*other.live_keys_, 0);
+  ASSERT_EQ(table.keyAllocateN(4, &keys), TDI_SUCCESS);
+  ASSERT_EQ(table.key_allocs_, 4u);
+  for (const auto &key : keys) {
+    ASSERT_EQ(static_cast<IndexKey *>(key.get())->index_, 0u);
+  }
+  // Keys which can't be reset are freed
+  table.reset_status_ = TDI_NOT_SUPPORTED;
+  ASSERT_EQ(table.keyRelease(&keys), TDI_SUCCESS);
+  ASSERT_EQ(*table.live_keys_, 0);
+  ASSERT_EQ(table.keyAllocateN(2, &keys), TDI_SUCCESS);
+  ASSERT_EQ(table.key_allocs_, 6u);
+  table.reset_status_ = TDI_SUCCESS;
+  ASSERT_EQ(table.keyRelease(&keys), TDI_SUCCESS);
+  ASSERT_EQ(table.keyRelease(nullptr), TDI_INVALID_ARG);
+
+  // Data objects are reset on release, and to the action on allocation
+  std::vector<std::unique_ptr<TableData>> data;
+  ASSERT_EQ(table.dataAllocateN(action_id, 2, &data), TDI_SUCCESS);
+  ASSERT_EQ(table.dataRelease(&data), TDI_SUCCESS);
+  ASSERT_EQ(table.dataAllocateN(1, &data), TDI_SUCCESS);
+  ASSERT_EQ(data[0]->actionIdGet(), 0u);
+  ASSERT_EQ(table.dataAllocateN(action_id, 1, &data), TDI_SUCCESS);
+  ASSERT_EQ(data[1]->actionIdGet(), action_id);
+  ASSERT_EQ(table.data_allocs_, 2u);
+  ASSERT_EQ(other.dataAllocateN(1, &data), TDI_SUCCESS);
+  ASSERT_EQ(table.dataRelease(&data), TDI_INVALID_ARG);
+  ASSERT_TRUE(data.empty());
+
+  // Free lists are per thread, and go away with their thread
+  ASSERT_EQ(*table.live_keys_, 2);
+  std::thread thread([&table]() {
+    std::vector<std::unique_ptr<TableKey>> thread_keys;
+    table.keyAllocateN(3, &thread_keys);
+    table.keyRelease(&thread_keys);
+  });
+  thread.join();
+  ASSERT_EQ(table.key_allocs_, 9u);
+  ASSERT_EQ(*table.live_keys_, 2);
+
+  // A destroyed table frees the free lists of all threads right away
+  std::unique_ptr<PoolTable> gone(
+      new PoolTable(tdi_info.get(), ip_route->tableInfoGet()));
+  auto gone_live_keys = gone->live_keys_;
+  ASSERT_EQ(gone->keyAllocateN(5, &keys), TDI_SUCCESS);
+  ASSERT_EQ(gone->keyRelease(&keys), TDI_SUCCESS);
+  std::atomic<bool> released{false};
+  std::thread gone_thread([&gone, &released]() {
+    std::vector<std::unique_ptr<TableKey>> thread_keys;
+    gone->keyAllocateN(8, &thread_keys);
+    gone->keyRelease(&thread_keys);
+    released = true;
+    // Keep the thread, and its free list, around past the table
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  });
+  while (!released) std::this_thread::yield();
+  ASSERT_EQ(gone->key_allocs_, 13u);
+  gone.reset();
+  ASSERT_EQ(*gone_live_keys, 0);
+  gone_thread.join();
+  PoolTable next(tdi_info.get(), ip_route->tableInfoGet());
+  ASSERT_EQ(next.keyAllocateN(1, &keys), TDI_SUCCESS);
+  ASSERT_EQ(next.key_allocs_, 1u);
+}
+
+#ifdef TDI_CODEGEN_TEST
+TEST_P(TnaExactMatchInfo, generatedTypedTables) {
+  using namespace tna_exact_match;
+  static_assert(IpRoute::kId == 34746517, "table ID");
+  static_assert(IpRoute::KeyId::hdr_ipv4_dst_addr == 2, "key field ID");
+  static_assert(IpRoute::KeyWidth::vrf == 16, "key field width");
+  static_assert(IpRoute::Actions::Route::kId == 31369524, "action ID");
+  static_assert(IpRoute::Actions::Route::DataId::dst_port == 3, "data ID");
+  static_assert(IpRoute::DataId::COUNTER_SPEC_BYTES == 65553, "data ID");
+  ASSERT_EQ(verify(*tdi_info), TDI_SUCCESS);
+
+  const tdi::Table *table;
+  auto status = tdi_info->tableFromIdGet(IpRoute::kId, &table);
+  ASSERT_EQ(status, TDI_SUCCESS);
+  IpRoute::Key typed_key;
+  typed_key.vrf = 5;
+  typed_key.hdr_ipv4_dst_addr = 0x0a000001;
+  ExactBytesKey key(table);
+  ASSERT_EQ(typed_key.fill(&key), TDI_SUCCESS);
+
+  const PackedKeyLayout *layout = nullptr;
+  ASSERT_EQ(table->packedKeyLayoutGet(&layout), TDI_SUCCESS);
+  PackedKey packed(layout);
+  ASSERT_EQ(packed.pack(key), TDI_SUCCESS);
+  const uint8_t value[] = {0x00, 0x05, 10, 0, 0, 1, 0, 0};
+  ASSERT_EQ(std::memcmp(packed.valueGet(), value, 8), 0);
+}
+#endif
+
 }  // namespace tdi_test
 }  // namespace tdi
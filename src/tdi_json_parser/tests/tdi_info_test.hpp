@@ -21,8 +21,14 @@
 #include <sched.h>
 #include <string.h>
 
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
 #include <memory>
 #include <map>
+#include <string>
 #include <tuple>
 
 /* tdi_includes */
@@ -59,6 +65,69 @@ std::string getTestJsonFileContent(const std::string &filename,
   return content;
 }
 
+// Parser with the dummy mapper, bypassing the schema cache
+std::unique_ptr<TdiInfoParser> testParserMake() {
+  auto tdi_info_parser = std::unique_ptr<TdiInfoParser>(new TdiInfoParser(
+      std::unique_ptr<tdi::TdiInfoMapper>(
+          new tdi::tna::dummy::TdiInfoMapper())));
+  tdi_info_parser->schemaCacheDirSet("");
+  return tdi_info_parser;
+}
+
+// Temporary directory for the files of a test. It is removed with the files
+// in it when it goes out of scope, also when an ASSERT returns early
+class TestTmpDir {
+ public:
+  TestTmpDir() {
+    char path[] = "/tmp/tdi_test_XXXXXX";
+    if (mkdtemp(path)) path_ = path;
+  }
+  ~TestTmpDir() {
+    if (path_.empty()) return;
+    DIR *dir = opendir(path_.c_str());
+    if (dir) {
+      for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        std::remove((path_ + "/" + name).c_str());
+      }
+      closedir(dir);
+    }
+    rmdir(path_.c_str());
+  }
+  TestTmpDir(const TestTmpDir &) = delete;
+  TestTmpDir &operator=(const TestTmpDir &) = delete;
+
+  // Empty if the directory couldn't be created
+  const std::string &pathGet() const { return path_; }
+
+  // Write a file into the directory, returns its path
+  std::string fileWrite(const std::string &name,
+                        const std::string &content) const {
+    std::string file_path = path_ + "/" + name;
+    std::ofstream(file_path) << content;
+    return file_path;
+  }
+
+  // Make a TdiInfo with the dummy objects out of tdi.json content, nullptr
+  // if it doesn't parse
+  std::unique_ptr<const TdiInfo> tdiInfoMake(
+      const std::string &program_name, const std::string &content) const {
+    auto tdi_info_parser = testParserMake();
+    if (tdi_info_parser->parseTdiInfo({fileWrite("tdi.json", content)}) !=
+        TDI_SUCCESS) {
+      return nullptr;
+    }
+    return TdiInfo::makeTdiInfo(program_name,
+                                std::move(tdi_info_parser),
+                                std::unique_ptr<const TableFactory>(
+                                    new tdi::tna::dummy::TableFactory()));
+  }
+
+ private:
+  std::string path_;
+};
+
 template <class T>
 void setupInternal(T *obj) {
   auto t = obj->GetParam();
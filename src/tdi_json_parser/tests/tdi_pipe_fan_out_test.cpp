@@ -0,0 +1,102 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <tdi/common/tdi_utils.hpp>
+#include <tdi/arch/tna/tna_target.hpp>
+
+namespace tdi {
+namespace tdi_test {
+
+namespace {
+class PipeTarget : public Target {
+ public:
+  PipeTarget(const uint64_t &pipe) : Target(0), pipe_(pipe){};
+  tdi_status_t getValue(const tdi_target_e &target,
+                        uint64_t *value) const override {
+    if (target != static_cast<tdi_target_e>(TDI_TNA_TARGET_PIPE_ID)) {
+      return Target::getValue(target, value);
+    }
+    *value = pipe_;
+    return TDI_SUCCESS;
+  };
+
+ private:
+  uint64_t pipe_;
+};
+}  // anonymous namespace
+
+/**
+ * @brief Test that PipeFanOut programs every pipe for the all pipes
+ * target and merges the statuses in pipe order
+ */
+TEST(PipeFanOut, run) {
+  TdiThreadPool pool(2);
+  tna::PipeFanOut fan_out(&pool);
+  const std::vector<uint64_t> pipes = {0, 1, 2, 3};
+  std::mutex mtx;
+  std::set<uint64_t> programmed;
+  auto program = [&](const uint64_t &pipe) {
+    std::lock_guard<std::mutex> lock(mtx);
+    programmed.insert(pipe);
+    return pipe >= 2 ? static_cast<tdi_status_t>(TDI_NO_SPACE + pipe - 2)
+                     : TDI_SUCCESS;
+  };
+
+  ASSERT_EQ(fan_out.run(PipeTarget(TNA_DEV_PIPE_ALL), pipes, program),
+            TDI_NO_SPACE);
+  ASSERT_EQ(programmed, std::set<uint64_t>(pipes.begin(), pipes.end()));
+  programmed.clear();
+  ASSERT_EQ(fan_out.run(PipeTarget(1), pipes, program), TDI_SUCCESS);
+  ASSERT_EQ(programmed, std::set<uint64_t>({1}));
+
+  // Entry i of the batch fails in pipe i
+  std::vector<tdi_status_t> status_vec;
+  ASSERT_EQ(fan_out.runBatch(
+                PipeTarget(TNA_DEV_PIPE_ALL),
+                pipes,
+                3,
+                [](const uint64_t &pipe, std::vector<tdi_status_t> *statuses) {
+                  if (pipe >= statuses->size()) return TDI_SUCCESS;
+                  (*statuses)[pipe] = TDI_OBJECT_NOT_FOUND;
+                  return TDI_OBJECT_NOT_FOUND;
+                },
+                &status_vec),
+            TDI_OBJECT_NOT_FOUND);
+  ASSERT_EQ(status_vec, std::vector<tdi_status_t>(3, TDI_OBJECT_NOT_FOUND));
+
+  // Fan outs started from a task of the same pool don't wait on it
+  auto nested = pool.submitTask([&]() {
+    return fan_out.run(PipeTarget(TNA_DEV_PIPE_ALL),
+                       pipes,
+                       [](const uint64_t &) { return TDI_SUCCESS; });
+  });
+  auto nested_other = pool.submitTask([&]() {
+    return fan_out.run(PipeTarget(TNA_DEV_PIPE_ALL),
+                       pipes,
+                       [](const uint64_t &) { return TDI_SUCCESS; });
+  });
+  ASSERT_EQ(nested.get(), TDI_SUCCESS);
+  ASSERT_EQ(nested_other.get(), TDI_SUCCESS);
+}
+
+}  // namespace tdi_test
+}  // namespace tdi
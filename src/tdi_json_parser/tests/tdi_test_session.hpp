@@ -0,0 +1,48 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _TDI_TEST_SESSION_HPP
+#define _TDI_TEST_SESSION_HPP
+
+#include <tdi/common/tdi_session.hpp>
+
+namespace tdi {
+namespace tdi_test {
+
+// Session doing nothing, for tests which only need a Session object
+class TestSession : public Session {
+ public:
+  TestSession() : Session({}){};
+  tdi_status_t create() override { return TDI_SUCCESS; };
+  tdi_status_t destroy() override { return TDI_SUCCESS; };
+  tdi_status_t completeOperations() const override { return TDI_SUCCESS; };
+  tdi_handle_t handleGet(const tdi_mgr_type_e &) const override {
+    return 0;
+  };
+  tdi_status_t beginBatch() const override { return TDI_SUCCESS; };
+  tdi_status_t flushBatch() const override { return TDI_SUCCESS; };
+  tdi_status_t endBatch(bool) const override { return TDI_SUCCESS; };
+  tdi_status_t beginTransaction(bool) const override { return TDI_SUCCESS; };
+  tdi_status_t verifyTransaction() const override { return TDI_SUCCESS; };
+  tdi_status_t commitTransaction(bool) const override {
+    return TDI_SUCCESS;
+  };
+  tdi_status_t abortTransaction() const override { return TDI_SUCCESS; };
+};
+
+}  // namespace tdi_test
+}  // namespace tdi
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+#include <tdi/common/tdi_utils.hpp>
+
+namespace tdi {
+namespace tdi_test {
+
+/**
+ * @brief Test TdiThreadPool results, subtasks, backpressure and draining
+ * on destruction
+ */
+TEST(TdiThreadPool, submitTask) {
+  std::atomic<int> count(0);
+  {
+    TdiThreadPool pool(4, 0, {0});
+    ASSERT_EQ(pool.threadsGet(), 4u);
+    auto sum = pool.submitTask([](int a, int b) { return a + b; }, 2, 3);
+    ASSERT_EQ(sum.get(), 5);
+    auto error =
+        pool.submitTask([]() -> int { throw std::runtime_error("task"); });
+    ASSERT_THROW(error.get(), std::runtime_error);
+
+    // Subtasks go to the deque of the submitting worker. Nothing waits for
+    // them, the pool runs them before it goes away
+    for (int i = 0; i < 100; i++) {
+      pool.submitTask([&pool, &count]() {
+        count++;
+        pool.submitTask([&count]() { count++; });
+      });
+    }
+  }
+  ASSERT_EQ(count.load(), 200);
+
+  // One worker blocked and room for one queued task
+  TdiThreadPool pool(1, 1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  auto started = std::make_shared<std::promise<void>>();
+  auto blocker = pool.submitTask([released, started]() {
+    started->set_value();
+    released.wait();
+  });
+  started->get_future().wait();
+  auto queued = pool.submitTask([]() {});
+  ASSERT_EQ(pool.getQueueSize(), 1u);
+  auto submitter = std::async(std::launch::async, [&pool]() {
+    return pool.submitTask([]() { return 7; }).get();
+  });
+  ASSERT_EQ(submitter.wait_for(std::chrono::milliseconds(50)),
+            std::future_status::timeout);
+  release.set_value();
+  ASSERT_EQ(submitter.get(), 7);
+  blocker.get();
+  queued.get();
+}
+
+}  // namespace tdi_test
+}  // namespace tdi
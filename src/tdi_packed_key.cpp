@@ -0,0 +1,239 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <tdi/common/tdi_packed_key.hpp>
+#include <tdi/common/tdi_table.hpp>
+#include <tdi/common/tdi_utils.hpp>
+
+namespace tdi {
+
+namespace {
+// Set the mask of the most significant prefix_len bits of a big endian
+// field of the given width
+void prefixMaskSet(const size_t &width,
+                   const size_t &size,
+                   const uint16_t &prefix_len,
+                   uint8_t *mask) {
+  std::memset(mask, 0, size);
+  for (size_t i = 0; i < prefix_len; i++) {
+    size_t bit = width - 1 - i;
+    mask[size - 1 - bit / 8] |= static_cast<uint8_t>(1 << (bit % 8));
+  }
+}
+}  // anonymous namespace
+
+tdi_status_t PackedKeyLayout::layoutCreate(
+    const TableInfo *table_info, std::unique_ptr<PackedKeyLayout> *layout) {
+  if (!table_info || !layout) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  std::unique_ptr<PackedKeyLayout> new_layout(new PackedKeyLayout(table_info));
+  size_t offset = 0;
+  for (uint32_t i = 0; i < table_info->keyFieldCountGet(); i++) {
+    const KeyFieldInfo *field_info = table_info->keyFieldByOrdinalGet(i);
+    switch (static_cast<uint32_t>(field_info->matchTypeGet())) {
+      case TDI_MATCH_TYPE_EXACT:
+      case TDI_MATCH_TYPE_TERNARY:
+      case TDI_MATCH_TYPE_LPM:
+      case TDI_MATCH_TYPE_RANGE:
+        break;
+      default:
+        LOG_ERROR("%s:%d %s : Key field %s : match type %d not supported",
+                  __func__,
+                  __LINE__,
+                  table_info->nameGet().c_str(),
+                  field_info->nameGet().c_str(),
+                  static_cast<int>(field_info->matchTypeGet()));
+        return TDI_NOT_SUPPORTED;
+    }
+    if (field_info->isPtrGet() || !field_info->sizeGet()) {
+      LOG_ERROR("%s:%d %s : Key field %s : variable size fields not supported",
+                __func__,
+                __LINE__,
+                table_info->nameGet().c_str(),
+                field_info->nameGet().c_str());
+      return TDI_NOT_SUPPORTED;
+    }
+    Field field;
+    field.id_ = field_info->idGet();
+    field.match_type_ = field_info->matchTypeGet();
+    field.width_ = field_info->sizeGet();
+    field.offset_ = offset;
+    field.size_ = (field.width_ + 7) / 8;
+    offset += field.size_;
+    new_layout->fields_.push_back(field);
+  }
+  new_layout->size_ = (offset + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+  new_layout->exact_mask_.assign(new_layout->size_, 0);
+  for (const auto &field : new_layout->fields_) {
+    prefixMaskSet(field.width_,
+                  field.size_,
+                  static_cast<uint16_t>(field.width_),
+                  new_layout->exact_mask_.data() + field.offset_);
+  }
+  *layout = std::move(new_layout);
+  return TDI_SUCCESS;
+}
+
+tdi_status_t PackedKey::pack(const TableKey &key) {
+  const Table *table = nullptr;
+  auto status = key.tableGet(&table);
+  if (status != TDI_SUCCESS || !table ||
+      table->tableInfoGet() != layout_->tableInfoGet()) {
+    LOG_ERROR("%s:%d %s : Key does not belong to this table",
+              __func__,
+              __LINE__,
+              layout_->tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  std::fill(words_.begin(), words_.end(), 0);
+  uint8_t *value_buf = valueMutableGet();
+  uint8_t *mask_buf = maskMutableGet();
+  for (const auto &field : layout_->fieldsGet()) {
+    uint8_t *value = value_buf + field.offset_;
+    uint8_t *mask = mask_buf + field.offset_;
+    const uint8_t *width_mask = layout_->exactMaskGet() + field.offset_;
+    bool apply_mask = true;
+    switch (static_cast<uint32_t>(field.match_type_)) {
+      case TDI_MATCH_TYPE_EXACT: {
+        KeyFieldValueExact<uint8_t *> field_value(value, field.size_);
+        status = key.getValue(field.id_, &field_value);
+        std::memcpy(mask, width_mask, field.size_);
+        break;
+      }
+      case TDI_MATCH_TYPE_TERNARY: {
+        KeyFieldValueTernary<uint8_t *> field_value(value, mask, field.size_);
+        status = key.getValue(field.id_, &field_value);
+        for (size_t i = 0; i < field.size_; i++) mask[i] &= width_mask[i];
+        break;
+      }
+      case TDI_MATCH_TYPE_LPM: {
+        KeyFieldValueLPM<uint8_t *> field_value(value, 0, field.size_);
+        status = key.getValue(field.id_, &field_value);
+        if (status == TDI_SUCCESS && field_value.prefix_len_ > field.width_) {
+          LOG_ERROR("%s:%d %s : Prefix length %d of field %d exceeds width",
+                    __func__,
+                    __LINE__,
+                    layout_->tableInfoGet()->nameGet().c_str(),
+                    field_value.prefix_len_,
+                    field.id_);
+          return TDI_INVALID_ARG;
+        }
+        prefixMaskSet(field.width_, field.size_, field_value.prefix_len_, mask);
+        break;
+      }
+      case TDI_MATCH_TYPE_RANGE: {
+        KeyFieldValueRange<uint8_t *> field_value(value, mask, field.size_);
+        status = key.getValue(field.id_, &field_value);
+        // Low and high bounds live in value and mask; clip both to the width
+        for (size_t i = 0; i < field.size_; i++) {
+          value[i] &= width_mask[i];
+          mask[i] &= width_mask[i];
+        }
+        apply_mask = false;
+        break;
+      }
+      default:
+        status = TDI_NOT_SUPPORTED;
+        break;
+    }
+    if (status != TDI_SUCCESS) {
+      LOG_ERROR("%s:%d %s : Unable to get value of key field %d",
+                __func__,
+                __LINE__,
+                layout_->tableInfoGet()->nameGet().c_str(),
+                field.id_);
+      return status;
+    }
+    // Canonicalize so that keys matching the same packets compare equal
+    if (apply_mask) {
+      for (size_t i = 0; i < field.size_; i++) value[i] &= mask[i];
+    }
+  }
+  return TDI_SUCCESS;
+}
+
+tdi_status_t PackedKey::unpack(TableKey *key) const {
+  if (!key) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  const Table *table = nullptr;
+  auto status = key->tableGet(&table);
+  if (status != TDI_SUCCESS || !table ||
+      table->tableInfoGet() != layout_->tableInfoGet()) {
+    LOG_ERROR("%s:%d %s : Key does not belong to this table",
+              __func__,
+              __LINE__,
+              layout_->tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  const uint8_t *value_buf = valueGet();
+  const uint8_t *mask_buf = maskGet();
+  for (const auto &field : layout_->fieldsGet()) {
+    const uint8_t *value = value_buf + field.offset_;
+    const uint8_t *mask = mask_buf + field.offset_;
+    switch (static_cast<uint32_t>(field.match_type_)) {
+      case TDI_MATCH_TYPE_EXACT: {
+        KeyFieldValueExact<const uint8_t *> field_value(value, field.size_);
+        status = key->setValue(field.id_, field_value);
+        break;
+      }
+      case TDI_MATCH_TYPE_TERNARY: {
+        KeyFieldValueTernary<const uint8_t *> field_value(
+            value, mask, field.size_);
+        status = key->setValue(field.id_, field_value);
+        break;
+      }
+      case TDI_MATCH_TYPE_LPM: {
+        uint16_t prefix_len = 0;
+        for (size_t i = 0; i < field.size_; i++) {
+          for (uint8_t m = mask[i]; m; m &= static_cast<uint8_t>(m - 1)) {
+            prefix_len++;
+          }
+        }
+        KeyFieldValueLPM<const uint8_t *> field_value(
+            value, prefix_len, field.size_);
+        status = key->setValue(field.id_, field_value);
+        break;
+      }
+      case TDI_MATCH_TYPE_RANGE: {
+        KeyFieldValueRange<const uint8_t *> field_value(
+            value, mask, field.size_);
+        status = key->setValue(field.id_, field_value);
+        break;
+      }
+      default:
+        status = TDI_NOT_SUPPORTED;
+        break;
+    }
+    if (status != TDI_SUCCESS) {
+      LOG_ERROR("%s:%d %s : Unable to set value of key field %d",
+                __func__,
+                __LINE__,
+                layout_->tableInfoGet()->nameGet().c_str(),
+                field.id_);
+      return status;
+    }
+  }
+  return TDI_SUCCESS;
+}
+
+}  // namespace tdi
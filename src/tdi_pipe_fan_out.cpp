@@ -0,0 +1,159 @@
+/*
+ * Copyright(c) 2021 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this software except as stipulated in the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <tdi/common/tdi_pipe_fan_out.hpp>
+
+// local includes
+#include <tdi/common/tdi_utils.hpp>
+
+namespace tdi {
+
+namespace {
+// Shared by the caller and the pool tasks of one fan out. Every thread
+// claims indices until none is left, so tasks starting late find nothing
+// to do and only touch this state
+class FanOutState {
+ public:
+  FanOutState(const size_t &count,
+              const std::function<tdi_status_t(const size_t &i)> *op)
+      : count_(count), op_(op), statuses_(count, TDI_SUCCESS){};
+
+  void drain() {
+    size_t i;
+    while ((i = next_.fetch_add(1)) < count_) {
+      tdi_status_t status = TDI_UNEXPECTED;
+      try {
+        status = (*op_)(i);
+      } catch (...) {
+        LOG_ERROR("%s:%d Exception in the programming of pipe index %zu",
+                  __func__,
+                  __LINE__,
+                  i);
+      }
+      statuses_[i] = status;
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (++done_ == count_) cond_var_.notify_all();
+    }
+  }
+
+  // Wait for the indices claimed by other threads
+  const std::vector<tdi_status_t> &wait() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cond_var_.wait(lock, [this]() { return done_ == count_; });
+    return statuses_;
+  }
+
+ private:
+  const size_t count_;
+  // Only called for claimed indices, which the caller waits for
+  const std::function<tdi_status_t(const size_t &i)> *op_;
+  std::atomic<size_t> next_{0};
+  std::vector<tdi_status_t> statuses_;
+  size_t done_{0};  // Guarded by mtx_
+  std::mutex mtx_;
+  std::condition_variable cond_var_;
+};
+}  // anonymous namespace
+
+TdiThreadPool &PipeFanOut::defaultPoolGet() {
+  return TdiThreadPool::defaultPoolGet();
+}
+
+tdi_status_t PipeFanOut::pipesGet(const tdi::Target &dev_tgt,
+                                  const std::vector<uint64_t> &pipes,
+                                  std::vector<uint64_t> *target_pipes) const {
+  uint64_t pipe = 0;
+  auto status = dev_tgt.getValue(pipe_field_, &pipe);
+  if (status != TDI_SUCCESS) {
+    LOG_ERROR("%s:%d Unable to get the pipe of the target", __func__, __LINE__);
+    return status;
+  }
+  if (pipe == all_pipes_) {
+    *target_pipes = pipes;
+  } else {
+    target_pipes->assign(1, pipe);
+  }
+  return TDI_SUCCESS;
+}
+
+std::vector<tdi_status_t> PipeFanOut::fanOut(
+    const size_t &count,
+    const std::function<tdi_status_t(const size_t &i)> &op) const {
+  if (count == 1) return {op(0)};
+  auto state = std::make_shared<FanOutState>(count, &op);
+  auto &pool = pool_ ? *pool_ : defaultPoolGet();
+  // The caller takes a share of the pipes as well
+  for (size_t i = 1; i < std::min(count, pool.threadsGet() + 1); i++) {
+    pool.submitTask([state]() { state->drain(); });
+  }
+  state->drain();
+  return state->wait();
+}
+
+tdi_status_t PipeFanOut::run(const tdi::Target &dev_tgt,
+                             const std::vector<uint64_t> &pipes,
+                             const pipeOp &op) const {
+  std::vector<uint64_t> target_pipes;
+  auto status = pipesGet(dev_tgt, pipes, &target_pipes);
+  if (status != TDI_SUCCESS) return status;
+
+  auto statuses = fanOut(target_pipes.size(), [&](const size_t &i) {
+    return op(target_pipes[i]);
+  });
+  for (const auto &pipe_status : statuses) {
+    if (pipe_status != TDI_SUCCESS) return pipe_status;
+  }
+  return TDI_SUCCESS;
+}
+
+tdi_status_t PipeFanOut::runBatch(const tdi::Target &dev_tgt,
+                                  const std::vector<uint64_t> &pipes,
+                                  const size_t &batch_size,
+                                  const pipeBatchOp &op,
+                                  std::vector<tdi_status_t> *status_vec) const {
+  std::vector<uint64_t> target_pipes;
+  auto status = pipesGet(dev_tgt, pipes, &target_pipes);
+  if (status != TDI_SUCCESS) return status;
+
+  std::vector<std::vector<tdi_status_t>> pipe_status_vecs(
+      target_pipes.size(), std::vector<tdi_status_t>(batch_size, TDI_SUCCESS));
+  auto statuses = fanOut(target_pipes.size(), [&](const size_t &i) {
+    return op(target_pipes[i], &pipe_status_vecs[i]);
+  });
+
+  if (status_vec) {
+    status_vec->assign(batch_size, TDI_SUCCESS);
+    for (const auto &pipe_status_vec : pipe_status_vecs) {
+      for (size_t j = 0; j < batch_size && j < pipe_status_vec.size(); j++) {
+        if ((*status_vec)[j] == TDI_SUCCESS) {
+          (*status_vec)[j] = pipe_status_vec[j];
+        }
+      }
+    }
+  }
+  for (const auto &pipe_status : statuses) {
+    if (pipe_status != TDI_SUCCESS) return pipe_status;
+  }
+  return TDI_SUCCESS;
+}
+
+}  // namespace tdi
@@ -22,6 +22,11 @@
 namespace tdi {
 const std::string tdiNullStr = "";
 
+namespace {
+// Max number of key and of data objects kept per thread per table
+const size_t kObjectPoolMaxSize = 4096;
+}  // anonymous namespace
+
 tdi_status_t Table::entryAdd(const Session & /*session*/,
                              const Target & /*dev_tgt*/,
                              const Flags & /*flags*/,
@@ -57,6 +62,160 @@ tdi_status_t Table::entryDel(const Session & /*session*/,
   return TDI_NOT_SUPPORTED;
 }
 
+tdi_status_t Table::entryAddBatch(const Session &session,
+                                  const Target &dev_tgt,
+                                  const Flags &flags,
+                                  const constKeyDataPairs &key_data_pairs,
+                                  std::vector<tdi_status_t> *status_vec) const {
+  if (status_vec) {
+    status_vec->assign(key_data_pairs.size(), TDI_SUCCESS);
+  }
+  tdi_status_t first_err = TDI_SUCCESS;
+  for (size_t i = 0; i < key_data_pairs.size(); i++) {
+    const auto &kd = key_data_pairs[i];
+    tdi_status_t sts = TDI_INVALID_ARG;
+    if (kd.first && kd.second) {
+      sts = this->entryAdd(session, dev_tgt, flags, *kd.first, *kd.second);
+    } else {
+      LOG_ERROR("%s:%d %s ERROR : Null key or data at index %zu",
+                __func__,
+                __LINE__,
+                tableInfoGet()->nameGet().c_str(),
+                i);
+    }
+    if (status_vec) (*status_vec)[i] = sts;
+    if (sts != TDI_SUCCESS && first_err == TDI_SUCCESS) first_err = sts;
+  }
+  return first_err;
+}
+
+tdi_status_t Table::entryModBatch(const Session &session,
+                                  const Target &dev_tgt,
+                                  const Flags &flags,
+                                  const constKeyDataPairs &key_data_pairs,
+                                  std::vector<tdi_status_t> *status_vec) const {
+  if (status_vec) {
+    status_vec->assign(key_data_pairs.size(), TDI_SUCCESS);
+  }
+  tdi_status_t first_err = TDI_SUCCESS;
+  for (size_t i = 0; i < key_data_pairs.size(); i++) {
+    const auto &kd = key_data_pairs[i];
+    tdi_status_t sts = TDI_INVALID_ARG;
+    if (kd.first && kd.second) {
+      sts = this->entryMod(session, dev_tgt, flags, *kd.first, *kd.second);
+    } else {
+      LOG_ERROR("%s:%d %s ERROR : Null key or data at index %zu",
+                __func__,
+                __LINE__,
+                tableInfoGet()->nameGet().c_str(),
+                i);
+    }
+    if (status_vec) (*status_vec)[i] = sts;
+    if (sts != TDI_SUCCESS && first_err == TDI_SUCCESS) first_err = sts;
+  }
+  return first_err;
+}
+
+tdi_status_t Table::entryDelBatch(const Session &session,
+                                  const Target &dev_tgt,
+                                  const Flags &flags,
+                                  const std::vector<const TableKey *> &keys,
+                                  std::vector<tdi_status_t> *status_vec) const {
+  if (status_vec) {
+    status_vec->assign(keys.size(), TDI_SUCCESS);
+  }
+  tdi_status_t first_err = TDI_SUCCESS;
+  for (size_t i = 0; i < keys.size(); i++) {
+    tdi_status_t sts = TDI_INVALID_ARG;
+    if (keys[i]) {
+      sts = this->entryDel(session, dev_tgt, flags, *keys[i]);
+    } else {
+      LOG_ERROR("%s:%d %s ERROR : Null key at index %zu",
+                __func__,
+                __LINE__,
+                tableInfoGet()->nameGet().c_str(),
+                i);
+    }
+    if (status_vec) (*status_vec)[i] = sts;
+    if (sts != TDI_SUCCESS && first_err == TDI_SUCCESS) first_err = sts;
+  }
+  return first_err;
+}
+
+Table::completionCb Table::completionFutureMake(
+    std::future<tdi_status_t> *completion) {
+  auto promise = std::make_shared<std::promise<tdi_status_t>>();
+  *completion = promise->get_future();
+  return [promise](const tdi_status_t &status) { promise->set_value(status); };
+}
+
+tdi_status_t Table::entryAddAsync(const Session &session,
+                                  const Target &dev_tgt,
+                                  const Flags &flags,
+                                  const TableKey &key,
+                                  const TableData &data,
+                                  const completionCb &completion_cb) const {
+  if (!completion_cb) {
+    LOG_ERROR("%s:%d %s ERROR : No completion callback",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  completion_cb(this->entryAdd(session, dev_tgt, flags, key, data));
+  return TDI_SUCCESS;
+}
+
+tdi_status_t Table::entryModAsync(const Session &session,
+                                  const Target &dev_tgt,
+                                  const Flags &flags,
+                                  const TableKey &key,
+                                  const TableData &data,
+                                  const completionCb &completion_cb) const {
+  if (!completion_cb) {
+    LOG_ERROR("%s:%d %s ERROR : No completion callback",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  completion_cb(this->entryMod(session, dev_tgt, flags, key, data));
+  return TDI_SUCCESS;
+}
+
+tdi_status_t Table::entryDelAsync(const Session &session,
+                                  const Target &dev_tgt,
+                                  const Flags &flags,
+                                  const TableKey &key,
+                                  const completionCb &completion_cb) const {
+  if (!completion_cb) {
+    LOG_ERROR("%s:%d %s ERROR : No completion callback",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  completion_cb(this->entryDel(session, dev_tgt, flags, key));
+  return TDI_SUCCESS;
+}
+
+tdi_status_t Table::entryGetAsync(const Session &session,
+                                  const Target &dev_tgt,
+                                  const Flags &flags,
+                                  const TableKey &key,
+                                  TableData *data,
+                                  const completionCb &completion_cb) const {
+  if (!completion_cb) {
+    LOG_ERROR("%s:%d %s ERROR : No completion callback",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  completion_cb(this->entryGet(session, dev_tgt, flags, key, data));
+  return TDI_SUCCESS;
+}
+
 tdi_status_t Table::clear(const Session & /*session*/,
                           const Target & /*dev_tgt*/,
                           const Flags & /*flags*/) const {
@@ -186,6 +345,36 @@ tdi_status_t Table::entryGetNextN(const Session & /*session*/,
   return TDI_NOT_SUPPORTED;
 }
 
+tdi_status_t Table::entryScan(const Session &session,
+                              const Target &dev_tgt,
+                              const Flags &flags,
+                              const uint32_t &chunk_size,
+                              const bool &prefetch,
+                              std::unique_ptr<EntryIterator> *iter_ret) const {
+  if (!iter_ret) {
+    LOG_ERROR("%s:%d %s ERROR : Null iterator passed",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  if (chunk_size == 0) {
+    LOG_ERROR("%s:%d %s ERROR : Chunk size must be greater than zero",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  std::unique_ptr<EntryIterator> iter(new EntryIterator(
+      *this, session, dev_tgt, flags, chunk_size, prefetch));
+  auto status = iter->poolAllocate();
+  if (status != TDI_SUCCESS) {
+    return status;
+  }
+  *iter_ret = std::move(iter);
+  return TDI_SUCCESS;
+}
+
 tdi_status_t Table::usageGet(const Session & /*session*/,
                              const Target & /*dev_tgt*/,
                              const Flags & /*flags*/,
@@ -226,6 +415,236 @@ tdi_status_t Table::keyReset(TableKey * /* key */) const {
   return TDI_NOT_SUPPORTED;
 }
 
+void Table::ObjectPool::drain() {
+  std::lock_guard<std::mutex> lock(drain_mutex);
+  keys.clear();
+  data.clear();
+  drained.store(true, std::memory_order_release);
+}
+
+struct Table::ThreadObjectPools {
+  // The thread's lists of live tables are freed on thread exit
+  ~ThreadObjectPools() {
+    for (auto &entry : pools) entry.second->drain();
+  }
+  std::unordered_map<uint64_t, std::shared_ptr<ObjectPool>> pools;
+};
+
+uint64_t Table::objectPoolIdNext() {
+  static std::atomic<uint64_t> next_id{0};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+Table::~Table() {
+  std::lock_guard<std::mutex> lock(object_pools_mutex_);
+  for (auto &pool : object_pools_) pool->drain();
+}
+
+Table::ObjectPool *Table::objectPoolGet() const {
+  static thread_local ThreadObjectPools thread_pools;
+  auto &pools = thread_pools.pools;
+  auto it = pools.find(object_pool_id_);
+  if (it != pools.end()) return it->second.get();
+  auto drained = [](const std::shared_ptr<ObjectPool> &pool) {
+    return pool->drained.load(std::memory_order_acquire);
+  };
+  // First use of this table by the thread. Forget the pools the destroyed
+  // tables already drained so that they don't pile up in long lived threads
+  for (auto iter = pools.begin(); iter != pools.end();) {
+    if (drained(iter->second)) {
+      iter = pools.erase(iter);
+    } else {
+      iter++;
+    }
+  }
+  std::shared_ptr<ObjectPool> pool(new ObjectPool());
+  {
+    std::lock_guard<std::mutex> lock(object_pools_mutex_);
+    // Likewise forget the pools of exited threads
+    object_pools_.erase(
+        std::remove_if(object_pools_.begin(), object_pools_.end(), drained),
+        object_pools_.end());
+    object_pools_.push_back(pool);
+  }
+  auto pool_ptr = pool.get();
+  pools.emplace(object_pool_id_, std::move(pool));
+  return pool_ptr;
+}
+
+tdi_status_t Table::keyAllocateN(
+    const uint32_t &n, std::vector<std::unique_ptr<TableKey>> *keys_ret) const {
+  if (!keys_ret) {
+    LOG_ERROR("%s:%d %s ERROR : Null vector passed",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  auto pool = objectPoolGet();
+  keys_ret->reserve(keys_ret->size() + n);
+  uint32_t i = 0;
+  for (; i < n && !pool->keys.empty(); i++) {
+    keys_ret->push_back(std::move(pool->keys.back()));
+    pool->keys.pop_back();
+  }
+  for (; i < n; i++) {
+    std::unique_ptr<TableKey> key;
+    auto status = this->keyAllocate(&key);
+    if (status != TDI_SUCCESS) {
+      return status;
+    }
+    keys_ret->push_back(std::move(key));
+  }
+  return TDI_SUCCESS;
+}
+
+tdi_status_t Table::keyRelease(
+    std::vector<std::unique_ptr<TableKey>> *keys) const {
+  if (!keys) {
+    LOG_ERROR("%s:%d %s ERROR : Null vector passed",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  auto pool = objectPoolGet();
+  tdi_status_t status = TDI_SUCCESS;
+  for (auto &key : *keys) {
+    if (!key) continue;
+    const Table *key_table = nullptr;
+    key->tableGet(&key_table);
+    if (key_table != this) {
+      LOG_ERROR("%s:%d %s ERROR : Key object is not associated with the table",
+                __func__,
+                __LINE__,
+                tableInfoGet()->nameGet().c_str());
+      status = TDI_INVALID_ARG;
+      continue;
+    }
+    if (pool->keys.size() < kObjectPoolMaxSize &&
+        this->keyReset(key.get()) == TDI_SUCCESS) {
+      pool->keys.push_back(std::move(key));
+    }
+  }
+  keys->clear();
+  return status;
+}
+
+tdi_status_t Table::packedKeyLayoutGet(
+    const PackedKeyLayout **layout) const {
+  if (!layout) {
+    LOG_ERROR("%s:%d %s ERROR : nullptr arg passed",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  std::call_once(packed_key_layout_once_, [this]() {
+    packed_key_layout_status_ =
+        PackedKeyLayout::layoutCreate(tableInfoGet(), &packed_key_layout_);
+  });
+  if (packed_key_layout_status_ != TDI_SUCCESS) {
+    return packed_key_layout_status_;
+  }
+  *layout = packed_key_layout_.get();
+  return TDI_SUCCESS;
+}
+
+tdi_status_t Table::dataAllocateN(
+    const uint32_t &n,
+    std::vector<std::unique_ptr<TableData>> *data_ret) const {
+  if (!data_ret) {
+    LOG_ERROR("%s:%d %s ERROR : Null vector passed",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  auto pool = objectPoolGet();
+  data_ret->reserve(data_ret->size() + n);
+  uint32_t i = 0;
+  // Pooled objects were already reset on release
+  for (; i < n && !pool->data.empty(); i++) {
+    data_ret->push_back(std::move(pool->data.back()));
+    pool->data.pop_back();
+  }
+  for (; i < n; i++) {
+    std::unique_ptr<TableData> data;
+    auto status = this->dataAllocate(&data);
+    if (status != TDI_SUCCESS) {
+      return status;
+    }
+    data_ret->push_back(std::move(data));
+  }
+  return TDI_SUCCESS;
+}
+
+tdi_status_t Table::dataAllocateN(
+    const tdi_id_t &action_id,
+    const uint32_t &n,
+    std::vector<std::unique_ptr<TableData>> *data_ret) const {
+  if (!data_ret) {
+    LOG_ERROR("%s:%d %s ERROR : Null vector passed",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  auto pool = objectPoolGet();
+  data_ret->reserve(data_ret->size() + n);
+  uint32_t i = 0;
+  for (; i < n && !pool->data.empty(); i++) {
+    auto status = this->dataReset(action_id, pool->data.back().get());
+    if (status != TDI_SUCCESS) {
+      return status;
+    }
+    data_ret->push_back(std::move(pool->data.back()));
+    pool->data.pop_back();
+  }
+  for (; i < n; i++) {
+    std::unique_ptr<TableData> data;
+    auto status = this->dataAllocate(action_id, &data);
+    if (status != TDI_SUCCESS) {
+      return status;
+    }
+    data_ret->push_back(std::move(data));
+  }
+  return TDI_SUCCESS;
+}
+
+tdi_status_t Table::dataRelease(
+    std::vector<std::unique_ptr<TableData>> *data) const {
+  if (!data) {
+    LOG_ERROR("%s:%d %s ERROR : Null vector passed",
+              __func__,
+              __LINE__,
+              tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  auto pool = objectPoolGet();
+  tdi_status_t status = TDI_SUCCESS;
+  for (auto &obj : *data) {
+    if (!obj) continue;
+    const Table *data_table = nullptr;
+    obj->getParent(&data_table);
+    if (data_table != this) {
+      LOG_ERROR(
+          "%s:%d %s ERROR : Data object is not associated with the table",
+          __func__,
+          __LINE__,
+          tableInfoGet()->nameGet().c_str());
+      status = TDI_INVALID_ARG;
+      continue;
+    }
+    if (pool->data.size() < kObjectPoolMaxSize &&
+        this->dataReset(obj.get()) == TDI_SUCCESS) {
+      pool->data.push_back(std::move(obj));
+    }
+  }
+  data->clear();
+  return status;
+}
+
 tdi_status_t Table::dataAllocate(
     std::unique_ptr<TableData> * /*data_ret*/) const {
   LOG_ERROR("%s:%d %s ERROR : Table data allocate not supported",
@@ -414,4 +833,159 @@ tdi_status_t Table::operationsExecute(
   return TDI_NOT_SUPPORTED;
 }
 
+Table::EntryIterator::~EntryIterator() {
+  // An in flight prefetch uses objects owned by this iterator
+  prefetchCollect();
+  for (auto &chunk : chunks_) {
+    table_.keyRelease(&chunk.keys);
+    table_.dataRelease(&chunk.data);
+  }
+}
+
+tdi_status_t Table::EntryIterator::poolAllocate() {
+  for (auto &chunk : chunks_) {
+    auto status = table_.keyAllocateN(chunk_size_, &chunk.keys);
+    if (status != TDI_SUCCESS) return status;
+    status = table_.dataAllocateN(chunk_size_, &chunk.data);
+    if (status != TDI_SUCCESS) return status;
+    chunk.pairs.reserve(chunk_size_);
+    chunk.const_pairs.reserve(chunk_size_);
+    for (uint32_t i = 0; i < chunk_size_; i++) {
+      chunk.pairs.emplace_back(chunk.keys[i].get(), chunk.data[i].get());
+      chunk.const_pairs.emplace_back(chunk.keys[i].get(),
+                                     chunk.data[i].get());
+    }
+    chunk.pairs_tail.assign(chunk.pairs.begin() + 1, chunk.pairs.end());
+  }
+  return TDI_SUCCESS;
+}
+
+void Table::EntryIterator::fetch(Chunk *chunk, const TableKey *prev_key) {
+  for (uint32_t i = 0; i < chunk_size_; i++) {
+    chunk->keys[i]->reset();
+    chunk->data[i]->reset();
+  }
+  chunk->num_valid = 0;
+  chunk->last = false;
+  chunk->status = TDI_SUCCESS;
+
+  uint32_t num_returned = 0;
+  tdi_status_t status;
+  if (!prev_key) {
+    status = table_.entryGetFirst(
+        session_, dev_tgt_, flags_, chunk->keys[0].get(), chunk->data[0].get());
+    if (status == TDI_OBJECT_NOT_FOUND) {
+      // Empty table
+      chunk->last = true;
+      return;
+    }
+    if (status != TDI_SUCCESS) {
+      chunk->status = status;
+      return;
+    }
+    chunk->num_valid = 1;
+    if (chunk_size_ == 1) return;
+    status = table_.entryGetNextN(session_,
+                                  dev_tgt_,
+                                  flags_,
+                                  *chunk->keys[0],
+                                  chunk_size_ - 1,
+                                  &chunk->pairs_tail,
+                                  &num_returned);
+  } else {
+    status = table_.entryGetNextN(session_,
+                                  dev_tgt_,
+                                  flags_,
+                                  *prev_key,
+                                  chunk_size_,
+                                  &chunk->pairs,
+                                  &num_returned);
+  }
+  // Reaching the end of the table is reported as object not found by
+  // targets
+  if (status != TDI_SUCCESS && status != TDI_OBJECT_NOT_FOUND) {
+    chunk->status = status;
+    return;
+  }
+  chunk->num_valid += num_returned;
+  chunk->last = (chunk->num_valid < chunk_size_);
+}
+
+tdi_status_t Table::EntryIterator::next(const constKeyDataPairs **chunk,
+                                        uint32_t *num_returned) {
+  if (!chunk || !num_returned) {
+    LOG_ERROR("%s:%d %s ERROR : Null param passed",
+              __func__,
+              __LINE__,
+              table_.tableInfoGet()->nameGet().c_str());
+    return TDI_INVALID_ARG;
+  }
+  *chunk = nullptr;
+  *num_returned = 0;
+  if (done_) return TDI_SUCCESS;
+
+  if (!started_) {
+    started_ = true;
+    fetch(&chunks_[cur_], nullptr);
+  } else {
+    if (chunks_[cur_].last) {
+      done_ = true;
+      return TDI_SUCCESS;
+    }
+    size_t nxt = 1 - cur_;
+    if (!prefetchCollect()) {
+      const auto &prev = chunks_[cur_];
+      fetch(&chunks_[nxt], prev.keys[prev.num_valid - 1].get());
+    }
+    cur_ = nxt;
+  }
+
+  const Chunk &curr = chunks_[cur_];
+  if (curr.status != TDI_SUCCESS) {
+    done_ = true;
+    return curr.status;
+  }
+  if (curr.num_valid == 0) {
+    done_ = true;
+    return TDI_SUCCESS;
+  }
+  if (prefetch_ && !curr.last) prefetchStart();
+  *chunk = &curr.const_pairs;
+  *num_returned = curr.num_valid;
+  return TDI_SUCCESS;
+}
+
+void Table::EntryIterator::prefetchStart() {
+  auto prefetch = std::make_shared<Prefetch>();
+  Chunk *chunk = &chunks_[1 - cur_];
+  const auto &curr = chunks_[cur_];
+  const TableKey *prev_key = curr.keys[curr.num_valid - 1].get();
+  // The task only touches the iterator once it has claimed the read, the
+  // iterator waits for claimed reads before going away
+  auto task = [this, prefetch, chunk, prev_key]() {
+    if (prefetch->claimed.exchange(true)) return;
+    try {
+      fetch(chunk, prev_key);
+    } catch (...) {
+      LOG_ERROR("%s:%d %s ERROR : Exception while prefetching entries",
+                __func__,
+                __LINE__,
+                table_.tableInfoGet()->nameGet().c_str());
+      chunk->status = TDI_UNEXPECTED;
+    }
+    prefetch->done.set_value();
+  };
+  TdiThreadPool::defaultPoolGet().submitTask(task);
+  pending_ = std::move(prefetch);
+}
+
+bool Table::EntryIterator::prefetchCollect() {
+  if (!pending_) return false;
+  auto prefetch = std::move(pending_);
+  pending_.reset();
+  if (!prefetch->claimed.exchange(true)) return false;
+  prefetch->done_future.wait();
+  return true;
+}
+
 }  // namespace tdi
@@ -15,6 +15,7 @@
  */
 #include <algorithm>
 
+#include <tdi/common/tdi_table.hpp>
 #include <tdi/common/tdi_table_data.hpp>
 #include <tdi/common/tdi_utils.hpp>
 
@@ -191,43 +192,149 @@ tdi_status_t TableData::reset(const tdi_id_t &action_id,
   return this->resetDerived();
 }
 
+namespace {
+inline bool bitTest(const std::vector<uint64_t> &bmp, const uint32_t &bit) {
+  return (bmp[bit >> 6] >> (bit & 63)) & 1;
+}
+inline void bitSet(std::vector<uint64_t> *bmp, const uint32_t &bit) {
+  (*bmp)[bit >> 6] |= (1ULL << (bit & 63));
+}
+inline void bitClear(std::vector<uint64_t> *bmp, const uint32_t &bit) {
+  (*bmp)[bit >> 6] &= ~(1ULL << (bit & 63));
+}
+inline bool idListHas(const std::vector<tdi_id_t> &ids, const tdi_id_t &id) {
+  return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+}  // anonymous namespace
+
+void TableData::fieldBitmapInit() {
+  size_t num_fields = 0;
+  if (this->table_ && this->table_->tableInfoGet()) {
+    num_fields = this->table_->tableInfoGet()->dataFieldIndexCountGet();
+  }
+  // Sized once, resets only clear the words
+  this->active_fields_bmp_.assign((num_fields + 63) / 64, 0);
+  this->removed_one_ofs_bmp_.assign((num_fields + 63) / 64, 0);
+}
+
+bool TableData::fieldBitGet(const tdi_id_t &field_id, uint32_t *bit) const {
+  if (!this->table_ || !this->table_->tableInfoGet()) return false;
+  return this->table_->tableInfoGet()->dataFieldIndexGet(field_id, bit) ==
+         TDI_SUCCESS;
+}
+
+template <typename F>
+void TableData::activeFieldsForEach(F fn) const {
+  if (!this->num_active_fields_) return;
+  for (const auto &field_id : this->active_fields_extra_) fn(field_id);
+  // Bitmap is empty if there is no table info, see fieldBitmapInit
+  if (this->active_fields_bmp_.empty()) return;
+  const TableInfo *table_info = this->table_->tableInfoGet();
+  for (size_t word = 0; word < this->active_fields_bmp_.size(); word++) {
+    uint64_t bits = this->active_fields_bmp_[word];
+    while (bits) {
+      uint32_t bit = static_cast<uint32_t>(word * 64) + __builtin_ctzll(bits);
+      fn(table_info->dataFieldIdFromIndexGet(bit));
+      bits &= bits - 1;
+    }
+  }
+}
+
+const std::set<tdi_id_t> &TableData::activeFieldsGet() const {
+  auto &active_fields = this->active_fields_cache_;
+  if (this->active_fields_cache_valid_) return active_fields;
+  this->active_fields_cache_valid_ = true;
+  active_fields.clear();
+  activeFieldsForEach(
+      [&active_fields](const tdi_id_t &id) { active_fields.insert(id); });
+  return active_fields;
+}
+
+tdi_status_t TableData::activeFieldsGet(
+    std::vector<tdi_id_t> *active_fields) const {
+  if (!active_fields) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  active_fields->clear();
+  activeFieldsForEach(
+      [active_fields](const tdi_id_t &id) { active_fields->push_back(id); });
+  return TDI_SUCCESS;
+}
+
 tdi_status_t TableData::activeFieldsSet(const std::vector<tdi_id_t> &fields) {
-  this->removed_one_ofs_ = {};
-  this->active_fields_s_ = {};
+  auto &active = this->active_fields_bmp_;
+  auto &removed = this->removed_one_ofs_bmp_;
+  std::fill(removed.begin(), removed.end(), 0);
+  std::fill(active.begin(), active.end(), 0);
+  this->removed_one_ofs_extra_.clear();
+  this->active_fields_extra_.clear();
+  this->num_active_fields_ = 0;
+  this->active_fields_cache_valid_ = false;
   if (fields.empty()) {
     this->all_fields_set_ = true;
-  } else {
-    this->all_fields_set_ = false;
-    std::copy(fields.begin(),
-              fields.end(),
-              std::inserter(active_fields_s_, active_fields_s_.end()));
+    return TDI_SUCCESS;
+  }
+  this->all_fields_set_ = false;
+  for (const auto &field_id : fields) {
+    uint32_t bit;
+    if (this->fieldBitGet(field_id, &bit)) {
+      if (bitTest(this->active_fields_bmp_, bit)) continue;
+      bitSet(&this->active_fields_bmp_, bit);
+    } else {
+      if (idListHas(this->active_fields_extra_, field_id)) continue;
+      this->active_fields_extra_.push_back(field_id);
+    }
+    this->num_active_fields_++;
   }
   return TDI_SUCCESS;
 }
 
 void TableData::removeActiveField(const tdi_id_t &field_id) {
-  // The reason a separate set of removed_one_ofs_ is maintained
-  // is because the active_field_s_ set doesn't always
+  // The reason a separate bitmap of removed oneofs is maintained
+  // is because the active fields bitmap doesn't always
   // contain the list of all fields. It cannot keep it especially
   // if the action_id is not known beforehand. So in those cases,
   // we need to mark if a field was removed.
-  this->removed_one_ofs_.insert(field_id);
+  uint32_t bit;
+  bool has_bit = this->fieldBitGet(field_id, &bit);
+  if (has_bit) {
+    bitSet(&this->removed_one_ofs_bmp_, bit);
+  } else if (!idListHas(this->removed_one_ofs_extra_, field_id)) {
+    this->removed_one_ofs_extra_.push_back(field_id);
+  }
 
   // If the set of active fields is empty,
   // then no need to process it or change
   // all_fields_set.
-  if (!active_fields_s_.empty()) {
-    this->active_fields_s_.erase(field_id);
-    all_fields_set_ = false;
+  if (!this->num_active_fields_) return;
+  if (has_bit) {
+    if (bitTest(this->active_fields_bmp_, bit)) {
+      bitClear(&this->active_fields_bmp_, bit);
+      this->num_active_fields_--;
+      this->active_fields_cache_valid_ = false;
+    }
+  } else {
+    auto it = std::find(this->active_fields_extra_.begin(),
+                        this->active_fields_extra_.end(),
+                        field_id);
+    if (it != this->active_fields_extra_.end()) {
+      this->active_fields_extra_.erase(it);
+      this->num_active_fields_--;
+      this->active_fields_cache_valid_ = false;
+    }
   }
+  all_fields_set_ = false;
 }
 
 tdi_status_t TableData::isActive(const tdi_id_t &field_id,
                                  bool *is_active) const {
+  uint32_t bit;
+  bool has_bit = this->fieldBitGet(field_id, &bit);
   // 1. Check if the input field was part of an explicit
   // field removal which can be done via removeActiveField.
-  auto it = this->removed_one_ofs_.find(field_id);
-  if (it != this->removed_one_ofs_.end()) {
+  if (has_bit ? bitTest(this->removed_one_ofs_bmp_, bit)
+              : idListHas(this->removed_one_ofs_extra_, field_id)) {
     *is_active = false;
     return TDI_SUCCESS;
   }
@@ -240,13 +347,9 @@ tdi_status_t TableData::isActive(const tdi_id_t &field_id,
   }
 
   // Lastly check if they are explicitly set in the active
-  // fields set
-  auto it2 = this->active_fields_s_.find(field_id);
-  if (it2 != this->active_fields_s_.end()) {
-    *is_active = true;
-    return TDI_SUCCESS;
-  }
-  *is_active = false;
+  // fields bitmap
+  *is_active = has_bit ? bitTest(this->active_fields_bmp_, bit)
+                       : idListHas(this->active_fields_extra_, field_id);
   return TDI_SUCCESS;
 }
 
@@ -14,11 +14,92 @@
  * limitations under the License.
  */
 
+#include <cstring>
+#include <vector>
+
+#include <tdi/common/tdi_table.hpp>
 #include <tdi/common/tdi_table_key.hpp>
 #include <tdi/common/tdi_utils.hpp>
 
 namespace tdi {
 
+namespace {
+// Keys of up to this many serialized bytes are hashed and compared without
+// allocating
+const size_t kKeyStackBufSize = 256;
+
+// Number of bytes a key field takes in the serialized form
+tdi_status_t keyFieldSerializedSize(const KeyFieldInfo &field_info,
+                                    size_t *size) {
+  size_t bytes = (field_info.sizeGet() + 7) / 8;
+  switch (static_cast<uint32_t>(field_info.matchTypeGet())) {
+    case TDI_MATCH_TYPE_EXACT:
+      *size = bytes;
+      break;
+    case TDI_MATCH_TYPE_TERNARY:
+    case TDI_MATCH_TYPE_RANGE:
+      *size = 2 * bytes;
+      break;
+    case TDI_MATCH_TYPE_LPM:
+      *size = bytes + sizeof(uint16_t);
+      break;
+    default:
+      LOG_ERROR("%s:%d Key field %s : match type %d not supported",
+                __func__,
+                __LINE__,
+                field_info.nameGet().c_str(),
+                static_cast<int>(field_info.matchTypeGet()));
+      return TDI_NOT_SUPPORTED;
+  }
+  if (field_info.isPtrGet() || !bytes) {
+    LOG_ERROR("%s:%d Key field %s : variable size fields not supported",
+              __func__,
+              __LINE__,
+              field_info.nameGet().c_str());
+    return TDI_NOT_SUPPORTED;
+  }
+  return TDI_SUCCESS;
+}
+
+// Clear the bits of a big endian value of size bytes, holding a field of
+// width bits, which are not among the prefix_len most significant bits of
+// the field
+void prefixApply(const size_t &width,
+                 const size_t &prefix_len,
+                 const size_t &size,
+                 uint8_t *value) {
+  for (size_t i = 0; i < size; i++) {
+    uint8_t keep = 0;
+    for (size_t b = 0; b < 8; b++) {
+      // Bit position counted from the least significant bit of the value
+      size_t bit = (size - 1 - i) * 8 + b;
+      if (bit < width && bit + prefix_len >= width) {
+        keep |= static_cast<uint8_t>(1 << b);
+      }
+    }
+    value[i] &= keep;
+  }
+}
+
+// Serialize into a stack buffer if the key is small enough, else into
+// heap_buf. buf_ret points to the serialized bytes
+tdi_status_t keySerializeTemp(const TableKey &key,
+                              uint8_t *stack_buf,
+                              std::vector<uint8_t> *heap_buf,
+                              const uint8_t **buf_ret,
+                              size_t *size_ret) {
+  auto status = key.serializedSizeGet(size_ret);
+  if (status != TDI_SUCCESS) return status;
+  uint8_t *buf = stack_buf;
+  if (*size_ret > kKeyStackBufSize) {
+    heap_buf->resize(*size_ret);
+    buf = heap_buf->data();
+  }
+  *buf_ret = buf;
+  return key.serialize(buf, *size_ret);
+}
+}  // anonymous namespace
+
 tdi_status_t TableKey::setValue(const tdi_id_t &field_id,
                                 const tdi::KeyFieldValue &&field_value) {
   return this->setValue(field_id, field_value);
@@ -46,4 +127,149 @@ tdi_status_t TableKey::reset() {
   return TDI_NOT_SUPPORTED;
 }
 
+tdi_status_t TableKey::serializedSizeGet(size_t *size) const {
+  if (!size) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  if (!table_ || !table_->tableInfoGet()) {
+    LOG_ERROR("%s:%d Key is not associated with a table", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  const TableInfo *table_info = table_->tableInfoGet();
+  *size = 0;
+  for (uint32_t i = 0; i < table_info->keyFieldCountGet(); i++) {
+    size_t field_size = 0;
+    auto status = keyFieldSerializedSize(*table_info->keyFieldByOrdinalGet(i),
+                                         &field_size);
+    if (status != TDI_SUCCESS) return status;
+    *size += field_size;
+  }
+  return TDI_SUCCESS;
+}
+
+tdi_status_t TableKey::serialize(uint8_t *buf, const size_t &buf_size) const {
+  size_t size = 0;
+  auto status = this->serializedSizeGet(&size);
+  if (status != TDI_SUCCESS) return status;
+  if (!buf || buf_size < size) {
+    LOG_ERROR("%s:%d %s : Buffer of size %zu too small, need %zu",
+              __func__,
+              __LINE__,
+              table_->tableInfoGet()->nameGet().c_str(),
+              buf_size,
+              size);
+    return TDI_INVALID_ARG;
+  }
+  const TableInfo *table_info = table_->tableInfoGet();
+  uint8_t *ptr = buf;
+  for (uint32_t i = 0; i < table_info->keyFieldCountGet(); i++) {
+    const KeyFieldInfo *field_info = table_info->keyFieldByOrdinalGet(i);
+    const tdi_id_t &field_id = field_info->idGet();
+    const size_t width = field_info->sizeGet();
+    size_t bytes = (width + 7) / 8;
+    // Bits which can't affect what the key matches are cleared
+    switch (static_cast<uint32_t>(field_info->matchTypeGet())) {
+      case TDI_MATCH_TYPE_EXACT: {
+        KeyFieldValueExact<uint8_t *> value(ptr, bytes);
+        status = this->getValue(field_id, &value);
+        prefixApply(width, width, bytes, ptr);
+        ptr += bytes;
+        break;
+      }
+      case TDI_MATCH_TYPE_TERNARY: {
+        KeyFieldValueTernary<uint8_t *> value(ptr, ptr + bytes, bytes);
+        status = this->getValue(field_id, &value);
+        prefixApply(width, width, bytes, ptr + bytes);
+        for (size_t j = 0; j < bytes; j++) ptr[j] &= ptr[bytes + j];
+        ptr += 2 * bytes;
+        break;
+      }
+      case TDI_MATCH_TYPE_LPM: {
+        KeyFieldValueLPM<uint8_t *> value(ptr, 0, bytes);
+        status = this->getValue(field_id, &value);
+        if (status == TDI_SUCCESS && value.prefix_len_ > width) {
+          LOG_ERROR("%s:%d %s : Prefix length %d of key field %s is wider "
+                    "than the field",
+                    __func__,
+                    __LINE__,
+                    table_info->nameGet().c_str(),
+                    value.prefix_len_,
+                    field_info->nameGet().c_str());
+          return TDI_INVALID_ARG;
+        }
+        prefixApply(width, value.prefix_len_, bytes, ptr);
+        ptr += bytes;
+        *ptr++ = static_cast<uint8_t>(value.prefix_len_ >> 8);
+        *ptr++ = static_cast<uint8_t>(value.prefix_len_ & 0xFF);
+        break;
+      }
+      case TDI_MATCH_TYPE_RANGE: {
+        KeyFieldValueRange<uint8_t *> value(ptr, ptr + bytes, bytes);
+        status = this->getValue(field_id, &value);
+        prefixApply(width, width, bytes, ptr);
+        prefixApply(width, width, bytes, ptr + bytes);
+        ptr += 2 * bytes;
+        break;
+      }
+      default:
+        // Already rejected by serializedSizeGet
+        status = TDI_NOT_SUPPORTED;
+        break;
+    }
+    if (status != TDI_SUCCESS) {
+      LOG_ERROR("%s:%d %s : Unable to get value of key field %s",
+                __func__,
+                __LINE__,
+                table_info->nameGet().c_str(),
+                field_info->nameGet().c_str());
+      return status;
+    }
+  }
+  return TDI_SUCCESS;
+}
+
+tdi_status_t TableKey::hash(uint64_t *hash) const {
+  if (!hash) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  uint8_t stack_buf[kKeyStackBufSize];
+  std::vector<uint8_t> heap_buf;
+  const uint8_t *buf = nullptr;
+  size_t size = 0;
+  auto status = keySerializeTemp(*this, stack_buf, &heap_buf, &buf, &size);
+  if (status != TDI_SUCCESS) return status;
+  // FNV-1a
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; i++) {
+    h ^= buf[i];
+    h *= 1099511628211ULL;
+  }
+  *hash = h;
+  return TDI_SUCCESS;
+}
+
+tdi_status_t TableKey::equals(const TableKey &other, bool *is_equal) const {
+  if (!is_equal) {
+    LOG_ERROR("%s:%d nullptr arg passed", __func__, __LINE__);
+    return TDI_INVALID_ARG;
+  }
+  if (this->table_ != other.table_) {
+    *is_equal = false;
+    return TDI_SUCCESS;
+  }
+  uint8_t stack_buf[kKeyStackBufSize], other_stack_buf[kKeyStackBufSize];
+  std::vector<uint8_t> heap_buf, other_heap_buf;
+  const uint8_t *buf = nullptr, *other_buf = nullptr;
+  size_t size = 0, other_size = 0;
+  auto status = keySerializeTemp(*this, stack_buf, &heap_buf, &buf, &size);
+  if (status != TDI_SUCCESS) return status;
+  status = keySerializeTemp(
+      other, other_stack_buf, &other_heap_buf, &other_buf, &other_size);
+  if (status != TDI_SUCCESS) return status;
+  *is_equal = (size == other_size) && !std::memcmp(buf, other_buf, size);
+  return TDI_SUCCESS;
+}
+
 }  // namespace tdi
@@ -1696,10 +1696,7 @@ class TdiTable:
             raise TdiTableError("Error: entry_get_first failed on table {}. [{}]".format(self.name, self._cintf.err_str(sts)), self, sts)
         return key_handle, data_handle
 
-    def get_next(self, prev_key, n=20, from_hw=False):
-        if "get_next_n" not in self.supported_commands:
-            # If not supported, then just return empty lists
-            return [], []
+    def _allocate_hdl_pool(self, n):
         arrtype = self._cintf.handle_type * n
         key_hdls = arrtype()
         data_hdls = arrtype()
@@ -1707,6 +1704,28 @@ class TdiTable:
             new_key, new_data = self._allocate_keydata_handles()
             key_hdls[i] = new_key
             data_hdls[i] = new_data
+        return key_hdls, data_hdls
+
+    def _reset_hdl_pool(self, key_hdls, data_hdls, n):
+        for i in range(0, n):
+            self._cintf.get_driver().tdi_table_key_reset(self._handle, byref(key_hdls[i]))
+            self._cintf.get_driver().tdi_table_data_reset(self._handle, byref(data_hdls[i]))
+
+    def get_next(self, prev_key, n=20, from_hw=False, pool=None):
+        """
+        Get up to n entries following prev_key. If pool is given, it must be
+        a (key_hdls, data_hdls) pair of arrays of at least n handles as
+        returned by _allocate_hdl_pool. The handles are reset and reused
+        instead of allocating new ones.
+        """
+        if "get_next_n" not in self.supported_commands:
+            # If not supported, then just return empty lists
+            return [], []
+        if pool is None:
+            key_hdls, data_hdls = self._allocate_hdl_pool(n)
+        else:
+            key_hdls, data_hdls = pool
+            self._reset_hdl_pool(key_hdls, data_hdls, n)
         flag = c_int(0)
         flags_handle = self._cintf.handle_type()
         sts = self._cintf.get_driver().tdi_flags_create(flag, byref(flags_handle))
@@ -1982,41 +2001,52 @@ class TdiTable:
         if not sts == 0:
             raise TdiTableError("Error: Table clear failed on table {}. [{}]".format(self.name, sts), self, sts)
 
-    def dump(self, entry_handler, from_hw=False, print_ents=True, print_zero=True):
+    def dump(self, entry_handler, from_hw=False, print_ents=True, print_zero=True, chunk=20):
         if "get_first" not in self.supported_commands:
             return 0
         key_hdl, data_hdl = self.get_first(from_hw, print_ents)
         if key_hdl == -1:
             return -1
 
+        # Two pools of handles are allocated once and used alternately.
+        # The last key of the chunk read in one pool is the starting point
+        # of the next chunk, which is read into the other pool.
+        pools = [self._allocate_hdl_pool(chunk), self._allocate_hdl_pool(chunk)]
+        cur = 0
         key_hdls = [key_hdl]
         data_hdls = [data_hdl]
         prev_key_hdl = key_hdl
-        while True:
-            next_key_hdls, next_data_hdls = self.get_next(prev_key_hdl, 20 - len(key_hdls), from_hw)
-            if next_key_hdls == -1:
-                return -1
-            key_hdls += next_key_hdls
-            data_hdls += next_data_hdls
-            if len(key_hdls) == 0:
-                self._cintf.get_driver().tdi_table_key_deallocate(prev_key_hdl)
-                return 0;
-
-            action_ids = []
-
-            if len(self.actions) > 0:
-                for d_hdl in data_hdls:
-                    action_ids.append(self._action_from_data(d_hdl))
-
-            entry_handler(key_hdls, data_hdls, action_ids, print_zero)
-            self._deallocate_hdls(key_hdls[:-1], data_hdls)
-            prev_key_hdl = key_hdls[-1]
-
-            if len(key_hdls) < 20:
-                self._cintf.get_driver().tdi_table_key_deallocate(prev_key_hdl)
-                return 0;
-            key_hdls = []
-            data_hdls = []
+        sts = 0
+        try:
+            while True:
+                next_key_hdls, next_data_hdls = self.get_next(prev_key_hdl, chunk - len(key_hdls), from_hw, pools[cur])
+                if next_key_hdls == -1:
+                    sts = -1
+                    break
+                key_hdls += next_key_hdls
+                data_hdls += next_data_hdls
+                if len(key_hdls) == 0:
+                    break
+
+                action_ids = []
+
+                if len(self.actions) > 0:
+                    for d_hdl in data_hdls:
+                        action_ids.append(self._action_from_data(d_hdl))
+
+                entry_handler(key_hdls, data_hdls, action_ids, print_zero)
+                prev_key_hdl = key_hdls[-1]
+
+                if len(key_hdls) < chunk:
+                    break
+                key_hdls = []
+                data_hdls = []
+                cur = 1 - cur
+        finally:
+            self._deallocate_hdls([key_hdl], [data_hdl])
+            for pool_keys, pool_data in pools:
+                self._deallocate_hdls(pool_keys, pool_data)
+        return sts
 
     def raw_entry(self, key_content, data_content, action):
         raw_key = {}